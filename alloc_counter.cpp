@@ -0,0 +1,101 @@
+// 堆分配计数
+#include "alloc_counter.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+#ifdef PEG_ALLOC_COUNTER
+
+static std::atomic<std::uint64_t> g_allocCount{0};
+static std::atomic<std::uint64_t> g_allocBytes{0};
+
+std::uint64_t allocationCount() {
+    return g_allocCount.load(std::memory_order_relaxed);
+}
+
+std::uint64_t allocationBytes() {
+    return g_allocBytes.load(std::memory_order_relaxed);
+}
+
+static void* countedAlloc(std::size_t size) {
+    g_allocCount.fetch_add(1, std::memory_order_relaxed);
+    g_allocBytes.fetch_add(size, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+
+// 对齐分配（alignas 大于 16 的类型走这里，如置换表的桶）：MSVC 没有 aligned_alloc，
+// 它的内存也必须用 _aligned_free 释放
+static void* countedAlignedAlloc(std::size_t size, std::align_val_t align) {
+    g_allocCount.fetch_add(1, std::memory_order_relaxed);
+    g_allocBytes.fetch_add(size, std::memory_order_relaxed);
+    std::size_t a = static_cast<std::size_t>(align);
+#ifdef _WIN32
+    return _aligned_malloc(size ? size : 1, a);
+#else
+    // aligned_alloc 要求大小是对齐的整数倍
+    std::size_t n = size ? (size + a - 1) / a * a : a;
+    return std::aligned_alloc(a, n);
+#endif
+}
+
+static void alignedFree(void* p) {
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+void* operator new(std::size_t size) {
+    void* p = countedAlloc(size);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return countedAlloc(size);
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return countedAlloc(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t align) {
+    void* p = countedAlignedAlloc(size, align);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+void* operator new[](std::size_t size, std::align_val_t align) {
+    return operator new(size, align);
+}
+void* operator new(std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return countedAlignedAlloc(size, align);
+}
+void* operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return countedAlignedAlloc(size, align);
+}
+
+void operator delete(void* p) noexcept                          { std::free(p); }
+void operator delete[](void* p) noexcept                        { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept             { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept           { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept   { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+
+void operator delete(void* p, std::align_val_t) noexcept                          { alignedFree(p); }
+void operator delete[](void* p, std::align_val_t) noexcept                        { alignedFree(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept             { alignedFree(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept           { alignedFree(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept   { alignedFree(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { alignedFree(p); }
+
+#else
+
+std::uint64_t allocationCount() { return 0; }
+std::uint64_t allocationBytes() { return 0; }
+
+#endif
@@ -0,0 +1,14 @@
+#pragma once
+// 堆分配计数：替换全局 operator new / delete（含对齐版本），每次分配多两次原子加法
+// 用于基准测试统计“每帧分配了多少次”。只有定义了 PEG_ALLOC_COUNTER 的构建才替换，
+// 正式版不付这份开销，两个计数恒为 0
+#include <cstdint>
+
+#ifdef PEG_ALLOC_COUNTER
+constexpr bool AllocCounterEnabled = true;
+#else
+constexpr bool AllocCounterEnabled = false;
+#endif
+
+std::uint64_t allocationCount();    // 进程启动以来 operator new 的调用次数
+std::uint64_t allocationBytes();    // 以及申请的总字节数
@@ -0,0 +1,268 @@
+// 束搜索：按启发式分数保留每层最好的若干局面，时间允许时加宽重搜
+#include "beam_search.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+// 宝塔函数：到目标格曼哈顿距离的斐波那契值。
+// 满足 f(d+2) <= f(d) + f(d+1)，普通跳跃不会让总和增加（冰滑除外）
+static const int PAGODA_FIB[] = {0, 1, 1, 2, 3, 5, 8, 13, 21, 34, 55, 89, 144};
+
+static const int DR[4] = {-2, 2, 0, 0};
+static const int DC[4] = {0, 0, -2, 2};
+
+BeamSearch::BeamSearch(const std::vector<Board>& floors, const BeamConfig& cfg,
+                       const SolveGoal& goal)
+    : root_(floors), cfg_(cfg), goal_(goal)
+{
+    threads_ = cfg_.threads;
+    if (threads_ <= 0) {
+        threads_ = static_cast<int>(std::thread::hardware_concurrency());
+        if (threads_ <= 0) threads_ = 1;
+    }
+    best_.startPegs = floorsPegs(root_);
+    best_.bestPegs  = best_.startPegs;
+}
+
+BeamSearch::~BeamSearch() {
+    stop();
+}
+
+// ===== 打分 =====
+
+float BeamSearch::evaluate(const std::vector<Board>& floors, const BeamConfig& cfg) {
+    int mobility = 0;
+    int cluster  = 0;
+    int isolated = 0;
+    int pagoda   = 0;
+
+    for (const auto& b : floors) {
+        // 宝塔中心：有 Goal 就用 Goal，否则用棋盘中心
+        int tr = Board::Rows / 2;
+        int tc = Board::Cols / 2;
+        for (int r = 0; r < Board::Rows; ++r) {
+            for (int c = 0; c < Board::Cols; ++c) {
+                if (b.typeAt(r, c) == CellType::Goal) {
+                    tr = r;
+                    tc = c;
+                }
+            }
+        }
+
+        for (int r = 0; r < Board::Rows; ++r) {
+            for (int c = 0; c < Board::Cols; ++c) {
+                if (b.at(r, c) != CellState::Peg) continue;
+
+                bool hasNeighbour = false;
+                if (r + 1 < Board::Rows && b.at(r + 1, c) == CellState::Peg) {
+                    ++cluster;
+                    hasNeighbour = true;
+                }
+                if (c + 1 < Board::Cols && b.at(r, c + 1) == CellState::Peg) {
+                    ++cluster;
+                    hasNeighbour = true;
+                }
+                if (!hasNeighbour) {
+                    hasNeighbour =
+                        (r > 0 && b.at(r - 1, c) == CellState::Peg) ||
+                        (c > 0 && b.at(r, c - 1) == CellState::Peg);
+                }
+                if (!hasNeighbour) ++isolated;
+
+                pagoda += PAGODA_FIB[std::abs(r - tr) + std::abs(c - tc)];
+
+                for (int k = 0; k < 4; ++k) {
+                    if (b.canJump(r, c, r + DR[k], c + DC[k])) ++mobility;
+                }
+            }
+        }
+    }
+
+    return cfg.wMobility * mobility
+         + cfg.wCluster  * cluster
+         - cfg.wIsolated * isolated
+         - cfg.wPagoda   * pagoda;
+}
+
+// ===== 控制 =====
+
+void BeamSearch::start() {
+    stop();
+    stop_ = false;
+    running_ = true;
+    worker_ = std::thread(&BeamSearch::searchLoop, this);
+}
+
+void BeamSearch::stop() {
+    stop_ = true;
+    if (worker_.joinable()) worker_.join();
+}
+
+BeamResult BeamSearch::best() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return best_;
+}
+
+BeamResult BeamSearch::run() {
+    stop();
+    stop_ = false;
+    running_ = true;
+    searchLoop();
+    return best();
+}
+
+bool BeamSearch::outOfTime() const {
+    return stop_.load() || std::chrono::steady_clock::now() >= deadline_;
+}
+
+// ===== 搜索 =====
+
+void BeamSearch::searchLoop() {
+    deadline_ = std::chrono::steady_clock::now() +
+        std::chrono::microseconds(static_cast<long long>(cfg_.timeBudget * 1e6));
+
+    int width = std::max(1, cfg_.width);
+    while (!outOfTime()) {
+        bool complete = pass(width);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (complete) best_.passes++;
+            if (best_.bestPegs <= 1) break;
+        }
+        if (!complete) break;
+        width *= 2;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        best_.finished = true;
+    }
+    running_ = false;
+}
+
+void BeamSearch::expandRange(const std::vector<Node>& parents, int begin, int end,
+                             std::vector<Node>& out, long long& nodes)
+{
+    std::vector<Jump> jumps;
+    for (int i = begin; i < end; ++i) {
+        if ((i & 15) == 0 && outOfTime()) return;
+
+        const Node& p = parents[i];
+        ++nodes;
+        collectFloorJumps(p.floors, jumps);
+        for (const auto& j : jumps) {
+            Node child;
+            child.floors = p.floors;
+            MoveResult mv;
+            applyFloorMove(child.floors, j.floor, j.r1, j.c1, j.r2, j.c2, mv);
+            if (goal_.isDead && goal_.isDead(child.floors, mv)) continue;
+
+            child.hash   = floorsHash(child.floors);
+            child.score  = evaluate(child.floors, cfg_);
+            child.parent = p.trace;
+            child.move   = j;
+            out.push_back(std::move(child));
+        }
+    }
+}
+
+bool BeamSearch::pass(int width) {
+    traces_.clear();
+
+    std::vector<Node> beam(1);
+    beam[0].floors = root_;
+    beam[0].hash   = floorsHash(root_);
+    beam[0].score  = evaluate(root_, cfg_);
+
+    int startPegs = floorsPegs(root_);
+    int depth = 0;
+
+    std::vector<std::vector<Node>> parts(threads_);
+    std::vector<long long>         counts(threads_);
+    std::vector<int>               order;
+
+    while (true) {
+        if (outOfTime()) return false;
+
+        // 按父局面切片，多核并行展开
+        int n = static_cast<int>(beam.size());
+        int workers = std::min(threads_, std::max(1, n / 32));
+        for (int t = 0; t < workers; ++t) {
+            parts[t].clear();
+            counts[t] = 0;
+        }
+        if (workers == 1) {
+            expandRange(beam, 0, n, parts[0], counts[0]);
+        } else {
+            std::vector<std::thread> pool;
+            for (int t = 0; t < workers; ++t) {
+                int begin = n * t / workers;
+                int end   = n * (t + 1) / workers;
+                pool.emplace_back([this, &beam, &parts, &counts, t, begin, end] {
+                    expandRange(beam, begin, end, parts[t], counts[t]);
+                });
+            }
+            for (auto& th : pool) th.join();
+        }
+        if (outOfTime()) return false;
+
+        std::vector<Node> children;
+        long long expanded = 0;
+        for (int t = 0; t < workers; ++t) {
+            expanded += counts[t];
+            for (auto& node : parts[t]) children.push_back(std::move(node));
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            best_.nodes += expanded;
+        }
+
+        // 走到底：这一轮结束
+        if (children.empty()) return true;
+
+        // 去重（同一局面只保留一个），再取分数最高的 width 个
+        order.resize(children.size());
+        for (int i = 0; i < static_cast<int>(order.size()); ++i) order[i] = i;
+        std::sort(order.begin(), order.end(), [&](int a, int b) {
+            return children[a].hash < children[b].hash;
+        });
+        order.erase(std::unique(order.begin(), order.end(), [&](int a, int b) {
+            return children[a].hash == children[b].hash;
+        }), order.end());
+
+        int keep = std::min(width, static_cast<int>(order.size()));
+        std::partial_sort(order.begin(), order.begin() + keep, order.end(),
+            [&](int a, int b) { return children[a].score > children[b].score; });
+
+        beam.clear();
+        for (int i = 0; i < keep; ++i) {
+            Node& node = children[order[i]];
+            traces_.push_back(Trace{node.parent, node.move});
+            node.trace = static_cast<int>(traces_.size()) - 1;
+            beam.push_back(std::move(node));
+        }
+
+        // 每一跳吃掉一颗棋子，同一层的剩余棋子数相同
+        ++depth;
+        publish(beam[0].trace, startPegs - depth, width);
+        if (startPegs - depth <= 1) return true;
+    }
+}
+
+void BeamSearch::publish(int traceIndex, int pegs, int width) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        best_.width = width;
+        if (pegs >= best_.bestPegs) return;
+    }
+
+    // 沿 traces_ 回溯出整条路线（只有搜索线程写 traces_，这里不用加锁）
+    std::vector<Jump> line;
+    for (int i = traceIndex; i >= 0; i = traces_[i].parent) {
+        line.push_back(traces_[i].move);
+    }
+    std::reverse(line.begin(), line.end());
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    best_.bestPegs = pegs;
+    best_.line     = std::move(line);
+}
@@ -0,0 +1,94 @@
+#pragma once
+// 随时可中断的束搜索：棋盘太大无法精确求解时，给出较好的走法和“最少剩余棋子”估计
+#include "board.hpp"
+#include "solver.hpp"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 束搜索参数
+struct BeamConfig {
+    int    width      = 1000;   // 第一轮束宽，之后每轮翻倍
+    double timeBudget = 2.0;    // 总时间预算（秒）
+    int    threads    = 0;      // 0 = 按 CPU 核数
+
+    // 启发式权重：机动性 / 相邻成对 / 孤立棋子 / 宝塔值
+    float wMobility = 1.0f;
+    float wCluster  = 0.5f;
+    float wIsolated = 2.0f;
+    float wPagoda   = 0.3f;
+};
+
+// 目前找到的最好结果
+struct BeamResult {
+    std::vector<Jump> line;          // 从初始局面开始的走法序列
+    int       startPegs = 0;
+    int       bestPegs  = 0;         // 能走到的最少棋子数
+    long long nodes     = 0;         // 已展开的局面数
+    int       passes    = 0;         // 已完成的轮数
+    int       width     = 0;         // 当前轮的束宽
+    bool      finished  = false;     // 已停止（时间用完 / 找到一子解 / 被叫停）
+};
+
+class BeamSearch {
+public:
+    // goal.isDead 用于剪掉必败分支（如国王被吃）；默认不剪枝
+    explicit BeamSearch(const std::vector<Board>& floors,
+                        const BeamConfig& cfg = BeamConfig(),
+                        const SolveGoal& goal = SolveGoal());
+    ~BeamSearch();
+
+    BeamSearch(const BeamSearch&) = delete;
+    BeamSearch& operator=(const BeamSearch&) = delete;
+
+    void start();                    // 在后台线程中搜索
+    void stop();                     // 请求停止并等待后台线程
+    bool running() const { return running_.load(); }
+
+    BeamResult best() const;         // 任何时候都可调用
+    BeamResult run();                // 同步搜索，预算用完后返回
+
+    // 局面打分（越大越好）
+    static float evaluate(const std::vector<Board>& floors, const BeamConfig& cfg);
+
+private:
+    // 上一层留下的走法记录，用来回溯出整条路线
+    struct Trace {
+        int  parent;
+        Jump move;
+    };
+
+    // 当前层的局面
+    struct Node {
+        std::vector<Board> floors;
+        std::uint64_t      hash   = 0;
+        float              score  = 0.f;
+        int                parent = -1;  // 父局面在 traces_ 中的下标，根为 -1
+        Jump               move;         // 从父局面走到这里的一步
+        int                trace  = -1;  // 入选后自己在 traces_ 中的下标
+    };
+
+    void searchLoop();
+    bool pass(int width);            // 一轮完整的束搜索；被打断时返回 false
+    void expandRange(const std::vector<Node>& parents, int begin, int end,
+                     std::vector<Node>& out, long long& nodes);
+    void publish(int traceIndex, int pegs, int width);
+    bool outOfTime() const;
+
+    std::vector<Board> root_;
+    BeamConfig         cfg_;
+    SolveGoal          goal_;
+    int                threads_ = 1;
+
+    std::vector<Trace> traces_;      // 仅当前轮使用
+
+    std::thread       worker_;
+    std::atomic<bool> stop_{false};
+    std::atomic<bool> running_{false};
+    std::chrono::steady_clock::time_point deadline_;
+
+    mutable std::mutex mutex_;
+    BeamResult         best_;
+};
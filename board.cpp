@@ -1,18 +1,10 @@
 // 只做规则和数据
 #include "board.hpp"
-#include <random>
+#include <algorithm>
 #include <cmath>
 
-// 小工具：随机整数 [a,b]
-static int randomInt(int a, int b) {
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    std::uniform_int_distribution<int> dist(a, b);
-    return dist(gen);
-}
-
-Board::Board(GameMode mode, MapShape shape, SpecialConfig special)
-    : mode_(mode), shape_(shape), special_(special)
+Board::Board(GameMode mode, MapShape shape, SpecialConfig special, std::uint64_t seed)
+    : mode_(mode), shape_(shape), special_(special), seed_(seed)
 {
     reset();
 }
@@ -41,14 +33,75 @@ void Board::initBoardArrays() {
     }
 }
 
+// ===== 规则集 =====
+
+// 编译期规则策略：false 的检查在实例化时整段去掉
+struct RulesPlain   { static constexpr bool barrier = false, ice = false, king = false; };
+struct RulesBarrier { static constexpr bool barrier = true,  ice = false, king = false; };
+struct RulesIce     { static constexpr bool barrier = false, ice = true,  king = false; };
+struct RulesKing    { static constexpr bool barrier = false, ice = false, king = true;  };
+struct RulesFull    { static constexpr bool barrier = true,  ice = true,  king = true;  };
+
+// 按规则集调用 f(策略对象)；每次公开调用只分派这一次，循环都在实例化后的函数里
+template <class F>
+static auto withRules(RuleSet rules, F&& f) {
+    switch (rules) {
+    case RuleSet::Plain:   return f(RulesPlain());
+    case RuleSet::Barrier: return f(RulesBarrier());
+    case RuleSet::Ice:     return f(RulesIce());
+    case RuleSet::King:    return f(RulesKing());
+    default:               return f(RulesFull());
+    }
+}
+
+static RuleSet rulesFor(bool barrier, bool ice, bool king) {
+    int n = (barrier ? 1 : 0) + (ice ? 1 : 0) + (king ? 1 : 0);
+    if (n == 0) return RuleSet::Plain;
+    if (n > 1)  return RuleSet::Full;
+    return barrier ? RuleSet::Barrier : (ice ? RuleSet::Ice : RuleSet::King);
+}
+
+// 放进一格 type 之后仍然够用的规则集
+static RuleSet rulesWithTile(RuleSet rules, CellType type) {
+    RuleSet need;
+    switch (type) {
+    case CellType::Barrier: need = RuleSet::Barrier; break;
+    case CellType::Ice:     need = RuleSet::Ice;     break;
+    case CellType::King:    need = RuleSet::King;    break;
+    default:                return rules;
+    }
+    if (rules == RuleSet::Plain || rules == need) return need;
+    return RuleSet::Full;
+}
+
+void Board::refreshRules() {
+    bool barrier = false, ice = false, king = false;
+    for (int r = 0; r < Rows; ++r) {
+        for (int c = 0; c < Cols; ++c) {
+            barrier |= (type_[r][c] == CellType::Barrier);
+            ice     |= (type_[r][c] == CellType::Ice);
+            king    |= (type_[r][c] == CellType::King);
+        }
+    }
+    rules_ = rulesFor(barrier, ice, king);
+}
+
 void Board::reset() {
+    BoardRng rng(seed_);
+    // 规则集只看配置：配了冰格但这次一格都没布上也按冰格规则走，同一配置的棋盘走同一份代码
+    rules_ = rulesFor(special_.useBarrier, special_.useIce, mode_ == GameMode::Chess);
     initBoardArrays();
     initShape();             // 按照形状铺满格子
     initWinCells();         // 根据模式设置Goal/King
     if (special_.extraHoles) {
-        digRandomHoles();       // 随机挖洞
+        digRandomHoles(rng);    // 随机挖洞
     }
-    applySpecialTiles();   //   根据特殊配置设置特殊格子
+    applySpecialTiles(rng); //   根据特殊配置设置特殊格子
+}
+
+void Board::reset(std::uint64_t seed) {
+    seed_ = seed;
+    reset();
 }
 
 // ===== 形状 =====
@@ -162,73 +215,63 @@ void Board::initWinCells() {
 }
 
 // ===== 随机布置特殊格子 =====
+//
+// 先列出所有候选格，再从列表里不放回地抽：次数固定，稀疏形状上也不会反复落空
 
-void Board::applySpecialTiles() {
-    // 冰格：可以保留棋子
-    if (special_.useIce) {
-        int count = randomInt(1, 5);
-        for (int i = 0; i < count; ++i) {
-            int r = randomInt(0, Rows-1);
-            int c = randomInt(0, Cols-1);
-            if (board_[r][c] == CellState::Invalid) {
-                --i; 
-                continue; 
-            }
-            if (type_[r][c] == CellType::Goal ||
-                type_[r][c] == CellType::King) {
-                --i; 
-                continue; 
+void Board::applySpecialTiles(BoardRng& rng) {
+    // 候选：有效格，且不是目标格 / 国王。三种特殊格依次从剩下的候选里抽，互不覆盖
+    int cells[Rows * Cols];
+    int n = 0;
+    for (int r = 0; r < Rows; ++r) {
+        for (int c = 0; c < Cols; ++c) {
+            if (board_[r][c] != CellState::Invalid &&
+                type_[r][c] != CellType::Goal &&
+                type_[r][c] != CellType::King) {
+                cells[n++] = r * Cols + c;
             }
-
-            type_[r][c] = CellType::Ice;
         }
     }
 
-    // 沼泽格：没有棋子，不能落子
-    if (special_.useSwamp) {
-        int count = randomInt(1, 5);
-        for (int i = 0; i < count; ++i) {
-            int r = randomInt(0, Rows-1);
-            int c = randomInt(0, Cols-1);
-            if (board_[r][c] == CellState::Invalid) { --i; continue; }
-            if (type_[r][c] == CellType::Goal ||
-                type_[r][c] == CellType::King)   { --i; continue; }
-
-            type_[r][c] = CellType::Swamp;
-            board_[r][c] = CellState::Empty; // 沼泽格起始不放棋子
+    auto place = [&](CellType type, bool clearPeg) {
+        int count = rng.range(1, 5);
+        for (int i = 0; i < count && n > 0; ++i) {
+            int k = rng.range(0, n - 1);
+            int r = cells[k] / Cols;
+            int c = cells[k] % Cols;
+            cells[k] = cells[--n];
+
+            type_[r][c] = type;
+            if (clearPeg) board_[r][c] = CellState::Empty;
         }
-    }
+    };
 
+    // 冰格：可以保留棋子
+    if (special_.useIce)     place(CellType::Ice, false);
+    // 沼泽格：没有棋子，不能落子
+    if (special_.useSwamp)   place(CellType::Swamp, true);
     // 障碍格：没有棋子，不能落子，也不能被跳过
-    if (special_.useBarrier) {
-        int count = randomInt(1, 5);
-        for (int i = 0; i < count; ++i) {
-            int r = randomInt(0, Rows-1);
-            int c = randomInt(0, Cols-1);
-            if (board_[r][c] == CellState::Invalid) { --i; continue; }
-            if (type_[r][c] == CellType::Goal ||
-                type_[r][c] == CellType::King)   { --i; continue; }
-
-            type_[r][c] = CellType::Barrier;
-            board_[r][c] = CellState::Empty; // 障碍格起始不放棋子
-        }
-    }
+    if (special_.useBarrier) place(CellType::Barrier, true);
 }
 
-void Board::digRandomHoles(){
-    int holes = randomInt(1, 5);
-    int made = 0;
-    int guard = 100;
-    while (made < holes && guard-- > 0) {
-        int r = randomInt(0, Rows-1);
-        int c = randomInt(0, Cols-1);
-        if (board_[r][c] == CellState::Peg &&
-            type_[r][c] != CellType::Goal &&
-            type_[r][c] != CellType::King
-        ) {board_[r][c] = CellState::Empty;
-            ++made;
+void Board::digRandomHoles(BoardRng& rng) {
+    int cells[Rows * Cols];
+    int n = 0;
+    for (int r = 0; r < Rows; ++r) {
+        for (int c = 0; c < Cols; ++c) {
+            if (board_[r][c] == CellState::Peg &&
+                type_[r][c] != CellType::Goal &&
+                type_[r][c] != CellType::King) {
+                cells[n++] = r * Cols + c;
+            }
         }
     }
+
+    int holes = rng.range(1, 5);
+    for (int i = 0; i < holes && n > 0; ++i) {
+        int k = rng.range(0, n - 1);
+        board_[cells[k] / Cols][cells[k] % Cols] = CellState::Empty;
+        cells[k] = cells[--n];
+    }
 }
 
 // ===== 基本访问 =====
@@ -248,6 +291,7 @@ void Board::set(int r, int c, CellState state) {
 void Board::setType(int r, int c, CellType type) {
     if (r < 0 || r >= Rows || c < 0 || c >= Cols) return;
     type_[r][c] = type;
+    rules_ = rulesWithTile(rules_, type);
 }
 bool Board::inBounds(int r, int c) const {
     if (r < 0 || r >= Rows || c < 0 || c >= Cols) return false;
@@ -257,14 +301,21 @@ bool Board::inBounds(int r, int c) const {
 
 // ===== 走子规则 =====
 
-bool Board::canJump(int r1, int c1, int r2, int c2) const {
-    if (!inBounds(r1, c1) || !inBounds(r2, c2)) return false;
+// 棋子 / 空格本身就说明不是 Invalid，所以只查坐标范围，不再逐个调 inBounds
+static inline bool inRange(int r, int c) {
+    return static_cast<unsigned>(r) < static_cast<unsigned>(Board::Rows) &&
+           static_cast<unsigned>(c) < static_cast<unsigned>(Board::Cols);
+}
+
+template <class R>
+bool Board::canJumpAs(int r1, int c1, int r2, int c2) const {
+    if (!inRange(r1, c1) || !inRange(r2, c2)) return false;
 
     if (board_[r1][c1] != CellState::Peg)   return false;
     if (board_[r2][c2] != CellState::Empty) return false;
 
-    // 不能落在沼泽或障碍上
-    if (type_[r2][c2] == CellType::Barrier) return false;
+    // 不能落在障碍上
+    if (R::barrier && type_[r2][c2] == CellType::Barrier) return false;
 
     int dr = r2 - r1;
     int dc = c2 - c1;
@@ -278,63 +329,72 @@ bool Board::canJump(int r1, int c1, int r2, int c2) const {
     int rm = r1 + dr / 2;
     int cm = c1 + dc / 2;
 
-    if (!inBounds(rm, cm)) return false;
     if (board_[rm][cm] != CellState::Peg) return false;
 
     // 中间不能是障碍
-    if (type_[rm][cm] == CellType::Barrier) return false;
+    if (R::barrier && type_[rm][cm] == CellType::Barrier) return false;
 
     return true;
 }
 
-bool Board::canMove(int r, int c) const {
-    if (!inBounds(r, c))              return false;
-    if (board_[r][c] != CellState::Peg) return false;
-
+template <class R>
+std::uint64_t Board::targetMaskAs(int r, int c) const {
+    std::uint64_t mask = 0;
+    if (!inRange(r, c) || board_[r][c] != CellState::Peg) {
+        return mask;
+    }
+    // 起点只查一次；方向固定，中间格一定在范围内
     static const int dr[4] = {-2, 2, 0, 0};
     static const int dc[4] = {0, 0, -2, 2};
     for (int k = 0; k < 4; ++k) {
         int r2 = r + dr[k];
         int c2 = c + dc[k];
-        if (canJump(r, c, r2, c2)) return true;
+        if (!inRange(r2, c2) || board_[r2][c2] != CellState::Empty) continue;
+        int rm = r + dr[k] / 2;
+        int cm = c + dc[k] / 2;
+        if (board_[rm][cm] != CellState::Peg) continue;
+        if (R::barrier && (type_[r2][c2] == CellType::Barrier ||
+                           type_[rm][cm] == CellType::Barrier)) continue;
+        mask |= cellBit(r2, c2);
     }
-    return false;
+    return mask;
 }
 
-std::vector<std::pair<int,int>> Board::getPossibleTargets(int r, int c) const {
-    std::vector<std::pair<int,int>> res;
-    if (!inBounds(r, c) || board_[r][c] != CellState::Peg) {
-        return res;
-    }
-    static const int dr[4] = {-2, 2, 0, 0};
-    static const int dc[4] = {0, 0, -2, 2};
-    for (int k = 0; k < 4; ++k) {
-        int r2 = r + dr[k];
-        int c2 = c + dc[k];
-        if (canJump(r, c, r2, c2)) {
-            res.emplace_back(r2, c2);
+template <class R>
+bool Board::canMoveAs(int r, int c) const {
+    return targetMaskAs<R>(r, c) != 0;
+}
+
+template <class R>
+bool Board::hasMoveAs() const {
+    for (int r = 0; r < Rows; ++r) {
+        for (int c = 0; c < Cols; ++c) {
+            if (canMoveAs<R>(r, c)) return true;
         }
     }
-    return res;
+    return false;
 }
 
-void Board::applyJump(int r1, int c1, int r2, int c2) {
-    if (!canJump(r1, c1, r2, c2)) return;
+template <class R>
+void Board::applyJumpAs(int r1, int c1, int r2, int c2) {
+    if (!canJumpAs<R>(r1, c1, r2, c2)) return;
 
     int dr = r2 - r1;
     int dc = c2 - c1;
     int rm = r1 + dr / 2;
     int cm = c1 + dc / 2;
 
-    bool kingMoving = (type_[r1][c1] == CellType::King);
-    bool kingCaptured = (type_[rm][cm] == CellType::King);
-
     board_[r1][c1] = CellState::Empty;
     board_[rm][cm] = CellState::Empty;
     board_[r2][c2] = CellState::Peg;
 
+    if (!R::king) return;
+
+    bool kingMoving = (type_[r1][c1] == CellType::King);
+    bool kingCaptured = (type_[rm][cm] == CellType::King);
+
     if (kingMoving){
-        type_[r1][c2] = CellType::Normal;
+        type_[r1][c1] = CellType::Normal;
         type_[r2][c2] = CellType::King;
     }
     if (kingCaptured){
@@ -342,6 +402,67 @@ void Board::applyJump(int r1, int c1, int r2, int c2) {
     }
 }
 
+template <class R>
+bool Board::applyMoveAs(int r1, int c1, int r2, int c2, int& finalR, int& finalC) {
+    finalR = r2;
+    finalC = c2;
+    if (!canJumpAs<R>(r1, c1, r2, c2)) return false;
+    applyJumpAs<R>(r1, c1, r2, c2);
+
+    // 冰格逻辑：如果落在 Ice 上，且前方一格为空 & 不是障碍，则滑一步
+    if (!R::ice || type_[r2][c2] != CellType::Ice) return false;
+
+    int dr = r2 - r1;
+    int dc = c2 - c1;
+    int stepR = (dr == 0 ? 0 : dr / std::abs(dr));
+    int stepC = (dc == 0 ? 0 : dc / std::abs(dc));
+
+    int slideRow = r2 + stepR;
+    int slideCol = c2 + stepC;
+
+    if (!inBounds(slideRow, slideCol) ||
+        board_[slideRow][slideCol] != CellState::Empty ||
+        (R::barrier && type_[slideRow][slideCol] == CellType::Barrier)) {
+        return false;
+    }
+
+    board_[r2][c2] = CellState::Empty;
+    board_[slideRow][slideCol] = CellState::Peg;
+    finalR = slideRow;
+    finalC = slideCol;
+    return true;
+}
+
+bool Board::canJump(int r1, int c1, int r2, int c2) const {
+    return withRules(rules_, [&](auto rules) {
+        return canJumpAs<decltype(rules)>(r1, c1, r2, c2);
+    });
+}
+
+bool Board::canMove(int r, int c) const {
+    return withRules(rules_, [&](auto rules) {
+        return canMoveAs<decltype(rules)>(r, c);
+    });
+}
+
+std::uint64_t Board::targetMask(int r, int c) const {
+    return withRules(rules_, [&](auto rules) {
+        return targetMaskAs<decltype(rules)>(r, c);
+    });
+}
+
+void Board::applyJump(int r1, int c1, int r2, int c2) {
+    withRules(rules_, [&](auto rules) {
+        applyJumpAs<decltype(rules)>(r1, c1, r2, c2);
+    });
+}
+
+bool Board::applyMove(int r1, int c1, int r2, int c2, int& finalR, int& finalC) {
+    return withRules(rules_, [&](auto rules) {
+        return applyMoveAs<decltype(rules)>(r1, c1, r2, c2, finalR, finalC);
+    });
+}
+
 int Board::countPegs() const {
     int cnt = 0;
     for (int r = 0; r < Rows; ++r) {
@@ -353,14 +474,242 @@ int Board::countPegs() const {
 }
 
 bool Board::hasMove() const {
+    return withRules(rules_, [&](auto rules) {
+        return hasMoveAs<decltype(rules)>();
+    });
+}
+
+bool Board::isSolved() const {
+    return countPegs() == 1;
+}
+
+void Board::packCells(std::uint8_t* out) const {
+    for (int r = 0; r < Rows; ++r) {
+        for (int c = 0; c < Cols; ++c) {
+            *out++ = static_cast<std::uint8_t>(
+                static_cast<int>(board_[r][c]) | (static_cast<int>(type_[r][c]) << 2));
+        }
+    }
+}
+
+void Board::unpackCells(const std::uint8_t* in) {
+    for (int r = 0; r < Rows; ++r) {
+        for (int c = 0; c < Cols; ++c) {
+            std::uint8_t v = *in++;
+            board_[r][c] = static_cast<CellState>(v & 3);
+            type_[r][c]  = static_cast<CellType>(v >> 2);
+        }
+    }
+    refreshRules();
+}
+
+std::uint64_t Board::hash() const {
+    return symHash(0);
+}
+
+std::uint64_t Board::symHash(int sym) const {
+    static_assert(Rows == Cols, "对称变换要求方形棋盘");
+    // FNV-1a；目标格 (r,c) 取变换后的源格
+    std::uint64_t h = 1469598103934665603ULL;
     for (int r = 0; r < Rows; ++r) {
         for (int c = 0; c < Cols; ++c) {
-            if (canMove(r, c)) return true;
+            int sr = (sym & 4) ? c : r;
+            int sc = (sym & 4) ? r : c;
+            if (sym & 1) sr = Rows - 1 - sr;
+            if (sym & 2) sc = Cols - 1 - sc;
+            h ^= static_cast<std::uint64_t>(board_[sr][sc]) |
+                 (static_cast<std::uint64_t>(type_[sr][sc]) << 2);
+            h *= 1099511628211ULL;
+        }
+    }
+    return h;
+}
+
+std::uint64_t Board::canonicalHash() const {
+    std::uint64_t best = symHash(0);
+    for (int s = 1; s < 8; ++s) {
+        std::uint64_t h = symHash(s);
+        if (h < best) best = h;
+    }
+    return best;
+}
+
+// ===== 多层走子 =====
+
+std::uint64_t floorsHash(const std::vector<Board>& floors) {
+    std::uint64_t h = 0;
+    for (const auto& b : floors) {
+        h = (h ^ b.hash()) * 0x9E3779B97F4A7C15ULL;
+    }
+    return h;
+}
+
+std::uint64_t floorsCanonicalHash(const std::vector<Board>& floors) {
+    std::uint64_t best = 0;
+    for (int s = 0; s < 8; ++s) {
+        std::uint64_t h = 0;
+        for (const auto& b : floors) {
+            h = (h ^ b.symHash(s)) * 0x9E3779B97F4A7C15ULL;
+        }
+        if (s == 0 || h < best) best = h;
+    }
+    return best;
+}
+
+int floorsPegs(const std::vector<Board>& floors) {
+    int sum = 0;
+    for (const auto& b : floors) sum += b.countPegs();
+    return sum;
+}
+
+// 按层、行、列、方向的固定顺序列出
+void collectFloorJumps(const std::vector<Board>& floors, std::vector<Jump>& out) {
+    static const int dr[4] = {-2, 2, 0, 0};
+    static const int dc[4] = {0, 0, -2, 2};
+    out.clear();
+    for (int f = 0; f < static_cast<int>(floors.size()); ++f) {
+        const Board& b = floors[f];
+        for (int r = 0; r < Board::Rows; ++r) {
+            for (int c = 0; c < Board::Cols; ++c) {
+                if (b.at(r, c) != CellState::Peg) continue;
+                if (b.typeAt(r, c) == CellType::Swamp) continue;
+                // 每颗棋子只按规则集分派一次，四个方向在实例化后的代码里判断
+                std::uint64_t targets = b.targetMask(r, c);
+                if (!targets) continue;
+                for (int k = 0; k < 4; ++k) {
+                    int r2 = r + dr[k], c2 = c + dc[k];
+                    if (r2 < 0 || r2 >= Board::Rows || c2 < 0 || c2 >= Board::Cols) continue;
+                    if (targets & cellBit(r2, c2)) {
+                        out.push_back(Jump{f, r, c, r2, c2});
+                    }
+                }
+            }
+        }
+    }
+}
+
+// ===== 传送链接 =====
+
+void TeleportLinks::reset(int floors) {
+    floors_ = std::max(0, std::min(floors, MaxFloors));
+    count_  = 0;
+    dest_.assign(static_cast<std::size_t>(floors_) * Board::Rows * Board::Cols, None);
+}
+
+bool TeleportLinks::add(const TeleportLink& l) {
+    auto cellOk = [](int r, int c) {
+        return r >= 0 && r < Board::Rows && c >= 0 && c < Board::Cols;
+    };
+    if (l.floor < 0 || l.floor >= floors_ || l.toFloor < 0 || l.toFloor >= floors_) return false;
+    if (!cellOk(l.row, l.col) || !cellOk(l.toRow, l.toCol)) return false;
+
+    std::uint16_t& d = dest_[l.floor * Board::Rows * Board::Cols + l.row * Board::Cols + l.col];
+    if (d == None) ++count_;
+    d = static_cast<std::uint16_t>((l.toFloor << 8) | (l.toRow * Board::Cols + l.toCol));
+    return true;
+}
+
+bool TeleportLinks::find(int floor, int row, int col, int& toFloor, int& toRow, int& toCol) const {
+    if (floor < 0 || floor >= floors_) return false;
+    std::uint16_t d = dest_[floor * Board::Rows * Board::Cols + row * Board::Cols + col];
+    if (d == None) return false;
+    toFloor = d >> 8;
+    toRow   = (d & 0xFF) / Board::Cols;
+    toCol   = (d & 0xFF) % Board::Cols;
+    return true;
+}
+
+void defaultTeleportLinks(const std::vector<Board>& floors, TeleportLinks& out) {
+    int n = static_cast<int>(floors.size());
+    out.reset(n);
+    for (int f = 0; f + 1 < n; ++f) {
+        for (int r = 0; r < Board::Rows; ++r) {
+            for (int c = 0; c < Board::Cols; ++c) {
+                if (floors[f].typeAt(r, c) == CellType::Teleport) {
+                    out.add(TeleportLink{f, r, c, f + 1, r, c});
+                }
+            }
+        }
+    }
+}
+
+bool applyFloorMove(std::vector<Board>& floors, int floor,
+                    int r1, int c1, int r2, int c2,
+                    MoveResult& result,
+                    const TeleportLinks* links)
+{
+    Board& board = floors[floor];
+    result = MoveResult();
+    result.floor = floor;
+    if (!board.canJump(r1, c1, r2, c2)) return false;
+
+    result.kingCaptured =
+        (board.typeAt((r1 + r2) / 2, (c1 + c2) / 2) == CellType::King);
+
+    int finalRow, finalCol;
+    result.iceSlide = board.applyMove(r1, c1, r2, c2, finalRow, finalCol);
+    result.row     = finalRow;
+    result.col     = finalCol;
+    result.landRow = finalRow;
+    result.landCol = finalCol;
+
+    if (board.typeAt(finalRow, finalCol) != CellType::Teleport) return true;
+
+    // 传送格逻辑：按链接表找目标；没有链接表时传到下一层同坐标
+    int dstFloor = floor + 1, dstRow = finalRow, dstCol = finalCol;
+    if (links && !links->find(floor, finalRow, finalCol, dstFloor, dstRow, dstCol)) return true;
+    if (dstFloor >= static_cast<int>(floors.size())) return true;
+
+    Board& dstBoard = floors[dstFloor];
+    if (dstBoard.inBounds(dstRow, dstCol) &&
+        dstBoard.at(dstRow, dstCol) == CellState::Empty)
+    {
+        bool kingTeleporting = (board.typeAt(finalRow, finalCol) == CellType::King);
+
+        board.set(finalRow, finalCol, CellState::Empty);
+        if (kingTeleporting) {
+            board.setType(finalRow, finalCol, CellType::Normal);
+        }
+
+        dstBoard.set(dstRow, dstCol, CellState::Peg);
+        if (kingTeleporting) {
+            dstBoard.setType(dstRow, dstCol, CellType::King);
+        }
+
+        result.floor    = dstFloor;
+        result.row      = dstRow;
+        result.col      = dstCol;
+        result.teleport = true;
+    }
+    return true;
+}
+
+// ===== 胜负判断 =====
+
+// 单层：是否“只剩一个棋子且在 Goal 格子上”
+bool isGoalWin(const Board& board) {
+    int pegCount = board.countPegs();
+    if (pegCount != 1) return false;
+
+    for (int r = 0; r < Board::Rows; ++r) {
+        for (int c = 0; c < Board::Cols; ++c) {
+            if (board.at(r, c) == CellState::Peg) {
+                return (board.typeAt(r, c) == CellType::Goal);
+            }
         }
     }
     return false;
 }
 
-bool Board::isSolved() const {
-    return countPegs() == 1;
+// 单层：国王是否仍然存活（有棋子在 King 格上）
+bool isKingAlive(const Board& board) {
+    for (int r = 0; r < Board::Rows; ++r) {
+        for (int c = 0; c < Board::Cols; ++c) {
+            if (board.typeAt(r, c) == CellType::King &&
+                board.at(r, c) == CellState::Peg) {
+                return true;
+            }
+        }
+    }
+    return false;
 }
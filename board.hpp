@@ -1,5 +1,6 @@
 #pragma once
 #include <vector>
+#include <cstdint>
 
 // 游戏模式：传统 / 目标格子 / 保护国王
 enum class GameMode {
@@ -34,6 +35,16 @@ enum class CellType {
     Teleport    // 传送格：跳到另一格
 };
 
+// 走子规则集：Board 在 reset() 时按模式和特殊格配置选一个，走法生成和走子按它实例化，
+// 用不到的检查（障碍、冰滑、国王跟随）在编译期去掉。之后放进来的格子类型超出当前规则集时自动升级
+enum class RuleSet : std::uint8_t {
+    Plain,      // 没有障碍、冰格、国王
+    Barrier,    // 只有障碍
+    Ice,        // 只有冰格
+    King,       // 只有国王
+    Full        // 两种及以上，全部检查
+};
+
 // 一局游戏的特殊格子配置
 struct SpecialConfig {
     bool useIce     = false;
@@ -42,6 +53,47 @@ struct SpecialConfig {
     bool extraHoles = false;
 };
 
+// 一步走子的结果：棋子最终所在楼层与位置，以及触发的效果
+struct MoveResult {
+    int  floor        = 0;
+    int  row          = -1;
+    int  col          = -1;
+    int  landRow      = -1;     // 起跳层上跳跃 / 冰滑停下的位置（传送前）
+    int  landCol      = -1;
+    bool iceSlide     = false;
+    bool teleport     = false;
+    bool kingCaptured = false;
+};
+
+// 一次跳跃（多层时带楼层）
+struct Jump {
+    int floor = 0;
+    int r1 = -1, c1 = -1;
+    int r2 = -1, c2 = -1;
+};
+
+// 生成棋盘用的小随机数发生器（SplitMix64）。每次 reset 在栈上新建，
+// 线程之间不共享状态；同一种子永远得到同一串数
+class BoardRng {
+public:
+    explicit BoardRng(std::uint64_t seed) : state_(seed) {}
+
+    std::uint64_t next() {
+        std::uint64_t z = (state_ += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+    // [a, b] 内均匀取整数
+    int range(int a, int b) {
+        std::uint64_t span = static_cast<std::uint64_t>(b - a + 1);
+        return a + static_cast<int>(((next() >> 32) * span) >> 32);
+    }
+
+private:
+    std::uint64_t state_;
+};
+
 // 只负责规则和数据
 class Board {
 public:
@@ -50,13 +102,16 @@ public:
 
     Board(GameMode mode = GameMode::Classic,
           MapShape shape = MapShape::Cross,
-          SpecialConfig special = {});
+          SpecialConfig special = {},
+          std::uint64_t seed = 0);
 
     void setMode(GameMode m);
     void setShape(MapShape s);
     void setSpecialConfig(const SpecialConfig& cfg);
 
-    void reset();   // 重新生成棋盘（形状 + 目标格/国王 + 特殊格）
+    void reset();   // 重新生成棋盘（形状 + 目标格/国王 + 特殊格），用当前种子
+    void reset(std::uint64_t seed);     // 换种子再生成：同一配置 + 同一种子 = 同一棋盘
+    std::uint64_t seed() const { return seed_; }
 
     // 访问
     CellState at(int r, int c) const;
@@ -65,17 +120,30 @@ public:
     void setType(int r, int c, CellType t);
 
     bool inBounds(int r, int c) const;  // 在棋盘内且不是 Invalid
+    RuleSet rules() const { return rules_; }
+    void    refreshRules();             // 按实际格子类型重选规则集（整块拷进来的棋盘用，如读档）
 
     bool canMove(int r, int c) const;   // 该格上的棋子是否有合法跳跃
-    std::vector<std::pair<int,int>> getPossibleTargets(int r, int c) const;  // 获取合法跳跃目标
+    std::uint64_t targetMask(int r, int c) const;  // 合法落点位掩码（第 r * Cols + c 位），不分配
 
     bool canJump(int r1, int c1, int r2, int c2) const;
     void applyJump(int r1, int c1, int r2, int c2);
+    // 跳跃 + 冰格滑行；finalR/finalC 为棋子最终位置，发生滑行时返回 true
+    bool applyMove(int r1, int c1, int r2, int c2, int& finalR, int& finalC);
 
     int  countPegs() const;             // 棋盘上棋子的数量
     bool hasMove() const;               // 是否还有任何可行步
     bool isSolved() const;              // 是否只剩一个棋子（传统模式用）
 
+    // 紧凑编码：每格一个字节（低 2 位棋子状态，高位格子类型）
+    static constexpr int PackedSize = Rows * Cols;
+    void packCells(std::uint8_t* out) const;
+    void unpackCells(const std::uint8_t* in);
+
+    std::uint64_t hash() const;         // 局面哈希（棋子 + 格子类型）
+    std::uint64_t symHash(int sym) const;  // 按 8 种旋转/翻转之一变换后的哈希，sym = 0..7
+    std::uint64_t canonicalHash() const;   // 8 种对称中最小的哈希
+
 private:
     void initBoardArrays();
     void initShape();       // 根据形状生成基本棋局
@@ -85,12 +153,114 @@ private:
     void initDiamond();
 
     void initWinCells();    // 按游戏模式设置 Goal / King 等
-    void applySpecialTiles();// 按 SpecialConfig 随机布置冰格/沼泽/障碍
-    void digRandomHoles();  // 随机挖空格
+    void applySpecialTiles(BoardRng& rng);  // 按 SpecialConfig 随机布置冰格/沼泽/障碍
+    void digRandomHoles(BoardRng& rng);     // 随机挖空格
+
+    // 按规则策略实例化的走子规则（定义在 board.cpp）；公开接口按 rules_ 分派一次
+    template <class R> bool          canJumpAs(int r1, int c1, int r2, int c2) const;
+    template <class R> bool          canMoveAs(int r, int c) const;
+    template <class R> std::uint64_t targetMaskAs(int r, int c) const;
+    template <class R> bool          hasMoveAs() const;
+    template <class R> void          applyJumpAs(int r1, int c1, int r2, int c2);
+    template <class R> bool          applyMoveAs(int r1, int c1, int r2, int c2, int& finalR, int& finalC);
 
     GameMode      mode_;
     MapShape      shape_;
     SpecialConfig special_;
+    RuleSet       rules_ = RuleSet::Full;   // 放在 special_ 后的填充里，sizeof(Board) 不变
+    std::uint64_t seed_ = 0;
     CellState     board_[Rows][Cols];
     CellType      type_[Rows][Cols];
 };
+
+// ===== 走法表 / 位掩码 =====
+
+// 格子对应的位（r * Cols + c），7×7 正好放进一个 64 位字
+inline std::uint64_t cellBit(int r, int c) {
+    return 1ULL << (r * Board::Cols + c);
+}
+
+// 取出最低位对应的格子编号并清掉该位；mask 不能为 0。
+// 用法：while (m) { int i = popCell(m); int r = i / Board::Cols, c = i % Board::Cols; ... }
+inline int popCell(std::uint64_t& mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    int i = __builtin_ctzll(mask);
+#else
+    int i = 0;
+    while (!((mask >> i) & 1)) ++i;
+#endif
+    mask &= mask - 1;
+    return i;
+}
+
+// 定长走法表：直接放在栈上或当成员，不分配内存。
+// 容量按单块棋盘算：一个位掩码最多 64 格，每格最多 6 个方向（三角棋盘用）。
+// 多层局面的层数可达 MaxLayers，一律用 std::vector 版本的 collectFloorJumps
+struct JumpList {
+    static constexpr int Capacity = 64 * 6;
+
+    Jump items[Capacity];
+    int  count = 0;
+
+    void clear()                  { count = 0; }
+    bool empty() const            { return count == 0; }
+    int  size()  const            { return count; }
+    void push_back(const Jump& j) { items[count++] = j; }
+
+    const Jump& operator[](int i) const { return items[i]; }
+    const Jump* begin() const     { return items; }
+    const Jump* end()   const     { return items + count; }
+};
+
+// 单层：是否“只剩一个棋子且在 Goal 格子上”
+bool isGoalWin(const Board& board);
+// 单层：国王是否仍然存活（有棋子在 King 格上）
+bool isKingAlive(const Board& board);
+
+// 多层：局面哈希 / 对称归一哈希（所有层同时变换） / 总棋子数
+std::uint64_t floorsHash(const std::vector<Board>& floors);
+std::uint64_t floorsCanonicalHash(const std::vector<Board>& floors);
+int           floorsPegs(const std::vector<Board>& floors);
+
+// 多层：列出所有可选的跳跃（沼泽上的棋子不能被选中）
+void collectFloorJumps(const std::vector<Board>& floors, std::vector<Jump>& out);
+
+// 传送链接：起点层的传送格 → 目标层的目标格（可以跨任意层、换坐标）
+struct TeleportLink {
+    int floor   = 0;
+    int row     = -1;
+    int col     = -1;
+    int toFloor = 0;
+    int toRow   = -1;
+    int toCol   = -1;
+};
+
+// 按 层 × 格 平铺的链接表，走子时 O(1) 查目标；楼层编号存 8 位，最多 256 层
+class TeleportLinks {
+public:
+    static constexpr int MaxFloors = 256;
+
+    void reset(int floors);             // 清空并按层数分配
+    bool add(const TeleportLink& link); // 越界返回 false；同一起点后加的覆盖先加的
+    bool find(int floor, int row, int col, int& toFloor, int& toRow, int& toCol) const;
+
+    int  floors() const { return floors_; }
+    int  size()   const { return count_; }
+
+private:
+    static constexpr std::uint16_t None = 0xFFFF;
+
+    std::vector<std::uint16_t> dest_;   // floor * 49 + cell → (toFloor << 8) | toCell
+    int floors_ = 0;
+    int count_  = 0;
+};
+
+// 默认链接：每个传送格连到下一层同坐标（最后一层的传送格不连）
+void defaultTeleportLinks(const std::vector<Board>& floors, TeleportLinks& out);
+
+// 多层走子：跳跃 + 冰滑 + 传送（落在传送格且链接目标为空格时传过去）。
+// links 为空时按默认链接（下一层同坐标），求解器都走这条路
+bool applyFloorMove(std::vector<Board>& floors, int floor,
+                    int r1, int c1, int r2, int c2,
+                    MoveResult& result,
+                    const TeleportLinks* links = nullptr);
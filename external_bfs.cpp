@@ -0,0 +1,502 @@
+// 外存分层穷举
+#include "external_bfs.hpp"
+#include "position_codec.hpp"
+#include "solver.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <queue>
+
+// ===== 压缩文件：排序后的局面逐个写“与上一个的差” =====
+//
+// 文件头：magic(8) + 字数(4) + 保留(4) + 局面数(8)
+// 每条记录：1 字节“与上一条相同的前缀字数” k，第 k 个字的差值（变长整数），
+//           其后各字原样（变长整数）。
+
+static const char LEVEL_MAGIC[8] = {'P','E','G','L','V','L','0','1'};
+static const std::size_t IO_BUFFER = 1u << 20;
+
+class LevelWriter {
+public:
+    bool open(const std::string& path, int words) {
+        file_ = std::fopen(path.c_str(), "wb");
+        if (!file_) return false;
+        words_ = words;
+        count_ = 0;
+        bytes_ = 0;
+        std::memset(&prev_, 0, sizeof(prev_));
+        buf_.resize(IO_BUFFER);
+        used_ = 0;
+        std::uint32_t head[2] = {static_cast<std::uint32_t>(words), 0};
+        std::uint64_t count   = 0;
+        raw(LEVEL_MAGIC, sizeof(LEVEL_MAGIC));
+        raw(head, sizeof(head));
+        raw(&count, sizeof(count));     // 关闭时回填
+        return true;
+    }
+
+    void put(const PositionKey& k) {
+        int same = 0;
+        while (same < words_ - 1 && k.w[same] == prev_.w[same]) ++same;
+        byte(static_cast<std::uint8_t>(same));
+        varint(k.w[same] - prev_.w[same]);
+        for (int i = same + 1; i < words_; ++i) varint(k.w[i]);
+        prev_ = k;
+        ++count_;
+    }
+
+    long long count() const { return count_; }
+    long long bytes() const { return bytes_; }
+
+    bool close() {
+        if (!file_) return false;
+        flush();
+        std::uint64_t count = static_cast<std::uint64_t>(count_);
+        bool ok = std::fseek(file_, sizeof(LEVEL_MAGIC) + 8, SEEK_SET) == 0 &&
+                  std::fwrite(&count, sizeof(count), 1, file_) == 1;
+        ok = (std::fclose(file_) == 0) && ok;
+        file_ = nullptr;
+        return ok;
+    }
+
+    ~LevelWriter() {
+        if (file_) std::fclose(file_);
+    }
+
+private:
+    void flush() {
+        if (used_ > 0) std::fwrite(buf_.data(), 1, used_, file_);
+        bytes_ += static_cast<long long>(used_);
+        used_ = 0;
+    }
+    void byte(std::uint8_t b) {
+        if (used_ == buf_.size()) flush();
+        buf_[used_++] = b;
+    }
+    void raw(const void* p, std::size_t n) {
+        const std::uint8_t* s = static_cast<const std::uint8_t*>(p);
+        for (std::size_t i = 0; i < n; ++i) byte(s[i]);
+    }
+    void varint(std::uint64_t v) {
+        while (v >= 0x80) {
+            byte(static_cast<std::uint8_t>(v | 0x80));
+            v >>= 7;
+        }
+        byte(static_cast<std::uint8_t>(v));
+    }
+
+    std::FILE*                file_ = nullptr;
+    int                       words_ = 0;
+    long long                 count_ = 0;
+    long long                 bytes_ = 0;
+    PositionKey               prev_;
+    std::vector<std::uint8_t> buf_;
+    std::size_t               used_ = 0;
+};
+
+class LevelReader {
+public:
+    bool open(const std::string& path) {
+        file_ = std::fopen(path.c_str(), "rb");
+        if (!file_) return false;
+        buf_.resize(IO_BUFFER);
+        used_ = have_ = 0;
+        std::memset(&prev_, 0, sizeof(prev_));
+        char magic[8];
+        std::uint32_t head[2];
+        std::uint64_t count;
+        if (!raw(magic, sizeof(magic)) || !raw(head, sizeof(head)) || !raw(&count, sizeof(count)) ||
+            std::memcmp(magic, LEVEL_MAGIC, sizeof(magic)) != 0) {
+            return false;
+        }
+        if (head[0] < 1 || head[0] > static_cast<std::uint32_t>(PositionKey::MaxWords)) return false;
+        words_ = static_cast<int>(head[0]);
+        left_  = static_cast<long long>(count);
+        count_ = left_;
+        return true;
+    }
+
+    // 读完文件头记的条数后返回 false；没到条数就读不下去（文件被截断或记录损坏）时
+    // 也返回 false，并置 failed()，调用方据此区分正常结束和出错
+    bool next(PositionKey& k) {
+        if (left_ <= 0) return false;
+        std::uint8_t same;
+        std::uint64_t delta;
+        if (!byte(same) || same >= words_ || !varint(delta)) return fail();
+        k = prev_;
+        k.w[same] = prev_.w[same] + delta;
+        for (int i = same + 1; i < words_; ++i) {
+            if (!varint(k.w[i])) return fail();
+        }
+        prev_ = k;
+        --left_;
+        return true;
+    }
+
+    long long count()  const { return count_; }
+    bool      failed() const { return failed_; }
+
+    ~LevelReader() {
+        if (file_) std::fclose(file_);
+    }
+
+private:
+    bool fail() {
+        failed_ = true;
+        left_   = 0;
+        return false;
+    }
+    bool byte(std::uint8_t& b) {
+        if (used_ == have_) {
+            have_ = std::fread(buf_.data(), 1, buf_.size(), file_);
+            used_ = 0;
+            if (have_ == 0) return false;
+        }
+        b = buf_[used_++];
+        return true;
+    }
+    bool raw(void* p, std::size_t n) {
+        std::uint8_t* d = static_cast<std::uint8_t*>(p);
+        for (std::size_t i = 0; i < n; ++i) {
+            if (!byte(d[i])) return false;
+        }
+        return true;
+    }
+    bool varint(std::uint64_t& v) {
+        v = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            std::uint8_t b;
+            if (!byte(b)) return false;
+            v |= static_cast<std::uint64_t>(b & 0x7F) << shift;
+            if (!(b & 0x80)) return true;
+        }
+        return false;
+    }
+
+    std::FILE*                file_ = nullptr;
+    int                       words_ = 0;
+    long long                 left_  = 0;
+    long long                 count_ = 0;
+    bool                      failed_ = false;
+    PositionKey               prev_;
+    std::vector<std::uint8_t> buf_;
+    std::size_t               used_ = 0;
+    std::size_t               have_ = 0;
+};
+
+// ===== 排序成段 + 多路归并 =====
+
+static const std::size_t MAX_FAN_IN = 64;   // 一次最多同时打开的段文件
+
+class RunSorter {
+public:
+    RunSorter(const std::string& dir, int words, std::size_t memoryBytes)
+        : dir_(dir), words_(words)
+    {
+        std::size_t cap = memoryBytes / sizeof(PositionKey);
+        if (cap < 1024) cap = 1024;
+        buffer_.reserve(cap);
+    }
+
+    void add(const PositionKey& k) {
+        buffer_.push_back(k);
+        if (buffer_.size() == buffer_.capacity()) spill();
+    }
+
+    // 把所有段归并成一条有序、去重的流；sink 逐个接收
+    bool finish(const std::function<void(const PositionKey&)>& sink) {
+        if (runs_.empty()) {
+            // 一段都没溢出：直接在内存里排好
+            sortBuffer();
+            for (const auto& k : buffer_) sink(k);
+            buffer_.clear();
+            return true;
+        }
+        if (!buffer_.empty()) spill();
+        buffer_.clear();
+        buffer_.shrink_to_fit();
+
+        // 段太多时先分组归并，控制同时打开的文件数
+        while (runs_.size() > MAX_FAN_IN) {
+            std::vector<std::string> next;
+            for (std::size_t i = 0; i < runs_.size(); i += MAX_FAN_IN) {
+                std::vector<std::string> group(runs_.begin() + i,
+                    runs_.begin() + std::min(runs_.size(), i + MAX_FAN_IN));
+                std::string out = runPath();
+                LevelWriter w;
+                if (!w.open(out, words_)) return false;
+                if (!merge(group, [&](const PositionKey& k) { w.put(k); })) return false;
+                bytes_ += w.bytes();
+                if (!w.close()) return false;
+                next.push_back(out);
+            }
+            runs_.swap(next);
+        }
+        bool ok = merge(runs_, sink);
+        runs_.clear();
+        return ok;
+    }
+
+    long long bytesWritten() const { return bytes_; }
+    bool      failed()       const { return failed_; }
+
+private:
+    std::string runPath() {
+        return dir_ + "/run-" + std::to_string(nextRun_++) + ".tmp";
+    }
+
+    void sortBuffer() {
+        std::sort(buffer_.begin(), buffer_.end());
+        buffer_.erase(std::unique(buffer_.begin(), buffer_.end()), buffer_.end());
+    }
+
+    void spill() {
+        sortBuffer();
+        std::string path = runPath();
+        LevelWriter w;
+        if (!w.open(path, words_)) {
+            failed_ = true;
+            buffer_.clear();
+            return;
+        }
+        for (const auto& k : buffer_) w.put(k);
+        bytes_ += w.bytes();
+        if (!w.close()) failed_ = true;
+        runs_.push_back(path);
+        buffer_.clear();
+    }
+
+    // 多路归并，相同的键只输出一次；归并完删除输入段
+    bool merge(const std::vector<std::string>& inputs,
+               const std::function<void(const PositionKey&)>& sink)
+    {
+        std::vector<std::unique_ptr<LevelReader>> readers;
+        struct Head {
+            PositionKey key;
+            std::size_t src;
+        };
+        auto later = [](const Head& a, const Head& b) { return b.key < a.key; };
+        std::priority_queue<Head, std::vector<Head>, decltype(later)> heap(later);
+
+        for (const auto& path : inputs) {
+            readers.emplace_back(new LevelReader());
+            if (!readers.back()->open(path)) return false;
+            Head h{PositionKey{}, readers.size() - 1};
+            if (readers.back()->next(h.key)) heap.push(h);
+        }
+
+        bool first = true;
+        PositionKey last{};
+        while (!heap.empty()) {
+            Head h = heap.top();
+            heap.pop();
+            if (first || !(h.key == last)) {
+                sink(h.key);
+                last  = h.key;
+                first = false;
+            }
+            if (readers[h.src]->next(h.key)) heap.push(h);
+        }
+        // 段文件没读完整（写的时候磁盘满了之类），归并结果不完整
+        for (const auto& r : readers) {
+            if (r->failed()) return false;
+        }
+        readers.clear();
+        for (const auto& path : inputs) std::remove(path.c_str());
+        return true;
+    }
+
+    std::string              dir_;
+    int                      words_;
+    std::vector<PositionKey>         buffer_;
+    std::vector<std::string> runs_;
+    int                      nextRun_ = 0;
+    long long                bytes_   = 0;
+    bool                     failed_  = false;
+};
+
+// ===== 分层枚举 =====
+
+static std::string levelPath(const std::string& dir, int level, const char* ext) {
+    return dir + "/level-" + std::to_string(level) + ext;
+}
+
+// 无子可走的终局是否获胜（沼泽上的棋子还能“走”时不算终局胜利）
+static bool terminalWin(const std::vector<Board>& floors, const SolveGoal& goal) {
+    for (const auto& b : floors) {
+        if (b.hasMove()) return false;
+    }
+    return goal.isWin(floors);
+}
+
+ExternalBfsReport runExternalBfs(const std::vector<Board>& floors, GameMode mode,
+                                 const ExternalBfsConfig& cfg)
+{
+    ExternalBfsReport report;
+    auto t0 = std::chrono::steady_clock::now();
+
+    PositionCodec     codec(floors);
+    SolveGoal goal  = goalForMode(mode, floors);
+    const int words = codec.words();
+    // 逆向时键后面还要附带父局面编号
+    const int extra = cfg.solvability ? 1 : 0;
+    if (!codec.fits(extra)) {
+        report.error = "too many floors for the position key: " + std::to_string(floors.size()) +
+                       " (at most " + std::to_string(codec.maxFloors(extra)) + ")";
+        return report;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(cfg.dir, ec);
+
+    std::vector<Board> cur;
+    std::vector<Board> child;
+    std::vector<Jump>  jumps;
+
+    // 第 0 层：初始局面
+    {
+        LevelWriter w;
+        if (!w.open(levelPath(cfg.dir, 0, ".bin"), words)) {
+            report.error = "cannot write " + cfg.dir;
+            return report;
+        }
+        w.put(codec.encode(floors));
+        report.bytesWritten += w.bytes();
+        w.close();
+        report.levelCounts.push_back(1);
+    }
+
+    // 正向：第 L 层展开 → 排序成段 → 归并去重成第 L+1 层
+    for (int level = 0; ; ++level) {
+        LevelReader in;
+        if (!in.open(levelPath(cfg.dir, level, ".bin"))) {
+            report.error = "cannot read level " + std::to_string(level);
+            return report;
+        }
+        RunSorter sorter(cfg.dir, words, cfg.memoryBytes);
+        PositionKey key;
+        bool any = false;
+        while (in.next(key)) {
+            codec.decode(key, cur);
+            collectFloorJumps(cur, jumps);
+            for (const auto& j : jumps) {
+                child = cur;
+                MoveResult mv;
+                applyFloorMove(child, j.floor, j.r1, j.c1, j.r2, j.c2, mv);
+                if (goal.isDead && goal.isDead(child, mv)) continue;
+                sorter.add(codec.encode(child));
+                any = true;
+            }
+        }
+        if (in.failed()) {
+            report.error = "level " + std::to_string(level) + " is truncated";
+            return report;
+        }
+        if (!any) break;
+
+        LevelWriter out;
+        if (!out.open(levelPath(cfg.dir, level + 1, ".bin"), words) ||
+            !sorter.finish([&](const PositionKey& k) { out.put(k); }) || sorter.failed()) {
+            report.error = "write failed at level " + std::to_string(level + 1);
+            return report;
+        }
+        report.bytesWritten += out.bytes() + sorter.bytesWritten();
+        report.levelCounts.push_back(out.count());
+        out.close();
+    }
+
+    // 逆向：局面可解 ⇔ 是获胜终局，或有一个后继可解。
+    // 把 (后继键, 父局面编号) 排序后与下一层文件顺序对齐，不需要随机访问。
+    if (cfg.solvability) {
+        const int last = static_cast<int>(report.levelCounts.size()) - 1;
+        report.solvableCounts.assign(report.levelCounts.size(), 0);
+        std::vector<std::uint8_t> nextBits;
+
+        for (int level = last; level >= 0; --level) {
+            std::vector<std::uint8_t> bits((report.levelCounts[level] + 7) / 8, 0);
+            RunSorter pairs(cfg.dir, words + 1, cfg.memoryBytes);
+
+            LevelReader in;
+            if (!in.open(levelPath(cfg.dir, level, ".bin"))) {
+                report.error = "cannot read level " + std::to_string(level);
+                return report;
+            }
+            PositionKey key;
+            std::uint64_t index = 0;
+            for (; in.next(key); ++index) {
+                codec.decode(key, cur);
+                collectFloorJumps(cur, jumps);
+                if (jumps.empty()) {
+                    if (terminalWin(cur, goal)) bits[index >> 3] |= 1u << (index & 7);
+                    continue;
+                }
+                if (level == last) continue;
+                for (const auto& j : jumps) {
+                    child = cur;
+                    MoveResult mv;
+                    applyFloorMove(child, j.floor, j.r1, j.c1, j.r2, j.c2, mv);
+                    if (goal.isDead && goal.isDead(child, mv)) continue;
+                    PositionKey pair = codec.encode(child);
+                    pair.w[words] = index;
+                    pairs.add(pair);
+                }
+            }
+            if (in.failed()) {
+                report.error = "level " + std::to_string(level) + " is truncated";
+                return report;
+            }
+
+            if (level < last) {
+                LevelReader next;
+                if (!next.open(levelPath(cfg.dir, level + 1, ".bin"))) {
+                    report.error = "cannot read level " + std::to_string(level + 1);
+                    return report;
+                }
+                PositionKey nk{};
+                long long rank = -1;
+                bool more = true;
+                bool ok = pairs.finish([&](const PositionKey& p) {
+                    while (more && (rank < 0 || compareKeyWords(nk, p, words) < 0)) {
+                        more = next.next(nk);
+                        ++rank;
+                    }
+                    if (more && compareKeyWords(nk, p, words) == 0 &&
+                        (nextBits[rank >> 3] >> (rank & 7)) & 1) {
+                        std::uint64_t parent = p.w[words];
+                        bits[parent >> 3] |= 1u << (parent & 7);
+                    }
+                });
+                if (!ok || pairs.failed()) {
+                    report.error = "write failed at level " + std::to_string(level);
+                    return report;
+                }
+                if (next.failed()) {
+                    report.error = "level " + std::to_string(level + 1) + " is truncated";
+                    return report;
+                }
+                report.bytesWritten += pairs.bytesWritten();
+            }
+
+            long long solvable = 0;
+            for (long long i = 0; i < report.levelCounts[level]; ++i) {
+                solvable += (bits[i >> 3] >> (i & 7)) & 1;
+            }
+            report.solvableCounts[level] = solvable;
+
+            if (std::FILE* f = std::fopen(levelPath(cfg.dir, level, ".solv").c_str(), "wb")) {
+                std::fwrite(bits.data(), 1, bits.size(), f);
+                std::fclose(f);
+                report.bytesWritten += static_cast<long long>(bits.size());
+            }
+            nextBits.swap(bits);
+        }
+    }
+
+    report.ok      = true;
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return report;
+}
@@ -0,0 +1,28 @@
+#pragma once
+// 外存分层穷举：按“走了几步”（= 少了几颗棋子）一层层枚举所有可达局面
+//
+// 每层边界存成排序好的差分压缩文件，去重靠“内存排序成段 + 多路归并”，
+// 不在内存里放哈希表；读写全是顺序的。局面数超过内存时也能跑完。
+// 正向枚举完再逆向一遍，给每层写出“可解局面”位图（按文件中的排名编号）。
+#include "board.hpp"
+#include <string>
+#include <vector>
+
+struct ExternalBfsConfig {
+    std::string dir         = "bfs_levels";     // 输出目录，不存在时自动创建
+    std::size_t memoryBytes = 64u << 20;        // 排序缓冲区大小
+    bool        solvability = true;             // 是否做逆向可解性标记
+};
+
+struct ExternalBfsReport {
+    bool                   ok = false;
+    std::string            error;
+    std::vector<long long> levelCounts;         // 每层不同局面数（对称归一后）
+    std::vector<long long> solvableCounts;      // 每层可解局面数（solvability 打开时）
+    long long              bytesWritten = 0;    // 写盘总字节数（含临时段文件）
+    double                 seconds      = 0.0;
+};
+
+// 输出文件：<dir>/level-<L>.bin 第 L 层局面；<dir>/level-<L>.solv 可解位图
+ExternalBfsReport runExternalBfs(const std::vector<Board>& floors, GameMode mode,
+                                 const ExternalBfsConfig& cfg);
@@ -0,0 +1,45 @@
+// 多层汇总缓存
+#include "floor_index.hpp"
+
+static FloorSummary summarize(const Board& b) {
+    FloorSummary s;
+    s.pegs      = b.countPegs();
+    s.hasMove   = b.hasMove();
+    s.kingAlive = isKingAlive(b);
+    s.goalPeg   = (s.pegs == 1) && isGoalWin(b);
+    return s;
+}
+
+void FloorIndex::add(const FloorSummary& s, int sign) {
+    pegs_     += sign * s.pegs;
+    movable_  += sign * (s.hasMove ? 1 : 0);
+    kings_    += sign * (s.kingAlive ? 1 : 0);
+    goalPegs_ += sign * (s.goalPeg ? 1 : 0);
+}
+
+void FloorIndex::rebuild(const std::vector<Board>& floors) {
+    floors_.resize(floors.size());
+    isDirty_.assign(floors.size(), 0);
+    dirty_.clear();
+    pegs_ = movable_ = kings_ = goalPegs_ = 0;
+    for (std::size_t i = 0; i < floors.size(); ++i) {
+        floors_[i] = summarize(floors[i]);
+        add(floors_[i], 1);
+    }
+}
+
+void FloorIndex::markDirty(int floor) {
+    if (floor < 0 || floor >= static_cast<int>(floors_.size()) || isDirty_[floor]) return;
+    isDirty_[floor] = 1;
+    dirty_.push_back(floor);
+}
+
+void FloorIndex::refresh(const std::vector<Board>& floors) {
+    for (int f : dirty_) {
+        add(floors_[f], -1);
+        floors_[f] = summarize(floors[f]);
+        add(floors_[f], 1);
+        isDirty_[f] = 0;
+    }
+    dirty_.clear();
+}
@@ -0,0 +1,43 @@
+#pragma once
+// 多层汇总缓存：每层记棋子数、是否有可行步、国王是否存活、是否“剩一颗且在 Goal 上”，
+// 全局再记这几项的合计。走子只把碰到的层（起跳层、传送目标层）标脏，
+// 下次 refresh 只重算脏层并增量修正合计，层数再多每步的开销也不变。
+// 开局、读档、撤销整体换了棋盘，用 rebuild 全部重算。
+#include "board.hpp"
+#include <cstdint>
+#include <vector>
+
+struct FloorSummary {
+    int  pegs      = 0;
+    bool hasMove   = false;
+    bool kingAlive = false;
+    bool goalPeg   = false;     // 本层只剩一颗且在 Goal 上
+};
+
+class FloorIndex {
+public:
+    void rebuild(const std::vector<Board>& floors);
+    void markDirty(int floor);                      // 重复标记只算一次
+    void refresh(const std::vector<Board>& floors); // 只重算脏层
+
+    // 以下读的都是合计，O(1)；调用前要先 refresh
+    int  totalPegs()    const { return pegs_; }
+    bool anyMove()      const { return movable_ > 0; }
+    bool anyKingAlive() const { return kings_ > 0; }
+    bool goalWin()      const { return pegs_ == 1 && goalPegs_ > 0; }
+    bool dirty()        const { return !dirty_.empty(); }
+
+    const FloorSummary& floor(int i) const { return floors_[i]; }
+    int floorCount() const { return static_cast<int>(floors_.size()); }
+
+private:
+    void add(const FloorSummary& s, int sign);
+
+    std::vector<FloorSummary> floors_;
+    std::vector<int>          dirty_;       // 待重算的层
+    std::vector<std::uint8_t> isDirty_;     // 按层去重
+    int pegs_     = 0;
+    int movable_  = 0;      // 有可行步的层数
+    int kings_    = 0;      // 国王存活的层数
+    int goalPegs_ = 0;
+};
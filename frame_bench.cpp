@@ -0,0 +1,208 @@
+// 端到端帧基准
+#include "frame_bench.hpp"
+#include "alloc_counter.hpp"
+#include <algorithm>
+#include <chrono>
+#include <ostream>
+
+// ===== 脚本化玩家 =====
+//
+// 每个动作只发一个事件：换层（Q/E）、点起点、点终点，每走 7 步撤销一次。
+// 选步时一半概率优先挑落点在冰格 / 传送格上的跳跃，保证这些分支都被走到。
+
+struct ScriptStats {
+    long long moves     = 0;
+    long long undos     = 0;
+    long long floors    = 0;
+    long long ice       = 0;
+    long long teleports = 0;
+    long long games     = 0;
+};
+
+class ScriptedPlayer {
+public:
+    explicit ScriptedPlayer(std::uint64_t seed) : rng_(seed) {}
+
+    void act(const GameRuntime& rt, LogicThread& logic, ScriptStats& stats) {
+        if (pending_) {
+            pending_ = false;
+            logic.post(click(rt, target_.r2, target_.c2));
+            stats.moves++;
+            sinceUndo_++;
+            CellType landing = rt.floors[target_.floor].typeAt(target_.r2, target_.c2);
+            if (landing == CellType::Ice)      stats.ice++;
+            if (landing == CellType::Teleport) stats.teleports++;
+            return;
+        }
+        if (sinceUndo_ >= 7) {
+            sinceUndo_ = 0;
+            logic.post(key(sf::Keyboard::Z));
+            stats.undos++;
+            return;
+        }
+
+        collectFloorJumps(rt.floors, jumps_);
+        if (jumps_.empty()) return;     // 等结算
+
+        special_.clear();
+        for (const auto& j : jumps_) {
+            CellType t = rt.floors[j.floor].typeAt(j.r2, j.c2);
+            if (t == CellType::Ice || t == CellType::Teleport) special_.push_back(j);
+        }
+        const std::vector<Jump>& pool =
+            (!special_.empty() && rng_.range(0, 1) == 0) ? special_ : jumps_;
+        Jump j = pool[rng_.range(0, pool.size() - 1)];
+
+        // 不在这一层：先换层，下个动作再重新挑
+        if (j.floor != rt.currentFloor) {
+            logic.post(key(j.floor < rt.currentFloor ? sf::Keyboard::Q : sf::Keyboard::E));
+            stats.floors++;
+            return;
+        }
+        logic.post(click(rt, j.r1, j.c1));
+        target_  = j;
+        pending_ = true;
+    }
+
+    void reset() {
+        pending_   = false;
+        sinceUndo_ = 0;
+    }
+
+private:
+    static sf::Event click(const GameRuntime& rt, int r, int c) {
+        sf::Event e;
+        e.type = sf::Event::MouseButtonPressed;
+        e.mouseButton.button = sf::Mouse::Left;
+        e.mouseButton.x = static_cast<int>(rt.view.toScreenX((c + 0.5f) * rt.cellSize));
+        e.mouseButton.y = static_cast<int>(rt.view.toScreenY((r + 0.5f) * rt.cellSize));
+        return e;
+    }
+
+    static sf::Event key(sf::Keyboard::Key code) {
+        sf::Event e;
+        e.type = sf::Event::KeyPressed;
+        e.key = {};
+        e.key.code = code;
+        return e;
+    }
+
+    BoardRng          rng_;
+    std::vector<Jump> jumps_;       // 成员复用，热身后不再分配
+    std::vector<Jump> special_;
+    Jump              target_;
+    bool              pending_   = false;
+    int               sinceUndo_ = 0;
+};
+
+// ===== 计时 =====
+
+struct PhaseStats {
+    double total = 0.0;
+    double max   = 0.0;
+
+    void add(double s) {
+        total += s;
+        max = std::max(max, s);
+    }
+};
+
+static void printPhase(std::ostream& out, const char* name, const PhaseStats& st, int frames) {
+    out << "phase " << name
+        << " mean=" << (frames > 0 ? st.total / frames * 1e6 : 0.0) << "us"
+        << " max="  << st.max * 1e6 << "us\n";
+}
+
+// ===== 入口 =====
+
+bool runFrameBenchmark(const FrameBenchConfig& cfg, FrameDrawFn draw, std::ostream& out) {
+    using Clock = std::chrono::steady_clock;
+
+    GameState   gameState = GameState::Playing;
+    GameRuntime rt(gameState);
+    // 三层大十字 + 冰格：传送格只在多层时出现，十字盘上的传送格又只能从中心跳到，走不到
+    GameConfig gc = makeConfig(1, 3, 2, true, false, false);
+    gc.seed = cfg.seed;
+    initGame(rt, gc);
+
+    sf::RenderTexture texture;
+    if (!texture.create(static_cast<unsigned int>(Board::Cols * rt.cellSize),
+                        static_cast<unsigned int>(Board::Rows * rt.cellSize))) {
+        out << "err cannot create offscreen render texture (no OpenGL context?)\n";
+        return false;
+    }
+
+    LogicThread    logic(rt, gameState);
+    ScriptedPlayer player(cfg.seed);
+    ScriptStats    script;
+    logic.publishNow();
+
+    PhaseStats input, update, snapshot, render, frame;
+    std::uint64_t allocStart = 0, bytesStart = 0;
+    Clock::time_point start;
+
+    int total = cfg.warmup + cfg.frames;
+    for (int f = 0; f < total; ++f) {
+        if (f == cfg.warmup) {
+            allocStart = allocationCount();
+            bytesStart = allocationBytes();
+            start      = Clock::now();
+            script     = ScriptStats();
+        }
+        auto t0 = Clock::now();
+
+        if (f % cfg.actionEvery == 0) player.act(rt, logic, script);
+
+        LogicThread::StepTiming timing;
+        bool win = false;
+        if (logic.step(cfg.dt, win, &timing)) {
+            // 本局结束：按同一配置重开，脚本接着跑
+            script.games++;
+            restartGame(rt);
+            player.reset();
+            logic.publishNow();
+        }
+
+        auto t1 = Clock::now();
+        const FrameSnapshot& snap = logic.latest();
+        draw(texture, snap);
+        texture.display();
+        auto t2 = Clock::now();
+
+        if (f >= cfg.warmup) {
+            input.add(timing.input);
+            update.add(timing.update);
+            snapshot.add(timing.snapshot);
+            render.add(std::chrono::duration<double>(t2 - t1).count());
+            frame.add(std::chrono::duration<double>(t2 - t0).count());
+        }
+    }
+
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    std::uint64_t allocs = allocationCount() - allocStart;
+    std::uint64_t bytes  = allocationBytes() - bytesStart;
+
+    out << "bench frames=" << cfg.frames
+        << " dt=" << cfg.dt
+        << " fps=" << (elapsed > 0 ? cfg.frames / elapsed : 0.0)
+        << " seconds=" << elapsed << "\n";
+    printPhase(out, "input",    input,    cfg.frames);
+    printPhase(out, "update",   update,   cfg.frames);
+    printPhase(out, "snapshot", snapshot, cfg.frames);
+    printPhase(out, "draw",     render,   cfg.frames);
+    printPhase(out, "frame",    frame,    cfg.frames);
+    if (AllocCounterEnabled) {
+        out << "alloc count=" << allocs
+            << " per_frame=" << (cfg.frames > 0 ? static_cast<double>(allocs) / cfg.frames : 0.0)
+            << " bytes=" << bytes << "\n";
+    } else {
+        out << "alloc count=n/a (build with -DPEG_ALLOC_COUNTER)\n";
+    }
+    out << "script moves=" << script.moves
+        << " ice=" << script.ice
+        << " teleport=" << script.teleports
+        << " undo=" << script.undos
+        << " floor=" << script.floors
+        << " games=" << script.games << "\n";
+    return true;
+}
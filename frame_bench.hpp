@@ -0,0 +1,23 @@
+#pragma once
+// 端到端帧基准：真实的逻辑帧（LogicThread::step）+ 真实的 drawGame，画进离屏纹理
+//
+// 固定步长推进，脚本化玩家按固定节奏选子、落子、撤销、换层，优先走会触发冰滑和传送的步；
+// 种子固定，每次运行的输入序列完全相同。输出帧率、各阶段耗时和堆分配次数。
+#include "logic_thread.hpp"
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <iosfwd>
+
+struct FrameBenchConfig {
+    int           frames      = 3000;
+    int           warmup      = 60;             // 前若干帧不计入统计（填满各处的容量）
+    float         dt          = 1.f / 60.f;     // 固定步长
+    int           actionEvery = 4;              // 每隔几帧出一个输入动作
+    std::uint64_t seed        = 20240601;       // 开局和脚本共用
+};
+
+// drawGame 定义在 main.cpp，由调用方传进来
+using FrameDrawFn = void (*)(sf::RenderTarget&, const FrameSnapshot&);
+
+// 离屏纹理创建失败（没有 OpenGL 上下文）时返回 false
+bool runFrameBenchmark(const FrameBenchConfig& cfg, FrameDrawFn draw, std::ostream& out);
@@ -0,0 +1,596 @@
+// 游戏运行时逻辑：规则判断、初始化、输入处理、动画计时
+#include "game.hpp"
+#include "map_file.hpp"
+#include "opening_book.hpp"
+#include "puzzle_gen.hpp"
+#include "save_game.hpp"
+#include "solver.hpp"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+// ===== 一些规则判断辅助函数 =====
+
+// 多层：当前棋盘 & 历史
+Board& currentBoard(GameRuntime& rt) {
+    return rt.floors[rt.currentFloor];
+}
+const Board& currentBoard(const GameRuntime& rt) {
+    return rt.floors[rt.currentFloor];
+}
+
+// 多层：总棋子数
+int totalPegs(const GameRuntime& rt) {
+    return rt.floorIndex.totalPegs();
+}
+
+// 多层：是否还有任意可行步
+bool anyMove(const GameRuntime& rt) {
+    return rt.floorIndex.anyMove();
+}
+
+// 多层：目标格胜利（全局只有一个棋子且在某个 Goal 上）
+bool globalGoalWin(const GameRuntime& rt) {
+    return rt.floorIndex.goalWin();
+}
+
+// 多层：是否存在至少一个活着的国王
+bool anyKingAlive(const GameRuntime& rt) {
+    return rt.floorIndex.anyKingAlive();
+}
+
+void syncFloors(GameRuntime& rt) {
+    rt.floorIndex.refresh(rt.floors);
+}
+
+LayerMode layerModeFor(int layers) {
+    switch (layers) {
+    case 1:  return LayerMode::Single;
+    case 2:  return LayerMode::Double;
+    case 3:  return LayerMode::Triple;
+    default: return LayerMode::Multi;
+    }
+}
+
+// ===== 用配置初始化整局游戏（多层） =====
+
+GameConfig makeConfig(int mode, int layers, int shape,
+                      bool useIce, bool useSwamp, bool useBarrier)
+{
+    GameConfig cfg;
+    switch (mode) {
+    case 2:  cfg.winMode = GameMode::Lattice; break;
+    case 3:  cfg.winMode = GameMode::Chess;   break;
+    default: cfg.winMode = GameMode::Classic; break;
+    }
+    switch (shape) {
+    case 2:  cfg.mapShape = MapShape::BigCross; break;
+    case 3:  cfg.mapShape = MapShape::Triangle; break;
+    case 4:  cfg.mapShape = MapShape::Diamond;  break;
+    default: cfg.mapShape = MapShape::Cross;    break;
+    }
+    cfg.layers     = (layers < 1) ? 1 : (layers > MaxLayers ? MaxLayers : layers);
+    cfg.useIce     = useIce;
+    cfg.useSwamp   = useSwamp;
+    cfg.useBarrier = useBarrier;
+    return cfg;
+}
+
+// 每局随机种子：random_device 每次新建，不共享状态；保证非 0
+static std::uint64_t randomSeed() {
+    std::random_device rd;
+    std::uint64_t s = (static_cast<std::uint64_t>(rd()) << 32) ^ rd();
+    return s ? s : 1;
+}
+
+void initGame(GameRuntime& rt, const GameConfig& cfg) {
+    rt.config   = cfg;
+    rt.gameMode = cfg.winMode;
+
+    rt.layerMode = layerModeFor(cfg.layers);
+
+    SpecialConfig sc;
+    sc.useIce     = cfg.useIce;
+    sc.useSwamp   = cfg.useSwamp;
+    sc.useBarrier = cfg.useBarrier;
+    sc.extraHoles = (cfg.layers > 1);
+
+    rt.floors.clear();
+
+    // 自定义地图：能放进棋盘的小地图直接替换生成的形状
+    MapFile customMap;
+    if (!cfg.mapPath.empty() && (!customMap.open(cfg.mapPath) || !customMap.fitsBoard())) {
+        customMap.close();
+    }
+
+    // 各层种子由本局种子派生，整局只需记一个数
+    rt.seed = cfg.seed ? cfg.seed : randomSeed();
+    BoardRng floorSeeds(rt.seed);
+    for (int i = 0; i < cfg.layers; ++i) {
+        Board b(cfg.winMode, cfg.mapShape, sc, floorSeeds.next());
+        if (customMap.isOpen()) customMap.loadInto(b);
+        rt.floors.push_back(b);
+    }
+    // 反向生成的题目：只用于单层，自定义地图优先
+    if (cfg.puzzlePegs > 0 && cfg.layers == 1 && !customMap.isOpen()) {
+        PuzzleConfig pc;
+        pc.mode       = cfg.winMode;
+        pc.shape      = cfg.mapShape;
+        pc.special    = sc;
+        pc.targetPegs = cfg.puzzlePegs;
+        Puzzle puzzle;
+        generatePuzzle(pc, rt.floors[0].seed(), puzzle);
+        rt.floors[0] = puzzle.board;
+    }
+    applyTeleportTiles(rt);
+    rt.floorIndex.rebuild(rt.floors);
+
+    rt.history.resetFrom(rt.floors);
+    rt.historyIds.clear();
+    rt.chainHistory.clear();
+    rt.touchHistory.clear();
+    rt.chain = MoveChain();
+    pushHistory(rt);
+
+    rt.currentFloor = 0;
+
+    rt.selection   = false;
+    rt.selectedRow = -1;
+    rt.selectedCol = -1;
+    rt.possibleTargets = 0;
+
+    rt.moveCount = 0;
+    rt.pegCount  = totalPegs(rt);
+
+    rt.tweens.clear();
+
+    rt.isGameOver = false;
+    if (rt.telemetry) rt.lastActionMs = rt.telemetry->nowMs();
+}
+
+// ===== 撤销栈 =====
+
+void pushHistory(GameRuntime& rt) {
+    PositionArena::Index id;
+    const HistoryTouch* last = rt.touchHistory.empty() ? nullptr : &rt.touchHistory.back();
+    if (last && last->from >= 0) {
+        // 与上一个快照只差上一步碰到的层
+        int changed[2] = {last->from, last->to != last->from ? last->to : -1};
+        id = rt.history.appendFrom(rt.historyIds.back(), rt.floors, changed, 2);
+    } else {
+        id = rt.history.append(rt.floors);
+    }
+    rt.historyIds.push_back(id);
+    rt.chainHistory.push_back(rt.chain);
+    rt.touchHistory.push_back(HistoryTouch());
+}
+
+bool popHistory(GameRuntime& rt) {
+    // 第一个快照是开局状态，始终保留
+    if (rt.historyIds.size() <= 1) return false;
+    PositionArena::Index id = rt.historyIds.back();
+    HistoryTouch touch = rt.touchHistory.back();
+    if (touch.from >= 0) {
+        rt.history.loadFloor(id, touch.from, rt.floors[touch.from]);
+        rt.floorIndex.markDirty(touch.from);
+        if (touch.to != touch.from) {
+            rt.history.loadFloor(id, touch.to, rt.floors[touch.to]);
+            rt.floorIndex.markDirty(touch.to);
+        }
+        syncFloors(rt);
+    } else {
+        rt.history.load(id, rt.floors);
+        rt.floorIndex.rebuild(rt.floors);
+    }
+    rt.history.release(id);     // 后进先出：编号和内存都原地复用
+    rt.historyIds.pop_back();
+    rt.chain = rt.chainHistory.back();
+    rt.chainHistory.pop_back();
+    rt.touchHistory.pop_back();
+    return true;
+}
+// 没有自定义传送时的固定传送点
+const std::vector<std::pair<int,int>> TELEPORT_POINTS = {
+    {1,3},{3,1},{3,5},{5,3}
+};
+
+// 把一格设为传送格（目标格、国王格不动），上面的棋子拿掉
+static void placeTeleportTile(Board& b, int r, int c) {
+    if (!b.inBounds(r, c)) return;
+    CellType t = b.typeAt(r, c);
+    if (t == CellType::Goal || t == CellType::King) return;
+    b.setType(r, c, CellType::Teleport);
+    if (b.at(r, c) == CellState::Peg) {
+        b.set(r, c, CellState::Empty);
+    }
+}
+
+void applyTeleportTiles(GameRuntime& rt) {
+    if (rt.config.layers > 1) {
+        if (rt.config.teleports.empty()) {
+            for (auto pos: TELEPORT_POINTS) {
+                for (auto& b: rt.floors) {
+                    placeTeleportTile(b, pos.first, pos.second);
+                }
+            }
+        } else {
+            int n = static_cast<int>(rt.floors.size());
+            for (const TeleportLink& l : rt.config.teleports) {
+                if (l.floor < 0 || l.floor >= n) continue;
+                placeTeleportTile(rt.floors[l.floor], l.row, l.col);
+            }
+        }
+    }
+    buildTeleportLinks(rt);
+}
+
+void buildTeleportLinks(GameRuntime& rt) {
+    if (rt.config.teleports.empty()) {
+        // 默认链接与求解器不带链接表时的规则相同，也包括地图文件里的传送格
+        defaultTeleportLinks(rt.floors, rt.links);
+        return;
+    }
+    rt.links.reset(static_cast<int>(rt.floors.size()));
+    for (const TeleportLink& l : rt.config.teleports) {
+        if (l.floor < 0 || l.floor >= static_cast<int>(rt.floors.size())) continue;
+        // 起点没能变成传送格（目标格、国王格、棋盘外）的链接不生效
+        const Board& b = rt.floors[l.floor];
+        if (!b.inBounds(l.row, l.col) || b.typeAt(l.row, l.col) != CellType::Teleport) continue;
+        rt.links.add(l);
+    }
+}
+
+// 提示求解在逻辑线程上跑，每次按 H 新建 Solver：节点上限 100 万，
+// 置换表按这个规模给 4 MB（约 20 万个死局，挤出的进布隆过滤器），不用默认的 64 MB，免得每次分配清零卡帧
+static const long long   HINT_NODE_LIMIT  = 1000000;
+static const std::size_t HINT_TABLE_BYTES = 4u << 20;
+
+// 提示用的持久求解缓存，第一次按 H 时打开；打不开就不用缓存
+static SolveCache& hintCache() {
+    static SolveCache cache;
+    static bool tried = false;
+    if (!tried) {
+        tried = true;
+        cache.open("solvecache.bin");
+    }
+    return cache;
+}
+
+// 开局库（--build-book 生成），同样第一次按 H 时打开；没有这个文件就只用求解器
+static const OpeningBook& hintBook() {
+    static OpeningBook book;
+    static bool tried = false;
+    if (!tried) {
+        tried = true;
+        book.open("openingbook.bin");
+    }
+    return book;
+}
+
+// ===== 遥测 =====
+
+// 只拷一条定长记录进环形缓冲，不做 IO；缓冲满时由 TelemetryLog 计入丢弃数
+static void recordTelemetry(GameRuntime& rt, TelemetryKind kind, int floor,
+                            int fromRow = -1, int fromCol = -1,
+                            int toRow = -1, int toCol = -1,
+                            std::uint8_t flags = 0, int toFloor = -1)
+{
+    if (!rt.telemetry) return;
+    auto cell = [](int r, int c) -> std::uint8_t {
+        return (r < 0 || c < 0) ? 0xFF : static_cast<std::uint8_t>(r * Board::Cols + c);
+    };
+
+    TelemetryEvent e;
+    e.timeMs  = rt.telemetry->nowMs();
+    e.thinkMs = e.timeMs - rt.lastActionMs;
+    e.session = rt.telemetrySession;
+    e.kind    = static_cast<std::uint8_t>(kind);
+    e.flags   = flags;
+    e.floor   = static_cast<std::uint8_t>(floor);
+    e.from    = cell(fromRow, fromCol);
+    e.toFloor = static_cast<std::uint8_t>(toFloor < 0 ? floor : toFloor);
+    e.to      = cell(toRow, toCol);
+    e.pegs    = static_cast<std::uint16_t>(std::min(totalPegs(rt), 0xFFFF));
+    rt.telemetry->record(e);
+    rt.lastActionMs = e.timeMs;
+}
+
+// 只打包进内存缓冲，写盘在 AutoSave 的后台线程
+static void requestAutosave(GameRuntime& rt) {
+    if (rt.autosave) rt.autosave->request(rt);
+}
+
+void restartGame(GameRuntime& rt) {
+    recordTelemetry(rt, TelemetryKind::Restart, rt.currentFloor);
+    initGame(rt, rt.config);
+    requestAutosave(rt);
+}
+
+// ===== 游戏中处理点击 / 按键 =====
+
+void handlePlaying(const sf::Event& event,
+                   GameState& gameState,
+                   GameRuntime& rt)
+{
+    // 已结束：不接受操作。动画中照常接受，走子立即生效，画面随后追上
+    if (rt.isGameOver) {
+        return;
+    }
+
+    Board& board = currentBoard(rt);
+
+
+    // 视口：滚轮缩放，方向键平移，V 复位
+    if (event.type == sf::Event::MouseWheelScrolled) {
+        rt.view.zoomAt(event.mouseWheelScroll.delta > 0 ? 1.25f : 0.8f,
+                       static_cast<float>(event.mouseWheelScroll.x),
+                       static_cast<float>(event.mouseWheelScroll.y));
+        return;
+    }
+    if (event.type == sf::Event::KeyPressed) {
+        float step = rt.cellSize * 0.5f;
+        switch (event.key.code) {
+        case sf::Keyboard::Left:  rt.view.pan(-step, 0.f); return;
+        case sf::Keyboard::Right: rt.view.pan( step, 0.f); return;
+        case sf::Keyboard::Up:    rt.view.pan(0.f, -step); return;
+        case sf::Keyboard::Down:  rt.view.pan(0.f,  step); return;
+        case sf::Keyboard::V:     rt.view.reset();         return;
+        default: break;
+        }
+    }
+
+    // ESC：退出（这里先简单设为结束）
+    if (event.type == sf::Event::KeyPressed &&
+        event.key.code == sf::Keyboard::Escape) {
+        rt.selection = false;
+        rt.possibleTargets = 0;
+        gameState = GameState::Over;
+        recordTelemetry(rt, TelemetryKind::Quit, rt.currentFloor);
+        return;
+    }
+
+    // Q/E：切换楼层
+    if (event.type == sf::Event::KeyPressed) {
+        if (event.key.code == sf::Keyboard::Q) {
+            if (rt.currentFloor > 0) {
+                rt.currentFloor--;
+                rt.selection = false;
+                rt.possibleTargets = 0;
+                recordTelemetry(rt, TelemetryKind::Floor, rt.currentFloor);
+            }
+            return;
+        }
+        if (event.key.code == sf::Keyboard::E) {
+            if (rt.currentFloor + 1 < static_cast<int>(rt.floors.size())) {
+                rt.currentFloor++;
+                rt.selection = false;
+                rt.possibleTargets = 0;
+                recordTelemetry(rt, TelemetryKind::Floor, rt.currentFloor);
+            }
+            return;
+        }
+    }
+
+    // 撤销（Z）——当前楼层
+    if (event.type == sf::Event::KeyPressed &&
+        event.key.code == sf::Keyboard::Z) {
+        if (popHistory(rt)) {
+            rt.pegCount = totalPegs(rt);
+            recordTelemetry(rt, TelemetryKind::Undo, rt.currentFloor);
+            requestAutosave(rt);
+        }
+        rt.tweens.clear();      // 棋盘已回退，未播完的动画不再对应
+        rt.selection = false;
+        rt.possibleTargets = 0;
+        return;
+    }
+
+    // 提示（H）：按当前模式求解，选中第一步要走的棋子
+    if (event.type == sf::Event::KeyPressed &&
+        event.key.code == sf::Keyboard::H) {
+        // 标准开局的前几步直接查开局库，不用等求解器
+        Jump    j;
+        bool    found = false;
+        BookHit hit;
+        if (hintBook().lookup(rt.gameMode, rt.floors, hit) && hit.solvable && hit.moveCount > 0) {
+            j     = hit.moves[0];
+            found = true;
+        } else {
+            SolveGoal goal = goalForMode(rt.gameMode, rt.floors);
+            // 自定义链接会换坐标传送，三色不变量不再成立；持久缓存的键也不含链接
+            bool customLinks = !rt.config.teleports.empty();
+            if (customLinks && rt.gameMode == GameMode::Lattice) goal.isDead = nullptr;
+            Solver solver(goal, HINT_NODE_LIMIT, HINT_TABLE_BYTES);
+            if (!customLinks) solver.setCache(&hintCache());
+            solver.setTeleportLinks(&rt.links);
+            SolveResult res = solver.solve(rt.floors);
+            if (res.solved && !res.line.empty()) {
+                j     = res.line.front();
+                found = true;
+            }
+        }
+
+        rt.selection = false;
+        rt.possibleTargets = 0;
+        if (found) {
+            rt.currentFloor = j.floor;
+            rt.selection    = true;
+            rt.selectedRow  = j.r1;
+            rt.selectedCol  = j.c1;
+            rt.possibleTargets = cellBit(j.r2, j.c2);
+            recordTelemetry(rt, TelemetryKind::Hint, j.floor, j.r1, j.c1, j.r2, j.c2);
+        }
+        return;
+    }
+
+    // 重开（R）——整局重新根据配置生成
+    if (event.type == sf::Event::KeyPressed &&
+        event.key.code == sf::Keyboard::R) {
+        restartGame(rt);
+        return;
+    }
+
+    // 鼠标左键：选子 / 走子
+    if (event.type == sf::Event::MouseButtonPressed &&
+        event.mouseButton.button == sf::Mouse::Left)
+    {
+        int mx = event.mouseButton.x;
+        int my = event.mouseButton.y;
+
+        int row, col;
+        rt.view.toCell(static_cast<float>(mx), static_cast<float>(my), rt.cellSize, row, col);
+
+        if (!board.inBounds(row, col)) {
+            rt.selection = false;
+            rt.possibleTargets = 0;
+            return;
+        }
+
+        // 未选中棋子：尝试选择
+        if (!rt.selection) {
+            std::uint64_t targets = board.targetMask(row, col);
+            if (targets != 0 &&
+                board.typeAt(row,col) != CellType::Swamp) {
+                rt.selection   = true;
+                rt.selectedRow = row;
+                rt.selectedCol = col;
+                rt.possibleTargets = targets;
+                recordTelemetry(rt, TelemetryKind::Select, rt.currentFloor, row, col);
+            } else {
+                rt.selection = false;
+                rt.possibleTargets = 0;
+            }
+            return;
+        }
+        // 已选中棋子：尝试跳跃
+        else {
+            int fr = rt.selectedRow;
+            int fc = rt.selectedCol;
+
+            if (board.canJump(fr, fc, row, col)) {
+                // 加入历史栈
+                pushHistory(rt);
+
+                int jumpRow  = row;
+                int jumpCol  = col;
+
+                // 真正执行跳跃（含冰滑、传送）
+                MoveResult mv;
+                applyFloorMove(rt.floors, rt.currentFloor,
+                               fr, fc, jumpRow, jumpCol, mv, &rt.links);
+
+                int fromFloor = rt.currentFloor;
+                if (mv.teleport) {
+                    rt.currentFloor = mv.floor;
+                }
+                // 只有起跳层和传送目标层变了
+                rt.touchHistory.back() = HistoryTouch{fromFloor, mv.floor};
+                rt.floorIndex.markDirty(fromFloor);
+                rt.floorIndex.markDirty(mv.floor);
+                syncFloors(rt);
+                rt.moveCount++;
+                rt.pegCount = totalPegs(rt);
+
+                // 从上一跳的落点起跳 = 同一颗棋子连跳，不算新的一步
+                if (rt.chain.floor != fromFloor || rt.chain.row != fr || rt.chain.col != fc) {
+                    rt.chain.moves++;
+                }
+                rt.chain.floor = mv.floor;
+                rt.chain.row   = mv.row;
+                rt.chain.col   = mv.col;
+
+                std::uint8_t flags = 0;
+                if (mv.iceSlide)     flags |= TELEMETRY_ICE;
+                if (mv.teleport)     flags |= TELEMETRY_TELEPORT;
+                if (mv.kingCaptured) flags |= TELEMETRY_KING;
+                recordTelemetry(rt, TelemetryKind::Move, fromFloor, fr, fc, mv.row, mv.col, flags, mv.floor);
+                requestAutosave(rt);
+
+                // 补间：跳跃，之后冰滑；传送特效与跳跃同时开始
+                rt.tweens.beginGroup(mv.floor);
+                Tween jump;
+                jump.kind     = TweenKind::Jump;
+                jump.fromRow  = fr;
+                jump.fromCol  = fc;
+                jump.toRow    = jumpRow;
+                jump.toCol    = jumpCol;
+                jump.duration = rt.animDuration;
+                rt.tweens.add(jump);
+
+                if (mv.iceSlide) {
+                    Tween slide;
+                    slide.kind     = TweenKind::Slide;
+                    slide.fromRow  = jumpRow;
+                    slide.fromCol  = jumpCol;
+                    slide.toRow    = mv.landRow;
+                    slide.toCol    = mv.landCol;
+                    slide.delay    = rt.animDuration;
+                    slide.duration = rt.iceDuration;
+                    rt.tweens.add(slide);
+                }
+                if (mv.teleport) {
+                    Tween tp;
+                    tp.kind     = TweenKind::Teleport;
+                    tp.toRow    = mv.row;
+                    tp.toCol    = mv.col;
+                    tp.duration = rt.teleportDuration;
+                    rt.tweens.add(tp);
+                }
+
+                // 清除高亮
+                rt.selection = false;
+                rt.possibleTargets = 0;
+            } else {
+                // 点击非法落点 → 取消选中
+                rt.selection = false;
+                rt.possibleTargets = 0;
+            }
+
+            return;
+        }
+    }
+}
+
+// ===== 动画计时 =====
+
+void updateAnimations(GameRuntime& rt, float dt) {
+    rt.tweens.update(dt);
+}
+
+// ===== 结算检查 =====
+
+bool checkGameOver(GameRuntime& rt, bool& win) {
+    win = false;
+    if (rt.isGameOver) return false;
+
+    syncFloors(rt);
+    rt.pegCount = totalPegs(rt);
+
+    // Chess 模式：如果国王全灭，立即失败
+    if (rt.gameMode == GameMode::Chess && !anyKingAlive(rt)) {
+        rt.isGameOver = true;
+        recordTelemetry(rt, TelemetryKind::GameOver, rt.currentFloor);
+        return true;
+    }
+
+    // 没有任何可行步：根据模式判断胜负
+    if (!anyMove(rt)) {
+        rt.isGameOver = true;
+
+        switch (rt.gameMode) {
+        case GameMode::Classic:
+            win = (rt.pegCount == 1);
+            break;
+        case GameMode::Lattice:
+            win = globalGoalWin(rt);
+            break;
+        case GameMode::Chess:
+            win = anyKingAlive(rt);
+            break;
+        }
+        recordTelemetry(rt, TelemetryKind::GameOver, rt.currentFloor,
+                        -1, -1, -1, -1, win ? TELEMETRY_WIN : 0);
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,152 @@
+#pragma once
+// 游戏运行时：多层棋盘、选择、动画、撤销。与渲染无关，可无窗口运行
+#include "board.hpp"
+#include "floor_index.hpp"
+#include "position_arena.hpp"
+#include "telemetry.hpp"
+#include "tween.hpp"
+#include "viewport.hpp"
+#include <string>
+#include <SFML/Window/Event.hpp>
+#include <vector>
+#include <utility>
+
+class AutoSave;
+
+// 游戏状态
+enum class GameState {
+    Over,
+    Playing
+};
+
+// 多层模式
+enum class LayerMode {
+    Single,
+    Double,
+    Triple,
+    Multi       // 4 层及以上
+};
+
+// 层数上限（GameConfig::layers）
+constexpr int MaxLayers = 64;
+
+// 一局游戏配置：层数 + 特殊格 + 规则 + 地图形状
+struct GameConfig {
+    int      layers     = 1;
+    bool     useIce     = false;
+    bool     useSwamp   = false;
+    bool     useBarrier = false;
+    GameMode winMode    = GameMode::Classic;
+    MapShape mapShape   = MapShape::Cross;
+    std::string mapPath;                // 自定义地图（二进制 .pmb），为空时按 mapShape 生成
+    std::uint64_t seed  = 0;            // 0 表示每局随机；非 0 时同一配置同一种子得到同一开局
+    int      puzzlePegs = 0;            // >0：单层开局由终局反跳生成，保证有解（见 puzzle_gen）
+    // 自定义传送：起点格设为传送格并按这里连接；为空时用固定的四个传送点，各连到下一层同坐标
+    std::vector<TeleportLink> teleports;
+};
+
+// 经典计步：同一颗棋子连续跳跃只算一步
+struct MoveChain {
+    int moves = 0;      // 到目前为止的步数
+    int floor = -1;     // 上一跳的落点；下一跳从这里起跳时接着算同一步
+    int row   = -1;
+    int col   = -1;
+};
+
+// 撤销快照之后那一步碰到的楼层（起跳层、传送目标层）：撤销只还原这两层，
+// 下一个快照只重新打包这两层。from < 0 表示不知道（读档得到的快照），按整局处理
+struct HistoryTouch {
+    int from = -1;
+    int to   = -1;
+};
+
+struct GameRuntime {
+    // 多层棋盘
+    std::vector<Board>                floors;
+    PositionArena                     history{64};   // 撤销快照：只存棋子掩码，格子布局共用
+    std::vector<PositionArena::Index> historyIds;    // 撤销栈，historyIds[0] 是开局
+    std::vector<MoveChain>            chainHistory;  // 与 historyIds 一一对应，撤销时恢复计步
+    std::vector<HistoryTouch>         touchHistory;  // 与 historyIds 一一对应
+    int                               currentFloor = 0;
+    TeleportLinks                     links;         // 传送链接（开局 / 读档时按配置生成）
+    FloorIndex                        floorIndex;    // 每层汇总缓存，走子只重算碰到的层
+
+    // 选择状态
+    bool selection   = false;
+    int  selectedRow = -1;
+    int  selectedCol = -1;
+    std::uint64_t possibleTargets = 0;  // 合法落点位掩码（cellBit），选子不分配内存
+
+    float     cellSize  = 64.f;
+    Viewport  view;                     // 缩放 / 平移（滚轮、方向键，V 复位）
+    int       moveCount = 0;            // 跳跃次数（撤销不减）
+    MoveChain chain;                    // 当前局面的经典步数（撤销时回退）
+    int       pegCount  = 0;
+    std::uint64_t seed  = 0;            // 本局实际用的种子（随机开局也记下来，用于复现）
+    LayerMode layerMode = LayerMode::Single;
+    GameMode  gameMode  = GameMode::Classic;
+    GameConfig config;
+
+    // 动画：走子立即生效，补间按队列播放
+    TweenScheduler tweens;
+    float          animDuration     = 0.25f;   // 跳跃
+    float          iceDuration      = 0.15f;   // 冰滑
+    float          teleportDuration = 0.3f;    // 传送
+
+    bool      isGameOver = false;
+    GameState& gameState;
+
+    // 遥测：为空时不记录；lastActionMs 用来算每步的思考时间
+    TelemetryLog* telemetry        = nullptr;
+    std::uint16_t telemetrySession = 0;
+    std::uint32_t lastActionMs     = 0;
+
+    // 自动存档：为空时不存；走子、撤销、重开后各交一份给后台线程
+    AutoSave*     autosave         = nullptr;
+
+    GameRuntime(GameState& gs) : gameState(gs) {}
+};
+
+// ===== 规则判断 =====
+
+Board&       currentBoard(GameRuntime& rt);
+const Board& currentBoard(const GameRuntime& rt);
+
+// 以下四个读 floorIndex 的合计，O(1)；改了 floors 之后先 syncFloors
+int  totalPegs(const GameRuntime& rt);
+bool anyMove(const GameRuntime& rt);
+bool globalGoalWin(const GameRuntime& rt);
+bool anyKingAlive(const GameRuntime& rt);
+
+// 重算 floorIndex 里被标脏的层
+void syncFloors(GameRuntime& rt);
+
+LayerMode layerModeFor(int layers);
+
+// ===== 整局流程 =====
+
+// 按控制台菜单的编号生成配置：规则 1-3、层数 1-MaxLayers、形状 1-4
+GameConfig makeConfig(int mode, int layers, int shape,
+                      bool useIce, bool useSwamp, bool useBarrier);
+
+void initGame(GameRuntime& rt, const GameConfig& cfg);
+// 重开：按当前配置重新生成（R 键 / 托管的 key r），并记一条遥测
+void restartGame(GameRuntime& rt);
+// 布置传送格并生成 rt.links；buildTeleportLinks 只按配置生成链接，不动棋盘（读档用）
+void applyTeleportTiles(GameRuntime& rt);
+void buildTeleportLinks(GameRuntime& rt);
+
+// 撤销栈：快照压缩进局面仓库，后进先出复用编号，稳定后不再分配内存。
+// 走完一步后用 touchHistory.back() 记下碰到的层，压栈、撤销就只处理这几层
+void pushHistory(GameRuntime& rt);
+bool popHistory(GameRuntime& rt);
+
+void handlePlaying(const sf::Event& event,
+                   GameState& gameState,
+                   GameRuntime& rt);
+
+// 推进补间动画
+void updateAnimations(GameRuntime& rt, float dt);
+
+// 结算检查：本局刚结束时返回 true，并给出胜负
+bool checkGameOver(GameRuntime& rt, bool& win);
@@ -0,0 +1,149 @@
+// 逻辑线程
+#include "logic_thread.hpp"
+#include <chrono>
+
+// ===== 快照缓冲 =====
+
+void SnapshotBuffer::publish() {
+    int old = middle_.exchange(back_ | Fresh, std::memory_order_acq_rel);
+    back_ = old & ~Fresh;
+}
+
+const FrameSnapshot& SnapshotBuffer::acquire() {
+    if (middle_.load(std::memory_order_relaxed) & Fresh) {
+        int old = middle_.exchange(front_, std::memory_order_acq_rel);
+        front_ = old & ~Fresh;
+    }
+    return slots_[front_];
+}
+
+// ===== 事件队列 =====
+
+bool InputQueue::push(const sf::Event& e) {
+    std::size_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) >= Capacity) return false;
+    ring_[head & (Capacity - 1)] = e;
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+bool InputQueue::pop(sf::Event& e) {
+    std::size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail == head_.load(std::memory_order_acquire)) return false;
+    e = ring_[tail & (Capacity - 1)];
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+// ===== 逻辑线程 =====
+
+LogicThread::LogicThread(GameRuntime& rt, GameState& gameState)
+    : rt_(rt), gameState_(gameState) {}
+
+LogicThread::~LogicThread() {
+    stop();
+}
+
+void LogicThread::start() {
+    stop();
+    finished_.store(false, std::memory_order_release);
+
+    // 渲染线程第一次 acquire 之前就要有完整的一帧
+    publishNow();
+
+    running_.store(true, std::memory_order_release);
+    worker_ = std::thread(&LogicThread::loop, this);
+}
+
+void LogicThread::stop() {
+    if (!worker_.joinable()) return;
+    running_.store(false, std::memory_order_release);
+    worker_.join();
+}
+
+void LogicThread::capture(FrameSnapshot& out) {
+    out.current         = rt_.floors[rt_.currentFloor];
+    out.currentFloor    = rt_.currentFloor;
+    out.floorCount      = static_cast<int>(rt_.floors.size());
+    out.cellSize        = rt_.cellSize;
+    out.view            = rt_.view;
+    out.selection       = rt_.selection;
+    out.selectedRow     = rt_.selectedRow;
+    out.selectedCol     = rt_.selectedCol;
+    out.possibleTargets = rt_.possibleTargets;
+    out.playing         = (gameState_ == GameState::Playing);
+    out.serial          = ++serial_;
+
+    for (int r = 0; r < Board::Rows; ++r) {
+        for (int c = 0; c < Board::Cols; ++c) {
+            out.hidden[r][c] = rt_.tweens.hides(rt_.currentFloor, r, c);
+        }
+    }
+    frames_.clear();
+    rt_.tweens.activeFrames(rt_.currentFloor, frames_);
+    out.tweens.resize(frames_.size());
+    for (std::size_t i = 0; i < frames_.size(); ++i) {
+        out.tweens[i].tween = *frames_[i].tween;
+        out.tweens[i].t     = frames_[i].t;
+    }
+}
+
+bool LogicThread::step(float dt, bool& win, StepTiming* timing) {
+    using Clock = std::chrono::steady_clock;
+    auto t0 = Clock::now();
+
+    sf::Event event;
+    while (input_.pop(event)) {
+        if (gameState_ == GameState::Playing) {
+            handlePlaying(event, gameState_, rt_);
+        }
+    }
+    auto t1 = Clock::now();
+
+    updateAnimations(rt_, dt);
+    // 国王全灭或无路可走：等最后一步的动画播完再结算
+    win = false;
+    bool over = gameState_ == GameState::Playing &&
+                !rt_.tweens.busy() && checkGameOver(rt_, win);
+    auto t2 = Clock::now();
+
+    publishNow();
+    auto t3 = Clock::now();
+
+    if (timing) {
+        timing->input    = std::chrono::duration<double>(t1 - t0).count();
+        timing->update   = std::chrono::duration<double>(t2 - t1).count();
+        timing->snapshot = std::chrono::duration<double>(t3 - t2).count();
+    }
+    return over;
+}
+
+void LogicThread::publishNow() {
+    capture(snapshots_.back());
+    snapshots_.publish();
+}
+
+void LogicThread::loop() {
+    using Clock = std::chrono::steady_clock;
+    auto tick = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<float>(tickSeconds));
+    auto last = Clock::now();
+    auto next = last;
+
+    while (running_.load(std::memory_order_acquire)) {
+        auto now = Clock::now();
+        bool win = false;
+        bool over = step(std::chrono::duration<float>(now - last).count(), win);
+        last = now;
+
+        if (over) {
+            if (onGameOver) onGameOver(rt_, win);
+            finished_.store(true, std::memory_order_release);
+            return;
+        }
+
+        next += tick;
+        if (next < now) next = now;     // 落后太多时不追帧
+        std::this_thread::sleep_until(next);
+    }
+}
@@ -0,0 +1,114 @@
+#pragma once
+// 逻辑线程：规则、动画计时、结算都在这里跑，渲染线程只管取事件和画画
+//
+// 渲染线程 → 逻辑线程：无锁单生产者/单消费者事件队列（满了丢事件，渲染线程不等待）
+// 逻辑线程 → 渲染线程：每个逻辑帧把画面需要的状态拷进一份只读快照发布出去。
+//   快照用三块轮换（写的一块、读的一块、中间交接的一块），交接只是一次原子交换，
+//   双方都不加锁、不等待；渲染线程永远拿到最新的一份完整快照。
+#include "game.hpp"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <vector>
+
+// 渲染一帧所需的全部状态（只读拷贝，和 GameRuntime 不共享内存）
+struct FrameSnapshot {
+    struct ActiveTween {
+        Tween tween;
+        float t = 0.f;
+    };
+
+    Board                           current;            // 只拷当前楼层，层数再多每帧也只拷一块
+    int                             currentFloor = 0;
+    int                             floorCount   = 1;
+    float                           cellSize     = 64.f;
+    Viewport                        view;
+    bool                            selection    = false;
+    int                             selectedRow  = -1;
+    int                             selectedCol  = -1;
+    std::uint64_t                   possibleTargets = 0;   // 合法落点位掩码（cellBit）
+    bool                            hidden[Board::Rows][Board::Cols] = {};  // 正在补间中的静态棋子
+    std::vector<ActiveTween>        tweens;     // 当前楼层上正在播放的补间
+    bool                            playing = true;
+    std::uint64_t                   serial  = 0;
+
+    const Board& board() const { return current; }
+};
+
+// 三块轮换的快照缓冲：写线程填 back() 后 publish()，读线程 acquire() 拿最新的一块
+class SnapshotBuffer {
+public:
+    FrameSnapshot&       back() { return slots_[back_]; }
+    void                 publish();
+    const FrameSnapshot& acquire();
+
+private:
+    static constexpr int Fresh = 4;     // 中间那块是写线程新交出来的、读线程还没拿走
+
+    FrameSnapshot    slots_[3];
+    int              back_   = 0;       // 只有写线程碰
+    int              front_  = 1;       // 只有读线程碰
+    std::atomic<int> middle_{2};
+};
+
+// 渲染线程 → 逻辑线程的事件队列
+class InputQueue {
+public:
+    static constexpr std::size_t Capacity = 256;    // 2 的幂
+
+    bool push(const sf::Event& e);      // 满了返回 false
+    bool pop(sf::Event& e);
+
+private:
+    sf::Event                ring_[Capacity];
+    alignas(64) std::atomic<std::size_t> head_{0};
+    alignas(64) std::atomic<std::size_t> tail_{0};
+};
+
+class LogicThread {
+public:
+    LogicThread(GameRuntime& rt, GameState& gameState);
+    ~LogicThread();
+
+    LogicThread(const LogicThread&) = delete;
+    LogicThread& operator=(const LogicThread&) = delete;
+
+    // 本局结束时在逻辑线程上调用（写成绩、参考搜索等慢操作放这里，不影响画面）
+    std::function<void(GameRuntime&, bool win)> onGameOver;
+
+    void start();                       // 先同步发布一份快照，再起线程
+    void stop();
+
+    // 一个逻辑帧：处理排队的输入 → 推进动画 → 结算检查 → 发布快照；本局刚结束时返回 true。
+    // 线程里按 tickSeconds 调用；基准测试不起线程，直接按固定步长调用
+    struct StepTiming {
+        double input    = 0.0;          // 秒
+        double update   = 0.0;
+        double snapshot = 0.0;
+    };
+    bool step(float dt, bool& win, StepTiming* timing = nullptr);
+    void publishNow();                  // 不推进时间，只把当前状态发布出去
+
+    // 渲染线程调用
+    void                 post(const sf::Event& e) { input_.push(e); }
+    const FrameSnapshot& latest()                 { return snapshots_.acquire(); }
+    bool                 finished() const         { return finished_.load(std::memory_order_acquire); }
+
+    float tickSeconds = 1.f / 240.f;    // 逻辑帧间隔
+
+private:
+    void loop();
+    void capture(FrameSnapshot& out);
+
+    GameRuntime&            rt_;
+    GameState&              gameState_;
+    InputQueue              input_;
+    SnapshotBuffer          snapshots_;
+    std::vector<TweenFrame> frames_;    // capture 的临时表，复用容量
+    std::uint64_t           serial_ = 0;
+
+    std::atomic<bool> running_{false};
+    std::atomic<bool> finished_{false};
+    std::thread       worker_;
+};
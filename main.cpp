@@ -1,91 +1,39 @@
 // 专心交互和渲染
 #include "board.hpp"
+#include "game.hpp"
+#include "session_host.hpp"
+#include "beam_search.hpp"
+#include "solver.hpp"
+#include "shard_solver.hpp"
+#include "external_bfs.hpp"
+#include "solution_counter.hpp"
+#include "map_file.hpp"
+#include "solver_stats.hpp"
+#include "telemetry.hpp"
+#include "logic_thread.hpp"
+#include "frame_bench.hpp"
+#include "puzzle_gen.hpp"
+#include "save_game.hpp"
+#include "tri_board.hpp"
+#include "opening_book.hpp"
+#include "min_moves.hpp"
+#include "sparse_board.hpp"
 #include <SFML/Graphics.hpp>
 #include <SFML/Audio.hpp>
 #include <iostream>
 #include <vector>
 #include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <limits>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#ifdef _WIN32
 #include <windows.h>
+#endif
 #include <utility>
 
-// 游戏状态
-enum class GameState {
-    Over,
-    Playing
-};
-
-// 多层模式
-enum class LayerMode {
-    Single,
-    Double,
-    Triple
-};
-
-// 一局游戏配置：层数 + 特殊格 + 规则 + 地图形状
-struct GameConfig {
-    int      layers     = 1;
-    bool     useIce     = false;
-    bool     useSwamp   = false;
-    bool     useBarrier = false;
-    GameMode winMode    = GameMode::Classic;
-    MapShape mapShape   = MapShape::Cross;
-};
-
-struct GameRuntime {
-    // 多层棋盘
-    std::vector<Board>              floors;
-    std::vector<std::vector<Board>> histories;
-    int                             currentFloor = 0;
-
-    // 选择状态
-    bool selection   = false;
-    int  selectedRow = -1;
-    int  selectedCol = -1;
-    std::vector<std::pair<int,int>> possibleTargets;
-
-    float     cellSize  = 64.f;
-    int       moveCount = 0;
-    int       pegCount  = 0;
-    LayerMode layerMode = LayerMode::Single;
-    GameMode  gameMode  = GameMode::Classic;
-    GameConfig config;
-
-    // 跳跃动画
-    bool         isAnimating   = false;
-    float        animTime      = 0.f;
-    float        animDuration  = 0.25f;
-    sf::Vector2f animStart;
-    sf::Vector2f animEnd;
-    int          animFromRow   = -1;
-    int          animFromCol   = -1;
-    int          animToRow     = -1;
-    int          animToCol     = -1;
-
-    // 冰格滑行动画
-    bool         isIceAnimating = false;
-    float        iceTime        = 0.f;
-    float        iceDuration    = 0.15f;
-    sf::Vector2f iceStart;
-    sf::Vector2f iceEnd;
-    int          iceToRow       = -1;
-    int          iceToCol       = -1;
-
-    // 传送格滑行动画
-    bool         isTeleportAnimating = false;
-    float        teleportTime        = 0.f;
-    float        teleportDuration    = 0.3f;
-    int          teleportRow         = -1;
-    int          teleportCol         = -1;
-
-    bool      isGameOver = false;
-    GameState& gameState;
-
-    GameRuntime(GameState& gs) : gameState(gs) {}
-};
-void applyTeleportTiles(GameRuntime& rt);
-
 // ===== 控制台交互：从用户获取配置 =====
 
 GameMode getModeFromText() {
@@ -102,18 +50,16 @@ GameMode getModeFromText() {
     }
 }
 
-LayerMode getLayerModeFromText() {
-    std::cout << "请选择层数模式(1-单层,2-双层,3-三层): ";
-    char ch;
-    std::cin >> ch;
-    switch (ch) {
-    case '1': return LayerMode::Single;
-    case '2': return LayerMode::Double;
-    case '3': return LayerMode::Triple;
-    default:
+int getLayersFromText() {
+    std::cout << "请输入层数(1-" << MaxLayers << "): ";
+    int layers = 0;
+    if (!(std::cin >> layers) || layers < 1 || layers > MaxLayers) {
+        std::cin.clear();
+        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
         std::cerr << "无效输入，默认单层。\n";
-        return LayerMode::Single;
+        return 1;
     }
+    return layers;
 }
 
 MapShape getMapModeFromText() {
@@ -134,15 +80,9 @@ MapShape getMapModeFromText() {
 GameConfig askConfigFromConsole() {
     GameConfig cfg;
     cfg.winMode  = getModeFromText();
-    LayerMode lm = getLayerModeFromText();
+    cfg.layers   = getLayersFromText();
     cfg.mapShape = getMapModeFromText();
 
-    switch (lm) {
-    case LayerMode::Single: cfg.layers = 1; break;
-    case LayerMode::Double: cfg.layers = 2; break;
-    case LayerMode::Triple: cfg.layers = 3; break;
-    }
-
     char ch;
     std::cout << "是否启用冰格?(y/n): ";
     std::cin >> ch;
@@ -159,394 +99,24 @@ GameConfig askConfigFromConsole() {
     return cfg;
 }
 
-// ===== 一些规则判断辅助函数 =====
-
-// 单层：是否“只剩一个棋子且在 Goal 格子上”
-bool isGoalWin(const Board& board) {
-    int pegCount = board.countPegs();
-    if (pegCount != 1) return false;
-
-    for (int r = 0; r < Board::Rows; ++r) {
-        for (int c = 0; c < Board::Cols; ++c) {
-            if (board.at(r, c) == CellState::Peg) {
-                return (board.typeAt(r, c) == CellType::Goal);
-            }
-        }
-    }
-    return false;
-}
-
-// 单层：国王是否仍然存活（有棋子在 King 格上）
-bool isKingAlive(const Board& board) {
-    for (int r = 0; r < Board::Rows; ++r) {
-        for (int c = 0; c < Board::Cols; ++c) {
-            if (board.typeAt(r, c) == CellType::King &&
-                board.at(r, c) == CellState::Peg) {
-                return true;
-            }
-        }
-    }
-    return false;
-}
-
-// 多层：当前棋盘 & 历史
-Board& currentBoard(GameRuntime& rt) {
-    return rt.floors[rt.currentFloor];
-}
-const Board& currentBoard(const GameRuntime& rt) {
-    return rt.floors[rt.currentFloor];
-}
-
-// 多层：总棋子数
-int totalPegs(const GameRuntime& rt) {
-    int sum = 0;
-    for (const auto& b : rt.floors) {
-        sum += b.countPegs();
-    }
-    return sum;
-}
-
-// 多层：是否还有任意可行步
-bool anyMove(const GameRuntime& rt) {
-    for (const auto& b : rt.floors) {
-        if (b.hasMove()) return true;
-    }
-    return false;
-}
-
-// 多层：目标格胜利（全局只有一个棋子且在某个 Goal 上）
-bool globalGoalWin(const GameRuntime& rt) {
-    if (totalPegs(rt) != 1) return false;
-    for (const auto& b : rt.floors) {
-        if (isGoalWin(b)) return true;
-    }
-    return false;
-}
-
-// 多层：是否存在至少一个活着的国王
-bool anyKingAlive(const GameRuntime& rt) {
-    for (const auto& b : rt.floors) {
-        if (isKingAlive(b)) return true;
-    }
-    return false;
-}
-
-// ===== 用配置初始化整局游戏（多层） =====
-
-void initGame(GameRuntime& rt, const GameConfig& cfg) {
-    rt.config   = cfg;
-    rt.gameMode = cfg.winMode;
-
-    switch (cfg.layers) {
-    case 1: rt.layerMode = LayerMode::Single; break;
-    case 2: rt.layerMode = LayerMode::Double; break;
-    default: rt.layerMode = LayerMode::Triple; break;
-    }
-
-    SpecialConfig sc;
-    sc.useIce     = cfg.useIce;
-    sc.useSwamp   = cfg.useSwamp;
-    sc.useBarrier = cfg.useBarrier;
-    sc.extraHoles = (cfg.layers > 1);
-
-    rt.floors.clear();
-
-    for (int i = 0; i < cfg.layers; ++i) {
-        Board b(cfg.winMode, cfg.mapShape, sc);
-        rt.floors.push_back(b);
-    }
-    applyTeleportTiles(rt);
-
-    rt.histories.clear();
-    rt.histories.push_back(rt.floors);
-
-    rt.currentFloor = 0;
-
-    rt.selection   = false;
-    rt.selectedRow = -1;
-    rt.selectedCol = -1;
-    rt.possibleTargets.clear();
-
-    rt.moveCount = 0;
-    rt.pegCount  = totalPegs(rt);
-
-    rt.isAnimating     = false;
-    rt.animTime        = 0.f;
-    rt.isIceAnimating  = false;
-    rt.iceTime         = 0.f;
-    rt.iceToRow        = -1;
-    rt.iceToCol        = -1;
-    rt.animFromRow     = rt.animFromCol = -1;
-    rt.animToRow       = rt.animToCol = -1;
-
-    rt.isGameOver = false;
-}
-// 固定传送点并设置为传送格
-const std::vector<std::pair<int,int>> TELEPORT_POINTS = {
-    {1,3},{3,1},{3,5},{5,3}
-};
-void applyTeleportTiles(GameRuntime& rt) {
-    if (rt.config.layers == 1) return;
-    for (auto pos: TELEPORT_POINTS) {
-        for (auto& b: rt.floors) {
-            int r = pos.first;
-            int c = pos.second;
-            if (!b.inBounds(r, c)) continue;
-
-            CellType t = b.typeAt(r, c);
-            if (t == CellType::Goal || t == CellType::King) {
-                continue;
-            }
-            b.setType(r,c, CellType::Teleport);
-            if (b.at(r, c) == CellState::Peg) {
-                b.set(r, c, CellState::Empty);
-            }
-        }
-    }
-}
-// ===== 游戏中处理点击 / 按键 =====
-
-void handlePlaying(const sf::Event& event,
-                   GameState& gameState,
-                   GameRuntime& rt)
-{
-    // 动画中或已结束：不接受操作
-    if (rt.isAnimating || rt.isIceAnimating || rt.isTeleportAnimating || rt.isGameOver) {
-        return;
-    }
-
-    Board& board = currentBoard(rt);
-
-
-    // ESC：退出（这里先简单设为结束）
-    if (event.type == sf::Event::KeyPressed &&
-        event.key.code == sf::Keyboard::Escape) {
-        rt.selection = false;
-        rt.possibleTargets.clear();
-        gameState = GameState::Over;
-        return;
-    }
-
-    // Q/E：切换楼层
-    if (event.type == sf::Event::KeyPressed) {
-        if (event.key.code == sf::Keyboard::Q) {
-            if (rt.currentFloor > 0) {
-                rt.currentFloor--;
-                rt.selection = false;
-                rt.possibleTargets.clear();
-            }
-            return;
-        }
-        if (event.key.code == sf::Keyboard::E) {
-            if (rt.currentFloor + 1 < static_cast<int>(rt.floors.size())) {
-                rt.currentFloor++;
-                rt.selection = false;
-                rt.possibleTargets.clear();
-            }
-            return;
-        }
-    }
-
-    // 撤销（Z）——当前楼层
-    if (event.type == sf::Event::KeyPressed &&
-        event.key.code == sf::Keyboard::Z) {
-        if (rt.histories.size() > 1) {
-            rt.floors = rt.histories.back();
-            rt.histories.pop_back();
-        }
-        rt.selection = false;
-        rt.possibleTargets.clear();
-        return;
-    }
-
-    // 重开（R）——整局重新根据配置生成
-    if (event.type == sf::Event::KeyPressed &&
-        event.key.code == sf::Keyboard::R) {
-        initGame(rt, rt.config);
-        return;
-    }
-
-    // 鼠标左键：选子 / 走子
-    if (event.type == sf::Event::MouseButtonPressed &&
-        event.mouseButton.button == sf::Mouse::Left)
-    {
-        int mx = event.mouseButton.x;
-        int my = event.mouseButton.y;
-
-        int col = static_cast<int>(mx / rt.cellSize);
-        int row = static_cast<int>(my / rt.cellSize);
-
-        if (!board.inBounds(row, col)) {
-            rt.selection = false;
-            rt.possibleTargets.clear();
-            return;
-        }
-
-        // 未选中棋子：尝试选择
-        if (!rt.selection) {
-            if (board.at(row, col) == CellState::Peg &&
-                board.canMove(row, col) &&
-                board.typeAt(row,col) != CellType::Swamp) {
-                rt.selection   = true;
-                rt.selectedRow = row;
-                rt.selectedCol = col;
-                rt.possibleTargets = board.getPossibleTargets(row, col);
-            } else {
-                rt.selection = false;
-                rt.possibleTargets.clear();
-            }
-            return;
-        }
-        // 已选中棋子：尝试跳跃
-        else {
-            int fr = rt.selectedRow;
-            int fc = rt.selectedCol;
-
-            if (board.canJump(fr, fc, row, col)) {
-                // 加入历史栈
-                rt.histories.push_back(rt.floors);
-
-                int jumpRow  = row;
-                int jumpCol  = col;
-                int finalRow = jumpRow;
-                int finalCol = jumpCol;
-
-                // 真正执行跳跃
-                board.applyJump(fr, fc, jumpRow, jumpCol);
-
-                // 冰格逻辑：如果落在 Ice 上，且前方一格为空 & 不是沼泽/障碍，则滑一步
-                bool hasIceSlide = false;
-                if (board.typeAt(jumpRow, jumpCol) == CellType::Ice) {
-                    int dr = jumpRow - fr;
-                    int dc = jumpCol - fc;
-                    int stepR = (dr == 0 ? 0 : dr / std::abs(dr));
-                    int stepC = (dc == 0 ? 0 : dc / std::abs(dc));
-
-                    int slideRow = jumpRow + stepR;
-                    int slideCol = jumpCol + stepC;
-
-                    if (board.inBounds(slideRow, slideCol) &&
-                        board.at(slideRow, slideCol) == CellState::Empty &&
-                        board.typeAt(slideRow, slideCol) != CellType::Barrier)
-                    {
-                        bool kingSliding = (board.typeAt(jumpRow, jumpCol) == CellType::King);
-                        
-                        board.set(jumpRow, jumpCol, CellState::Empty);
-                        board.set(slideRow, slideCol, CellState::Peg);
-
-                        if (kingSliding) {
-                            board.setType(jumpRow, jumpCol, CellType::Normal);
-                            board.setType(slideRow, slideCol, CellType::King);
-                        }
-                        finalRow = slideRow;
-                        finalCol = slideCol;
-                        hasIceSlide = true;
-                    }
-                }
-                // 传送格逻辑：如果落在 Teleport 上，则传送到对应位置
-                int srcFloor = rt.currentFloor;
-                int teleRow = finalRow;
-                int teleCol = finalCol;
-
-                if (rt.config.layers > 1 &&
-                    board.typeAt(teleRow, teleCol) == CellType::Teleport &&
-                    srcFloor + 1 < static_cast<int>(rt.floors.size()))
-                {   
-                    int dstFloor = (srcFloor + 1) % (int)rt.floors.size();
-                    Board& dstBoard = rt.floors[dstFloor];
-
-                    if (dstBoard.inBounds(teleRow, teleCol) &&
-                        dstBoard.at(teleRow, teleCol) == CellState::Empty) 
-                    {
-                        bool kingTeleporting = (board.typeAt(teleRow, teleCol) == CellType::King);
-
-                        board.set(teleRow, teleCol, CellState::Empty);
-                        if (kingTeleporting) {
-                            board.setType(teleRow, teleCol, CellType::Normal);
-                        }
-
-                        dstBoard.set(teleRow, teleCol, CellState::Peg);
-
-                        if (kingTeleporting) {
-                            dstBoard.setType(teleRow, teleCol, CellType::King);
-                        }
-
-                        rt.currentFloor = dstFloor;
-
-                        rt.isTeleportAnimating = true;
-                        rt.teleportTime = 0.f;
-                        rt.teleportRow = teleRow;
-                        rt.teleportCol = teleCol;
-                    }
-                }
-                rt.moveCount++;
-                rt.pegCount = totalPegs(rt);
-
-                // 第一段跳跃动画
-                float pr = rt.cellSize * 0.35f;
-                rt.isAnimating = true;
-                rt.animTime    = 0.f;
-                rt.animFromRow = fr;
-                rt.animFromCol = fc;
-                rt.animToRow   = jumpRow;
-                rt.animToCol   = jumpCol;
-                rt.animStart = {
-                    fc * rt.cellSize + rt.cellSize * 0.5f - pr,
-                    fr * rt.cellSize + rt.cellSize * 0.5f - pr
-                };
-                rt.animEnd = {
-                    jumpCol * rt.cellSize + rt.cellSize * 0.5f - pr,
-                    jumpRow * rt.cellSize + rt.cellSize * 0.5f - pr
-                };
-
-                // 第二段冰滑动画
-                if (hasIceSlide) {
-                    rt.isIceAnimating = true;
-                    rt.iceTime        = 0.f;
-                    rt.iceToRow       = finalRow;
-                    rt.iceToCol       = finalCol;
-                    rt.iceStart = {
-                        jumpCol * rt.cellSize + rt.cellSize * 0.5f,
-                        jumpRow * rt.cellSize + rt.cellSize * 0.5f
-                    };
-                    rt.iceEnd = {
-                        finalCol * rt.cellSize + rt.cellSize * 0.5f,
-                        finalRow * rt.cellSize + rt.cellSize * 0.5f
-                    };
-                } else {
-                    rt.isIceAnimating = false;
-                    rt.iceToRow = rt.iceToCol = -1;
-                }
-
-                // 清除高亮
-                rt.selection = false;
-                rt.possibleTargets.clear();
-            } else {
-                // 点击非法落点 → 取消选中
-                rt.selection = false;
-                rt.possibleTargets.clear();
-            }
-
-            return;
-        }
-    }
-}
-
 // ===== 绘制函数 =====
 
-void drawGame(sf::RenderWindow& window,
-              GameRuntime& rt)
+// 只读逻辑线程发布的快照，不碰 GameRuntime。画到任意目标（窗口 / 离屏纹理），不负责 display
+void drawGame(sf::RenderTarget& target,
+              const FrameSnapshot& snap)
 {
-    window.clear(sf::Color::Black);
+    target.clear(sf::Color::Black);
 
-    const Board& board = currentBoard(rt);
+    const Board&    board = snap.board();
+    const Viewport& view  = snap.view;
+    float cs = snap.cellSize * view.zoom;   // 屏幕上一格的大小
 
-    sf::RectangleShape cell({rt.cellSize - 2.f, rt.cellSize - 2.f});
+    sf::RectangleShape cell({cs - 2.f, cs - 2.f});
     cell.setOutlineThickness(2.f);
     cell.setOutlineColor(sf::Color::Black);
     cell.setFillColor(sf::Color(60,60,60));
 
-    float pegRadius = rt.cellSize * 0.35f;
+    float pegRadius = cs * 0.35f;
 
     sf::CircleShape peg(pegRadius);
     peg.setOutlineThickness(2.f);
@@ -562,42 +132,40 @@ void drawGame(sf::RenderWindow& window,
 
     // 国王棋子：用方块画
     sf::RectangleShape kingPiece;
-    float kingSize = rt.cellSize * 0.6f;
+    float kingSize = cs * 0.6f;
     kingPiece.setSize({kingSize, kingSize});
     kingPiece.setOrigin(kingSize / 2.f, kingSize / 2.f);
     kingPiece.setFillColor(sf::Color(255, 215, 0)); // 金黄
     kingPiece.setOutlineThickness(2.f);
     kingPiece.setOutlineColor(sf::Color::Red);
 
-    for (int r = 0; r < Board::Rows; ++r) {
-        for (int c = 0; c < Board::Cols; ++c) {
+    // 只画视口内的格子
+    sf::Vector2u winSize = target.getSize();
+    int r0, r1, c0, c1;
+    view.visibleCells(Board::Rows, Board::Cols, snap.cellSize,
+                      static_cast<float>(winSize.x), static_cast<float>(winSize.y),
+                      r0, r1, c0, c1);
+
+    for (int r = r0; r < r1; ++r) {
+        for (int c = c0; c < c1; ++c) {
             CellState state = board.at(r, c);
             CellType  type  = board.typeAt(r, c);
 
             if (state == CellState::Invalid) continue;
 
-            float x = c * rt.cellSize + 1.f;
-            float y = r * rt.cellSize + 1.f;
+            float x = view.toScreenX(c * snap.cellSize) + 1.f;
+            float y = view.toScreenY(r * snap.cellSize) + 1.f;
 
             cell.setPosition(x, y);
             cell.setFillColor(sf::Color(60, 60, 60));
 
             // 选中格子（红）
-            if (rt.selection && r == rt.selectedRow && c == rt.selectedCol) {
+            if (snap.selection && r == snap.selectedRow && c == snap.selectedCol) {
                 cell.setFillColor(sf::Color::Red);
             }
 
             // 可跳目标（绿）
-            bool isPossible = false;
-            if (rt.selection) {
-                for (auto target : rt.possibleTargets) {
-                    if (target.first == r && target.second == c) {
-                        isPossible = true;
-                        break;
-                    }
-                }
-            }
-            if (isPossible) {
+            if (snap.selection && (snap.possibleTargets & cellBit(r, c))) {
                 cell.setFillColor(sf::Color::Green);
             }
 
@@ -614,108 +182,183 @@ void drawGame(sf::RenderWindow& window,
                 cell.setFillColor(sf::Color(128, 0, 128)); // 紫色格子黄色格子
             }
 
-            window.draw(cell);
+            target.draw(cell);
 
             // 静态棋子（非动画中那颗）
             if (state == CellState::Peg) {
-                bool skip = false;
-                if (rt.isAnimating &&
-                    r == rt.animToRow && c == rt.animToCol) {
-                    skip = true;
-                }
-                if (rt.isIceAnimating &&
-                    r == rt.iceToRow && c == rt.iceToCol) {
-                    skip = true;
-                }
+                bool skip = snap.hidden[r][c];
 
                 if (!skip) {
                     // 国王棋子方块
                     if (type == CellType::King) {
-                        kingPiece.setPosition(
-                            x + rt.cellSize * 0.5f,
-                            y + rt.cellSize * 0.5f
-                        );
-                        window.draw(kingPiece);
+                        kingPiece.setPosition(x + cs * 0.5f, y + cs * 0.5f);
+                        target.draw(kingPiece);
                     } else {
-                        peg.setPosition(
-                            x + rt.cellSize * 0.5f,
-                            y + rt.cellSize * 0.5f
-                        );
-                        window.draw(peg);
+                        peg.setPosition(x + cs * 0.5f, y + cs * 0.5f);
+                        target.draw(peg);
                     }
                 }
             }
         }
     }
 
-    // 跳跃动画（圆形）
-    if (rt.isAnimating) {
-        float t = rt.animTime / rt.animDuration;
-        if (t > 1.f) t = 1.f;
-
-        float basex = rt.animStart.x * (1.f - t) + rt.animEnd.x * t;
-        float basey = rt.animStart.y * (1.f - t) + rt.animEnd.y * t;
-
-        float H = rt.cellSize * 0.6f;
-        float offset = -H * (4.f * t * (1.f - t));
-
-        float drawX = basex + pegRadius;
-        float drawY = basey + offset + pegRadius;
-
-        animPeg.setPosition(drawX, drawY);
-        window.draw(animPeg);
+    // 补间动画：只画当前楼层上正在播放的
+    for (const FrameSnapshot::ActiveTween& f : snap.tweens) {
+        const Tween& tw = f.tween;
+        float t = f.t;
+        float fromX = view.toScreenX((tw.fromCol + 0.5f) * snap.cellSize);
+        float fromY = view.toScreenY((tw.fromRow + 0.5f) * snap.cellSize);
+        float toX   = view.toScreenX((tw.toCol + 0.5f) * snap.cellSize);
+        float toY   = view.toScreenY((tw.toRow + 0.5f) * snap.cellSize);
+
+        switch (tw.kind) {
+        case TweenKind::Jump: {
+            // 抛物线：中点最高
+            float H = cs * 0.6f;
+            float offset = -H * (4.f * t * (1.f - t));
+            animPeg.setPosition(fromX * (1.f - t) + toX * t,
+                                fromY * (1.f - t) + toY * t + offset);
+            target.draw(animPeg);
+            break;
+        }
+        case TweenKind::Slide:
+            animPeg.setPosition(fromX * (1.f - t) + toX * t,
+                                fromY * (1.f - t) + toY * t);
+            target.draw(animPeg);
+            break;
+        case TweenKind::Teleport: {
+            float basedRadius = cs * 0.35f;
+            float radius = basedRadius * (1.2f - 0.8f * t);
+
+            sf::CircleShape tp(radius);
+
+            // 颜色变淡
+            unsigned char alpha = static_cast<unsigned char>(255.f * (1.f - t));
+            tp.setFillColor(sf::Color(255, 255, 255, alpha));
+            tp.setOutlineThickness(1.f);
+            tp.setOutlineColor(sf::Color(255, 255, 255, alpha));
+
+            tp.setOrigin(radius, radius);
+            tp.setPosition(toX, toY);
+            target.draw(tp);
+            break;
+        }
+        }
     }
 
-    // 冰滑动画（圆形）
-    if (!rt.isAnimating && rt.isIceAnimating) {
-        float t = rt.iceTime / rt.iceDuration;
-        if (t > 1.f) t = 1.f;
+}
 
-        float x = rt.iceStart.x * (1.f - t) + rt.iceEnd.x * t;
-        float y = rt.iceStart.y * (1.f - t) + rt.iceEnd.y * t;
+// ===== 大地图浏览：视口裁剪 + 一次批量绘制 =====
 
-        animPeg.setPosition(x, y);
-        window.draw(animPeg);
+static sf::Color mapCellColor(CellType type) {
+    switch (type) {
+    case CellType::Ice:      return sf::Color::Blue;
+    case CellType::Barrier:  return sf::Color(150, 75, 0);
+    case CellType::Swamp:    return sf::Color(0, 100, 0);
+    case CellType::Goal:     return sf::Color::Cyan;
+    case CellType::Teleport: return sf::Color(128, 0, 128);
+    default:                 return sf::Color(60, 60, 60);
     }
-    if (rt.isTeleportAnimating &&
-        &currentBoard(rt) == &rt.floors[rt.currentFloor] &&
-        rt.teleportRow >= 0 && rt.teleportCol >= 0) 
-    {
-        float t = rt.teleportTime / rt.teleportDuration;
-        if (t > 1.f) t = 1.f;
+}
 
-        float basedRadius = rt.cellSize * 0.35f;
-        float radius = basedRadius * (1.2f - 0.8f * t);
+static void appendQuad(sf::VertexArray& va, float x, float y, float size, sf::Color color) {
+    va.append(sf::Vertex({x, y}, color));
+    va.append(sf::Vertex({x + size, y}, color));
+    va.append(sf::Vertex({x + size, y + size}, color));
+    va.append(sf::Vertex({x, y + size}, color));
+}
 
-        sf::CircleShape tp(radius);
+// 滚轮缩放，方向键 / 右键拖动平移，V 复位，Esc 退出
+void viewMapFile(const MapFile& map) {
+    const float cellSize = 16.f;
+    sf::RenderWindow window(sf::VideoMode(960, 720), "Peg Solitaire - Map Viewer");
+    window.setFramerateLimit(60);
 
-        // 颜色变淡
-        unsigned char alpha = static_cast<unsigned char>(255.f * (1.f - t));
-        tp.setFillColor(sf::Color(255, 255, 255, alpha));
-        tp.setOutlineThickness(1.f);
-        tp.setOutlineColor(sf::Color(255, 255, 255, alpha));
+    Viewport view;
+    view.minZoom = 0.1f;
+    sf::VertexArray quads(sf::Quads);
+    bool dragging = false;
+    int  lastX = 0, lastY = 0;
 
-        tp.setOrigin(radius, radius);
+    while (window.isOpen()) {
+        sf::Event event;
+        while (window.pollEvent(event)) {
+            if (event.type == sf::Event::Closed) window.close();
+            if (event.type == sf::Event::MouseWheelScrolled) {
+                view.zoomAt(event.mouseWheelScroll.delta > 0 ? 1.25f : 0.8f,
+                            static_cast<float>(event.mouseWheelScroll.x),
+                            static_cast<float>(event.mouseWheelScroll.y));
+            }
+            if (event.type == sf::Event::MouseButtonPressed &&
+                event.mouseButton.button == sf::Mouse::Right) {
+                dragging = true;
+                lastX = event.mouseButton.x;
+                lastY = event.mouseButton.y;
+            }
+            if (event.type == sf::Event::MouseButtonReleased) dragging = false;
+            if (event.type == sf::Event::MouseMoved && dragging) {
+                view.pan(static_cast<float>(lastX - event.mouseMove.x),
+                         static_cast<float>(lastY - event.mouseMove.y));
+                lastX = event.mouseMove.x;
+                lastY = event.mouseMove.y;
+            }
+            if (event.type == sf::Event::KeyPressed) {
+                switch (event.key.code) {
+                case sf::Keyboard::Left:   view.pan(-cellSize * 4.f, 0.f); break;
+                case sf::Keyboard::Right:  view.pan( cellSize * 4.f, 0.f); break;
+                case sf::Keyboard::Up:     view.pan(0.f, -cellSize * 4.f); break;
+                case sf::Keyboard::Down:   view.pan(0.f,  cellSize * 4.f); break;
+                case sf::Keyboard::V:      view.reset();                    break;
+                case sf::Keyboard::Escape: window.close();                  break;
+                default: break;
+                }
+            }
+        }
 
-        float x = (rt.teleportCol + 0.5f) * rt.cellSize;
-        float y = (rt.teleportRow + 0.5f) * rt.cellSize;
+        // 只遍历视口内的格子；缩得很小时格子之间不留缝
+        sf::Vector2u size = window.getSize();
+        int r0, r1, c0, c1;
+        view.visibleCells(map.rows(), map.cols(), cellSize,
+                          static_cast<float>(size.x), static_cast<float>(size.y),
+                          r0, r1, c0, c1);
+        float cs  = cellSize * view.zoom;
+        float gap = cs >= 6.f ? 1.f : 0.f;
+
+        quads.clear();
+        for (int r = r0; r < r1; ++r) {
+            for (int c = c0; c < c1; ++c) {
+                CellState state = map.at(r, c);
+                if (state == CellState::Invalid) continue;
+                CellType type = map.typeAt(r, c);
+                float x = view.toScreenX(c * cellSize);
+                float y = view.toScreenY(r * cellSize);
+                appendQuad(quads, x + gap, y + gap, cs - 2.f * gap, mapCellColor(type));
+                if (state == CellState::Peg) {
+                    sf::Color pegColor = (type == CellType::King) ? sf::Color(255, 215, 0)
+                                                                  : sf::Color(220, 220, 50);
+                    appendQuad(quads, x + cs * 0.2f, y + cs * 0.2f, cs * 0.6f, pegColor);
+                }
+            }
+        }
 
-        tp.setPosition(x, y);
-        window.draw(tp);
+        window.clear(sf::Color::Black);
+        window.draw(quads);
+        window.display();
     }
-
-    window.display();
 }
 
 // ===== 结算 & 成绩记录 =====
 
+// moveCount：跳跃次数；chainMoves：经典计步（同一颗棋子连跳算一步），最好成绩按它记
 void evaluation(bool win,
                 int pegCount,
                 int moveCount,
+                int chainMoves,
                 GameMode mode)
 {
     std::cout << "剩余棋子数: " << pegCount << "\n";
-    std::cout << "总步数: "   << moveCount << "\n";
+    std::cout << "总跳数: "   << moveCount << "\n";
+    std::cout << "总步数: "   << chainMoves << "（连跳算一步）\n";
 
     if (win) {
         std::cout << "—— 恭喜，胜利！——\n";
@@ -744,7 +387,7 @@ void evaluation(bool win,
     }
 
     if (pegCount < number[0]) number[0] = pegCount;
-    if (moveCount < number[1]) number[1] = moveCount;
+    if (chainMoves < number[1]) number[1] = chainMoves;
 
     std::cout << "历史最少棋子: " << number[0] << "\n";
     std::cout << "历史最少步数: " << number[1] << "\n";
@@ -757,19 +400,461 @@ void evaluation(bool win,
     }
 }
 
+// 三角形棋盘的文本显示：每行居中，字符与文本地图格式相同
+static void printTriBoard(const TriBoard& board) {
+    for (int r = 0; r < board.side(); ++r) {
+        std::cout << std::string(board.side() - 1 - r, ' ');
+        for (int c = 0; c <= r; ++c) {
+            bool peg = board.at(r, c) == CellState::Peg;
+            char ch = peg ? 'o' : '.';
+            switch (board.typeAt(r, c)) {
+            case CellType::King:    ch = 'K';               break;
+            case CellType::Goal:    ch = peg ? 'g' : 'G';   break;
+            case CellType::Ice:     ch = peg ? 'i' : '~';   break;
+            case CellType::Swamp:   ch = peg ? 's' : '%';   break;
+            case CellType::Barrier: ch = '#';               break;
+            default: break;
+            }
+            std::cout << ch << ' ';
+        }
+        std::cout << '\n';
+    }
+}
+
+// 稀疏棋盘的文本显示：只画棋子的外接矩形（连同目标格），目标格空着时画 G
+static void printSparseBoard(const SparseBoard& board, int targetR, int targetC) {
+    int minR, minC, maxR, maxC;
+    if (!board.bounds(minR, minC, maxR, maxC)) return;
+    minR = std::min(minR, targetR);
+    maxR = std::max(maxR, targetR);
+    minC = std::min(minC, targetC);
+    maxC = std::max(maxC, targetC);
+    for (int r = minR; r <= maxR; ++r) {
+        for (int c = minC; c <= maxC; ++c) {
+            char ch = '.';
+            switch (board.at(r, c)) {
+            case CellState::Peg:     ch = 'o'; break;
+            case CellState::Invalid: ch = '#'; break;
+            default: if (r == targetR && c == targetC) ch = 'G'; break;
+            }
+            std::cout << ch << ' ';
+        }
+        std::cout << '\n';
+    }
+}
+
 // ===== main =====
 
-int main() {
+int main(int argc, char** argv) {
+#ifdef _WIN32
     // 解决 Windows 控制台中文乱码
     SetConsoleOutputCP(CP_UTF8);
     SetConsoleCP(CP_UTF8);
+#endif
+
+    // 命令行参数
+    //   --headless [会话数]  无窗口托管多局，命令走标准输入输出
+    //   --solver-mb <MB>     求解器置换表内存预算
+    //   --shard-solve <进程数> <规则> <层数> <形状>   多进程分层穷举
+    //   --shard-resume       从检查点继续上次的分层穷举
+    //   --shard-dir <目录>    检查点目录（默认 shard_ckpt）
+    //   --bfs <规则> <层数> <形状>   外存分层穷举，每层局面数 + 可解位图
+    //   --bfs-dir <目录> / --bfs-mb <MB>   输出目录 / 排序缓冲区大小
+    //   --count <规则> <层数> <形状> [--count-threads N]   统计获胜走法总数（按第一步分列）
+    //   --compile-map <文本> <二进制>      把文本地图编译成可内存映射的 .pmb
+    //   --map <文件.pmb>      小地图直接开局，超过 7×7 的大地图进入浏览模式
+    //   --seed <种子>         固定开局（特殊格、挖洞），用于复现别人报告的棋盘
+    //   --bench-frames [帧数] 离屏跑脚本化对局，输出帧率、各阶段耗时、每帧分配次数
+    //   --telemetry <文件>    每步操作写入二进制遥测日志（窗口版和 --headless 都可用）
+    //   --puzzle <棋子数>     单层开局由终局反跳生成，保证有解
+    //   --save <文件>         自动存档（后台写盘）；文件里有未结束的对局时直接续玩
+    //   --tri <边长> [空位编号] [规则 1-3]   三角形六方向棋盘：求解并打印走法（默认 15 孔）
+    //   --puzzle-bench <规则> <形状> <棋子数> [个数]   批量反向生成并逐个回放验证，输出每秒题数
+    //   --min-moves <规则> <形状> [--min-threads N]   单层最少步数（同一颗棋子连跳算一步），并行 IDA*
+    //   --build-book <文件> [步数]   生成标准开局的开局库（默认前 4 步）；游戏目录下的 openingbook.bin 供提示使用
+    //   --link <层,行,列,层,行,列>   自定义传送链接（可重复，楼层从 0 数）；给了就不用默认的四个传送点
+    //   --solver-stats <文件> [秒]   求解器计数定期写成 Prometheus 文本（默认每 5 秒），退出时再写一次
+    //   --soldiers <前进行数> [军队行数] [半宽]   康威士兵：无边界稀疏棋盘上能否推进这么多行（默认 5 行 × 7 列的军队）
+    bool headless = false;
+    int  capacity = 4096;
+    bool shard    = false;
+    int  shardMode = 1, shardLayers = 1, shardShape = 1;
+    ShardConfig shardCfg;
+    bool bfs      = false;
+    int  bfsMode = 1, bfsLayers = 1, bfsShape = 1;
+    ExternalBfsConfig bfsCfg;
+    bool count    = false;
+    int  countMode = 1, countLayers = 1, countShape = 1;
+    CountConfig countCfg;
+    std::string mapPath;
+    std::string telemetryPath;
+    std::string savePath;
+    std::uint64_t seed = 0;
+    int  benchFrames = 0;
+    int  puzzlePegs  = 0;
+    bool puzzleBench = false;
+    int  puzzleMode = 1, puzzleShape = 1, puzzleCount = 10000;
+    bool tri      = false;
+    int  triSide = 5, triHole = 0, triMode = 1;
+    std::string bookPath;
+    BookBuildConfig bookCfg;
+    bool minMoves = false;
+    int  minMode = 1, minShape = 1;
+    MinMoveConfig minCfg;
+    std::vector<TeleportLink> teleports;
+    std::string statsPath;
+    int  statsInterval = 5;
+    bool soldiers = false;
+    int  soldierLevel = 4, soldierRows = 5, soldierHalf = 3;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--headless") == 0) {
+            headless = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                capacity = std::atoi(argv[++i]);
+            }
+        } else if (std::strcmp(argv[i], "--solver-mb") == 0 && i + 1 < argc) {
+            setSolverMemoryBudget(static_cast<std::size_t>(std::atoi(argv[++i])) << 20);
+        } else if (std::strcmp(argv[i], "--shard-solve") == 0 && i + 4 < argc) {
+            shard            = true;
+            shardCfg.workers = std::atoi(argv[++i]);
+            shardMode        = std::atoi(argv[++i]);
+            shardLayers      = std::atoi(argv[++i]);
+            shardShape       = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--shard-resume") == 0) {
+            shard           = true;
+            shardCfg.resume = true;
+        } else if (std::strcmp(argv[i], "--shard-dir") == 0 && i + 1 < argc) {
+            shardCfg.checkpointDir = argv[++i];
+        } else if (std::strcmp(argv[i], "--bfs") == 0 && i + 3 < argc) {
+            bfs       = true;
+            bfsMode   = std::atoi(argv[++i]);
+            bfsLayers = std::atoi(argv[++i]);
+            bfsShape  = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--bfs-dir") == 0 && i + 1 < argc) {
+            bfsCfg.dir = argv[++i];
+        } else if (std::strcmp(argv[i], "--bfs-mb") == 0 && i + 1 < argc) {
+            bfsCfg.memoryBytes = static_cast<std::size_t>(std::atoi(argv[++i])) << 20;
+        } else if (std::strcmp(argv[i], "--count") == 0 && i + 3 < argc) {
+            count       = true;
+            countMode   = std::atoi(argv[++i]);
+            countLayers = std::atoi(argv[++i]);
+            countShape  = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--count-threads") == 0 && i + 1 < argc) {
+            countCfg.threads = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--compile-map") == 0 && i + 2 < argc) {
+            std::string error;
+            if (!compileMapText(argv[i + 1], argv[i + 2], error)) {
+                std::cout << "地图编译失败：" << error << std::endl;
+                return 1;
+            }
+            std::cout << "已生成 " << argv[i + 2] << std::endl;
+            return 0;
+        } else if (std::strcmp(argv[i], "--map") == 0 && i + 1 < argc) {
+            mapPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--bench-frames") == 0) {
+            benchFrames = 3000;
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                benchFrames = std::atoi(argv[++i]);
+            }
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--telemetry") == 0 && i + 1 < argc) {
+            telemetryPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--tri") == 0 && i + 1 < argc) {
+            tri     = true;
+            triSide = std::atoi(argv[++i]);
+            if (i + 1 < argc && argv[i + 1][0] != '-') triHole = std::atoi(argv[++i]);
+            if (i + 1 < argc && argv[i + 1][0] != '-') triMode = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--save") == 0 && i + 1 < argc) {
+            savePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--puzzle") == 0 && i + 1 < argc) {
+            puzzlePegs = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--puzzle-bench") == 0 && i + 3 < argc) {
+            puzzleBench = true;
+            puzzleMode  = std::atoi(argv[++i]);
+            puzzleShape = std::atoi(argv[++i]);
+            puzzlePegs  = std::atoi(argv[++i]);
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                puzzleCount = std::atoi(argv[++i]);
+            }
+        } else if (std::strcmp(argv[i], "--min-moves") == 0 && i + 2 < argc) {
+            minMoves = true;
+            minMode  = std::atoi(argv[++i]);
+            minShape = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--min-threads") == 0 && i + 1 < argc) {
+            minCfg.threads = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--build-book") == 0 && i + 1 < argc) {
+            bookPath = argv[++i];
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                bookCfg.depth = std::atoi(argv[++i]);
+            }
+        } else if (std::strcmp(argv[i], "--link") == 0 && i + 1 < argc) {
+            TeleportLink l;
+            if (std::sscanf(argv[++i], "%d,%d,%d,%d,%d,%d",
+                            &l.floor, &l.row, &l.col, &l.toFloor, &l.toRow, &l.toCol) != 6) {
+                std::cout << "传送链接格式：--link 层,行,列,层,行,列" << std::endl;
+                return 1;
+            }
+            teleports.push_back(l);
+        } else if (std::strcmp(argv[i], "--solver-stats") == 0 && i + 1 < argc) {
+            statsPath = argv[++i];
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                statsInterval = std::atoi(argv[++i]);
+            }
+        } else if (std::strcmp(argv[i], "--soldiers") == 0 && i + 1 < argc) {
+            soldiers     = true;
+            soldierLevel = std::atoi(argv[++i]);
+            if (i + 1 < argc && argv[i + 1][0] != '-') soldierRows = std::atoi(argv[++i]);
+            if (i + 1 < argc && argv[i + 1][0] != '-') soldierHalf = std::atoi(argv[++i]);
+        }
+    }
+
+    TelemetryLog telemetry;
+    if (!telemetryPath.empty() && !telemetry.start(telemetryPath)) {
+        std::cout << "无法写入遥测日志：" << telemetryPath << std::endl;
+        return 1;
+    }
+    TelemetryLog* telemetryLog = telemetryPath.empty() ? nullptr : &telemetry;
+
+    // 析构时写最后一次，各个 return 路径都不用管
+    SolverStatsExporter solverStats;
+    if (!statsPath.empty() && !solverStats.start(statsPath, statsInterval)) {
+        std::cout << "无法写入求解器计数：" << statsPath << std::endl;
+        return 1;
+    }
+
+    if (count) {
+        GameState state = GameState::Playing;
+        GameRuntime solveRt(state);
+        initGame(solveRt, makeConfig(countMode, countLayers, countShape, false, false, false));
+
+        CountReport rep = countSolutions(solveRt.floors, solveRt.gameMode, countCfg);
+        if (!rep.ok) {
+            std::cout << "解法计数失败：" << rep.error << std::endl;
+            return 1;
+        }
+        for (const auto& fm : rep.perMove) {
+            std::cout << "第 " << (fm.move.floor + 1) << " 层 (" << fm.move.r1 << "," << fm.move.c1
+                      << ") → (" << fm.move.r2 << "," << fm.move.c2 << ")："
+                      << fm.count.toString() << "\n";
+        }
+        std::cout << "获胜走法共 " << rep.total.toString()
+                  << (rep.total.saturated() ? "（已超出 128 位，为下限）" : "")
+                  << " 条，记忆局面 " << rep.positions << " 个，用时 "
+                  << rep.seconds << " 秒" << std::endl;
+        return 0;
+    }
+
+    if (minMoves) {
+        GameState state = GameState::Playing;
+        GameRuntime solveRt(state);
+        initGame(solveRt, makeConfig(minMode, 1, minShape, false, false, false));
+
+        MinMoveReport rep = solveMinMoves(solveRt.floors[0], solveRt.gameMode, minCfg);
+        if (!rep.ok) {
+            std::cout << "最少步数求解失败：" << rep.error << std::endl;
+            return 1;
+        }
+        for (std::size_t i = 0; i < rep.line.size(); ++i) {
+            std::cout << "第 " << (i + 1) << " 步：(" << rep.line[i][0].r1 << "," << rep.line[i][0].c1 << ")";
+            for (const auto& j : rep.line[i]) {
+                std::cout << " → (" << j.r2 << "," << j.c2 << ")";
+            }
+            std::cout << "\n";
+        }
+        if (rep.solved) {
+            std::cout << "最少 " << rep.moves << " 步";
+        } else if (rep.aborted) {
+            std::cout << "超出节点上限，至少 " << rep.moves << " 步";
+        } else {
+            std::cout << "无解";
+        }
+        std::cout << "，搜索 " << rep.nodes << " 个局面，用时 " << rep.seconds << " 秒" << std::endl;
+        return 0;
+    }
+
+    if (bfs) {
+        GameState state = GameState::Playing;
+        GameRuntime solveRt(state);
+        initGame(solveRt, makeConfig(bfsMode, bfsLayers, bfsShape, false, false, false));
+
+        ExternalBfsReport rep = runExternalBfs(solveRt.floors, solveRt.gameMode, bfsCfg);
+        if (!rep.ok) {
+            std::cout << "分层穷举失败：" << rep.error << std::endl;
+            return 1;
+        }
+        for (std::size_t i = 0; i < rep.levelCounts.size(); ++i) {
+            std::cout << "第 " << i << " 层：" << rep.levelCounts[i] << " 个局面，"
+                      << rep.solvableCounts[i] << " 个可解\n";
+        }
+        std::cout << "写盘 " << (rep.bytesWritten >> 20) << " MB，用时 "
+                  << rep.seconds << " 秒" << std::endl;
+        return 0;
+    }
+
+    if (shard) {
+        GameState state = GameState::Playing;
+        GameRuntime solveRt(state);
+        initGame(solveRt, makeConfig(shardMode, shardLayers, shardShape, false, false, false));
+
+        ShardReport rep = runShardedSolve(solveRt.floors, solveRt.gameMode, shardCfg);
+        if (!rep.ok) {
+            std::cout << "分片求解失败：" << rep.error << std::endl;
+            return 1;
+        }
+        for (std::size_t i = 0; i < rep.levelCounts.size(); ++i) {
+            std::cout << "第 " << i << " 层：" << rep.levelCounts[i] << " 个局面\n";
+        }
+        std::cout << (rep.solvable ? "有解" : "无解")
+                  << "，胜利终局 " << rep.wins << " 个，用时 " << rep.seconds << " 秒" << std::endl;
+        return 0;
+    }
+
+    if (tri) {
+        GameMode mode = makeConfig(triMode, 1, 1, false, false, false).winMode;
+        TriBoard board(triSide, mode, triHole);
+        printTriBoard(board);
+
+        auto start = std::chrono::steady_clock::now();
+        SolveResult res = solveTriangle(board);
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        for (const auto& j : res.line) {
+            std::cout << "(" << j.r1 << "," << j.c1 << ") → (" << j.r2 << "," << j.c2 << ")\n";
+        }
+        std::cout << (res.solved ? "有解" : "无解") << "，最少剩 " << res.bestPegs
+                  << " 颗，搜索 " << res.nodes << " 个局面，用时 " << secs << " 秒" << std::endl;
+        return 0;
+    }
+
+    if (soldiers) {
+        // 军队占第 0 行往下 soldierRows 行，目标在第 0 行上方 soldierLevel 行的中间
+        SparseBoard board;
+        board.fillRect(0, -soldierHalf, soldierRows - 1, soldierHalf);
+        printSparseBoard(board, -soldierLevel, 0);
+
+        auto start = std::chrono::steady_clock::now();
+        AdvanceResult res = solveAdvance(board, -soldierLevel, 0, 20000000);
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        for (const auto& j : res.line) {
+            std::cout << "(" << j.r1 << "," << j.c1 << ") → (" << j.r2 << "," << j.c2 << ")\n";
+        }
+        std::cout << "宝塔和 " << res.pagoda << "，";
+        if (res.reached) {
+            std::cout << "推进 " << soldierLevel << " 行，共 " << res.line.size() << " 跳";
+        } else if (res.pagodaCut) {
+            std::cout << "宝塔和不到 1，不可能推进 " << soldierLevel << " 行";
+        } else {
+            std::cout << (res.aborted ? "超出节点上限，未找到" : "无解");
+        }
+        std::cout << "，搜索 " << res.nodes << " 个局面，棋盘占用 " << board.memoryBytes()
+                  << " 字节，用时 " << secs << " 秒" << std::endl;
+        return 0;
+    }
+
+    if (!bookPath.empty()) {
+        BookBuildReport rep = buildOpeningBook(bookPath, bookCfg, &std::cout);
+        if (!rep.ok) {
+            std::cout << "开局库生成失败：" << rep.error << std::endl;
+            return 1;
+        }
+        std::cout << "开局库 " << bookPath << "：" << rep.entries << " 个局面（其中 "
+                  << rep.unknown << " 个结论未知），用时 " << rep.seconds << " 秒" << std::endl;
+        return 0;
+    }
+
+    if (puzzleBench) {
+        GameConfig gc = makeConfig(puzzleMode, 1, puzzleShape, false, false, false);
+        PuzzleConfig pc;
+        pc.mode       = gc.winMode;
+        pc.shape      = gc.mapShape;
+        pc.targetPegs = puzzlePegs;
+
+        auto start = std::chrono::steady_clock::now();
+        int reached = 0, verified = 0;
+        Puzzle puzzle;
+        for (int i = 0; i < puzzleCount; ++i) {
+            if (generatePuzzle(pc, seed + static_cast<std::uint64_t>(i) + 1, puzzle)) reached++;
+            if (replayPuzzle(puzzle, pc.mode)) verified++;
+        }
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "生成 " << puzzleCount << " 道，" << reached << " 道达到 " << puzzlePegs
+                  << " 子，回放获胜 " << verified << " 道，每秒 "
+                  << (secs > 0 ? puzzleCount / secs : 0.0) << " 道" << std::endl;
+        return verified == puzzleCount ? 0 : 1;
+    }
+
+    if (benchFrames > 0) {
+        FrameBenchConfig bc;
+        bc.frames = benchFrames;
+        if (seed) bc.seed = seed;
+        return runFrameBenchmark(bc, drawGame, std::cout) ? 0 : 1;
+    }
+
+    if (headless) {
+        if (capacity < 1 || capacity > SessionHost::MaxCapacity) {
+            std::cout << "托管容量须为 1-" << SessionHost::MaxCapacity << "（遥测会话号是 16 位）" << std::endl;
+            return 1;
+        }
+        SessionHost host(capacity);
+        host.setTelemetry(telemetryLog);
+        host.run(std::cin, std::cout);
+        return 0;
+    }
+
+    if (!mapPath.empty()) {
+        MapFile map;
+        if (!map.open(mapPath)) {
+            std::cout << "无法打开地图：" << mapPath << std::endl;
+            return 1;
+        }
+        if (!map.fitsBoard()) {
+            viewMapFile(map);
+            return 0;
+        }
+    }
 
     GameState gameState = GameState::Playing;
     GameRuntime rt(gameState);
+    rt.telemetry = telemetryLog;
+
+    // 有存档先续玩；存档里的对局已经结束就开新局
+    bool resumed = false;
+    if (!savePath.empty()) {
+        std::string error;
+        if (loadGame(savePath, rt, error)) {
+            resumed = anyMove(rt);
+            if (resumed) {
+                std::cout << "已从存档继续：第 " << rt.chain.moves << " 步，剩 "
+                          << rt.pegCount << " 颗棋子" << std::endl;
+            }
+        } else if (std::ifstream(savePath)) {
+            std::cout << "存档无法读取（" << error << "），开新局" << std::endl;
+        }
+    }
 
-    // 控制台获取一局配置
-    GameConfig cfg = askConfigFromConsole();
-    initGame(rt, cfg);
+    if (!resumed) {
+        // 控制台获取一局配置
+        GameConfig cfg = askConfigFromConsole();
+        cfg.mapPath    = mapPath;
+        cfg.seed       = seed;
+        cfg.puzzlePegs = puzzlePegs;
+        cfg.teleports  = teleports;
+        if (puzzlePegs > 0 && cfg.layers > 1) {
+            std::cout << "反向生成只支持单层，本局按普通方式开局" << std::endl;
+        }
+        initGame(rt, cfg);
+    }
+    std::cout << "本局种子：" << rt.seed << "（--seed " << rt.seed << " 可复现这一局）" << std::endl;
+
+    AutoSave autosave;
+    if (!savePath.empty()) {
+        if (autosave.start(savePath)) {
+            rt.autosave = &autosave;
+            autosave.request(rt);
+        } else {
+            std::cout << "无法写入存档：" << savePath << "，本局不自动存档" << std::endl;
+        }
+    }
 
     // 创建窗口（按单层大小来，所有层大小相同）
     sf::RenderWindow window(
@@ -780,85 +865,53 @@ int main() {
         "Peg Solitaire - Multi Layer"
     );
 
-    sf::Clock gameClock;
-
-    while (window.isOpen()) {
+    window.setFramerateLimit(60);
+
+    // 规则、动画计时、结算（含写成绩和参考搜索）都在逻辑线程上，这里只取事件和画最新快照
+    LogicThread logic(rt, gameState);
+    logic.onGameOver = [](GameRuntime& over, bool win) {
+        evaluation(win, over.pegCount, over.moveCount, over.chain.moves, over.gameMode);
+
+        // 参考成绩：对开局做一次短时束搜索
+        BeamConfig bc;
+        bc.timeBudget = 0.5;
+        std::vector<Board> opening;
+        over.history.load(over.historyIds[0], opening);
+        BeamSearch beam(opening, bc, goalForMode(over.gameMode, opening));
+        BeamResult ref = beam.run();
+        std::cout << "参考：开局最少可剩 " << ref.bestPegs << " 颗棋子\n";
+    };
+    logic.start();
+
+    int shownFloor = -1;
+    while (window.isOpen() && !logic.finished()) {
         sf::Event event;
-        float dt = gameClock.restart().asSeconds();
-
-        // 更新动画时间
-        if (rt.isAnimating) {
-            rt.animTime += dt;
-            if (rt.animTime >= rt.animDuration) {
-                rt.animTime   = rt.animDuration;
-                rt.isAnimating = false;
-
-                if (rt.isIceAnimating) {
-                    rt.iceTime = 0.f;
-                }
-            }
-        }
-        if (!rt.isAnimating && rt.isIceAnimating) {
-            rt.iceTime += dt;
-            if (rt.iceTime >= rt.iceDuration) {
-                rt.iceTime        = rt.iceDuration;
-                rt.isIceAnimating = false;
-            }
-        }
-        if (rt.isTeleportAnimating){
-            rt.teleportTime += dt;
-            if (rt.teleportTime >= rt.teleportDuration) {
-                rt.teleportTime = rt.teleportDuration;
-                rt.isTeleportAnimating = false;
-            }
-        }
-
         while (window.pollEvent(event)) {
             if (event.type == sf::Event::Closed) {
                 window.close();
-            }
-            if (gameState == GameState::Playing) {
-                handlePlaying(event, gameState, rt);
+            } else {
+                logic.post(event);
             }
         }
 
-        if (gameState == GameState::Playing) {
-            drawGame(window, rt);
-
-            rt.pegCount = totalPegs(rt);
-            bool hasMoveAll = anyMove(rt);
-
-            // Chess 模式：如果国王全灭，立即失败
-            if (rt.gameMode == GameMode::Chess &&
-                !anyKingAlive(rt) &&
-                !rt.isGameOver) {
-                rt.isGameOver = true;
-                evaluation(false, rt.pegCount, rt.moveCount, rt.gameMode);
-                break;
-            }
-
-            // 没有任何可行步：根据模式判断胜负
-            if (!hasMoveAll && !rt.isGameOver) {
-                rt.isGameOver = true;
-
-                bool win = false;
-                switch (rt.gameMode) {
-                case GameMode::Classic:
-                    win = (rt.pegCount == 1);
-                    break;
-                case GameMode::Lattice:
-                    win = globalGoalWin(rt);
-                    break;
-                case GameMode::Chess:
-                    win = anyKingAlive(rt);
-                    break;
-                }
-
-                evaluation(win, rt.pegCount, rt.moveCount, rt.gameMode);
-                break;
-            }
+        const FrameSnapshot& snap = logic.latest();
+        if (snap.currentFloor != shownFloor && snap.floorCount > 1) {
+            shownFloor = snap.currentFloor;
+            window.setTitle("Peg Solitaire - Floor " + std::to_string(shownFloor + 1) +
+                            "/" + std::to_string(snap.floorCount));
+        }
+        if (snap.playing) {
+            drawGame(window, snap);
+            window.display();
         }
     }
+    logic.stop();
+    autosave.stop();
 
+    if (telemetryLog) {
+        telemetry.stop();
+        std::cout << "遥测：写入 " << telemetry.written() << " 条，丢弃 "
+                  << telemetry.dropped() << " 条" << std::endl;
+    }
     return 0;
 }
@@ -0,0 +1,180 @@
+// 自定义地图文件
+#include "map_file.hpp"
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+struct MapHeader {
+    char          magic[8];     // "PEGMAP01"
+    std::uint32_t rows;
+    std::uint32_t cols;
+    char          reserved[48];
+};
+static_assert(sizeof(MapHeader) == 64, "地图文件头必须是 64 字节");
+
+static const char MAP_MAGIC[8] = {'P','E','G','M','A','P','0','1'};
+static const int  MAX_MAP_SIDE = 1 << 15;
+
+static std::uint8_t packCell(CellState state, CellType type) {
+    return static_cast<std::uint8_t>(static_cast<int>(state) | (static_cast<int>(type) << 2));
+}
+
+// 文件里的字节不一定是 compileMapText 写的：状态和类型都要落在枚举范围内
+static bool validCell(std::uint8_t v) {
+    return (v & 3) <= static_cast<int>(CellState::Peg) &&
+           (v >> 2) <= static_cast<int>(CellType::Teleport);
+}
+
+// 文本字符 → 格子；不认识的字符返回 false
+static bool parseCell(char ch, std::uint8_t& out) {
+    CellState s = CellState::Empty;
+    CellType  t = CellType::Normal;
+    switch (ch) {
+    case ' ': case '-': s = CellState::Invalid;                     break;
+    case 'o': s = CellState::Peg;                                   break;
+    case 'K': s = CellState::Peg;   t = CellType::King;             break;
+    case '.':                                                       break;
+    case '~': t = CellType::Ice;                                    break;
+    case '%': t = CellType::Swamp;                                  break;
+    case '#': t = CellType::Barrier;                                break;
+    case 'G': t = CellType::Goal;                                   break;
+    case '@': t = CellType::Teleport;                               break;
+    case 'i': s = CellState::Peg;   t = CellType::Ice;              break;
+    case 's': s = CellState::Peg;   t = CellType::Swamp;            break;
+    case 'g': s = CellState::Peg;   t = CellType::Goal;             break;
+    case 't': s = CellState::Peg;   t = CellType::Teleport;         break;
+    default:  return false;
+    }
+    out = packCell(s, t);
+    return true;
+}
+
+bool compileMapText(const std::string& textPath, const std::string& binPath, std::string& error) {
+    std::ifstream in(textPath);
+    if (!in) {
+        error = "cannot open " + textPath;
+        return false;
+    }
+
+    std::string line, word;
+    int rows = 0, cols = 0;
+    std::getline(in, line);
+    std::istringstream head(line);
+    if (!(head >> word >> rows >> cols) || word != "PEGMAP" ||
+        rows <= 0 || cols <= 0 || rows > MAX_MAP_SIDE || cols > MAX_MAP_SIDE) {
+        error = "line 1: expected 'PEGMAP <rows> <cols>'";
+        return false;
+    }
+
+    std::ofstream out(binPath, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        error = "cannot write " + binPath;
+        return false;
+    }
+    MapHeader header{};
+    std::memcpy(header.magic, MAP_MAGIC, sizeof(MAP_MAGIC));
+    header.rows = static_cast<std::uint32_t>(rows);
+    header.cols = static_cast<std::uint32_t>(cols);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    // 逐行转换，内存里只放一行
+    std::vector<std::uint8_t> row(cols);
+    for (int r = 0; r < rows; ++r) {
+        if (!std::getline(in, line)) line.clear();
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (static_cast<int>(line.size()) > cols) {
+            error = "line " + std::to_string(r + 2) + ": longer than " + std::to_string(cols);
+            return false;
+        }
+        for (int c = 0; c < cols; ++c) {
+            char ch = (c < static_cast<int>(line.size())) ? line[c] : ' ';
+            if (!parseCell(ch, row[c])) {
+                error = "line " + std::to_string(r + 2) + ": unknown cell '" + ch + "'";
+                return false;
+            }
+        }
+        out.write(reinterpret_cast<const char*>(row.data()), cols);
+    }
+    out.close();
+    if (!out) {
+        error = "write failed: " + binPath;
+        return false;
+    }
+    return true;
+}
+
+// ===== 内存映射读取 =====
+
+bool MapFile::open(const std::string& binPath) {
+    close();
+    if (!file_.openRead(binPath)) return false;
+
+    if (file_.size() < sizeof(MapHeader)) {
+        close();
+        return false;
+    }
+    const auto* header = static_cast<const MapHeader*>(file_.data());
+    std::size_t need = sizeof(MapHeader) +
+                       static_cast<std::size_t>(header->rows) * header->cols;
+    if (std::memcmp(header->magic, MAP_MAGIC, sizeof(MAP_MAGIC)) != 0 ||
+        header->rows == 0 || header->cols == 0 ||
+        header->rows > MAX_MAP_SIDE || header->cols > MAX_MAP_SIDE ||
+        file_.size() < need) {
+        close();
+        return false;
+    }
+    rows_  = static_cast<int>(header->rows);
+    cols_  = static_cast<int>(header->cols);
+    cells_ = static_cast<const std::uint8_t*>(file_.data()) + sizeof(MapHeader);
+
+    // 能进 Board 的小地图打开时逐格检查（最多 49 格）；大地图不整块扫，at / typeAt 把坏格当无效格
+    if (fitsBoard()) {
+        for (int i = 0; i < rows_ * cols_; ++i) {
+            if (!validCell(cells_[i])) {
+                close();
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void MapFile::close() {
+    file_.close();
+    cells_ = nullptr;
+    rows_  = cols_ = 0;
+}
+
+CellState MapFile::at(int r, int c) const {
+    if (r < 0 || r >= rows_ || c < 0 || c >= cols_) return CellState::Invalid;
+    std::uint8_t v = cells_[static_cast<std::size_t>(r) * cols_ + c];
+    return validCell(v) ? static_cast<CellState>(v & 3) : CellState::Invalid;
+}
+
+CellType MapFile::typeAt(int r, int c) const {
+    if (r < 0 || r >= rows_ || c < 0 || c >= cols_) return CellType::Normal;
+    std::uint8_t v = cells_[static_cast<std::size_t>(r) * cols_ + c];
+    return validCell(v) ? static_cast<CellType>(v >> 2) : CellType::Normal;
+}
+
+bool MapFile::inBounds(int r, int c) const {
+    return at(r, c) != CellState::Invalid;
+}
+
+bool MapFile::loadInto(Board& board) const {
+    if (!isOpen() || !fitsBoard()) return false;
+
+    std::uint8_t cells[Board::PackedSize];
+    std::memset(cells, packCell(CellState::Invalid, CellType::Normal), sizeof(cells));
+    int r0 = (Board::Rows - rows_) / 2;
+    int c0 = (Board::Cols - cols_) / 2;
+    // 小地图的每格在 open 时已校验过
+    for (int r = 0; r < rows_; ++r) {
+        for (int c = 0; c < cols_; ++c) {
+            cells[(r0 + r) * Board::Cols + (c0 + c)] = cells_[r * cols_ + c];
+        }
+    }
+    board.unpackCells(cells);
+    return true;
+}
@@ -0,0 +1,45 @@
+#pragma once
+// 自定义地图文件
+//
+// 文本格式（编辑用）：
+//   第一行  PEGMAP <行数> <列数>
+//   之后每行一个棋盘行，每格一个字符（与 --headless 的 show 输出相同）：
+//     空格或 - 无效   o 棋子   K 国王   . 空   ~ 冰   % 沼泽   # 障碍   G 目标   @ 传送
+//     棋子压在特殊格上用小写：i 冰   s 沼泽   g 目标   t 传送
+//   行不够长时右侧补无效格。
+//
+// 二进制格式（加载用）：64 字节文件头 + 每格 1 字节（与 Board::packCells 相同：状态 | 类型 << 2）。
+// 加载时整块内存映射，只有真正访问到的行才会被读入，几百 × 几百的大地图也是即开即用。
+#include "board.hpp"
+#include "mapped_file.hpp"
+#include <cstdint>
+#include <string>
+
+// 文本 → 二进制；失败时 error 给出原因（含行号）
+bool compileMapText(const std::string& textPath, const std::string& binPath, std::string& error);
+
+class MapFile {
+public:
+    // 能放进 Board 的小地图打开时逐格校验，状态 / 类型越界就失败；大地图的坏格读出来是无效格
+    bool open(const std::string& binPath);
+    void close();
+
+    bool isOpen() const { return cells_ != nullptr; }
+    int  rows()   const { return rows_; }
+    int  cols()   const { return cols_; }
+
+    CellState at(int r, int c) const;
+    CellType  typeAt(int r, int c) const;
+    bool      inBounds(int r, int c) const;
+
+    // 能放进 Board 的小地图（不超过 7×7）才能直接开局
+    bool fitsBoard() const { return rows_ <= Board::Rows && cols_ <= Board::Cols; }
+    // 居中放进棋盘，其余格子为无效格
+    bool loadInto(Board& board) const;
+
+private:
+    MappedFile          file_;
+    const std::uint8_t* cells_ = nullptr;
+    int                 rows_  = 0;
+    int                 cols_  = 0;
+};
@@ -0,0 +1,159 @@
+// 内存映射文件
+#include "mapped_file.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+#ifdef _WIN32
+
+static bool mapWindows(const std::string& path, std::size_t size, bool writable,
+                       void*& file, void*& mapping, void*& data, std::size_t& outSize)
+{
+    HANDLE f = CreateFileA(path.c_str(),
+                           writable ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ,
+                           FILE_SHARE_READ | FILE_SHARE_WRITE,
+                           nullptr,
+                           writable ? OPEN_ALWAYS : OPEN_EXISTING,
+                           FILE_ATTRIBUTE_NORMAL,
+                           nullptr);
+    if (f == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER current;
+    if (!GetFileSizeEx(f, &current)) {
+        CloseHandle(f);
+        return false;
+    }
+    std::size_t mapSize = static_cast<std::size_t>(current.QuadPart);
+    if (writable && mapSize < size) mapSize = size;
+    if (mapSize == 0) {
+        CloseHandle(f);
+        return false;
+    }
+
+    // 映射大于文件时，CreateFileMapping 会把文件扩大并补零
+    HANDLE m = CreateFileMappingA(f, nullptr,
+                                  writable ? PAGE_READWRITE : PAGE_READONLY,
+                                  static_cast<DWORD>(static_cast<unsigned long long>(mapSize) >> 32),
+                                  static_cast<DWORD>(mapSize & 0xFFFFFFFFu),
+                                  nullptr);
+    if (!m) {
+        CloseHandle(f);
+        return false;
+    }
+    void* p = MapViewOfFile(m, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, mapSize);
+    if (!p) {
+        CloseHandle(m);
+        CloseHandle(f);
+        return false;
+    }
+    file    = f;
+    mapping = m;
+    data    = p;
+    outSize = mapSize;
+    return true;
+}
+
+bool MappedFile::openRead(const std::string& path) {
+    close();
+    return mapWindows(path, 0, false, file_, mapping_, data_, size_);
+}
+
+bool MappedFile::openReadWrite(const std::string& path, std::size_t size) {
+    close();
+    return mapWindows(path, size, true, file_, mapping_, data_, size_);
+}
+
+void MappedFile::close() {
+    if (data_)    UnmapViewOfFile(data_);
+    if (mapping_) CloseHandle(static_cast<HANDLE>(mapping_));
+    if (file_)    CloseHandle(static_cast<HANDLE>(file_));
+    data_    = nullptr;
+    mapping_ = nullptr;
+    file_    = nullptr;
+    size_    = 0;
+}
+
+void MappedFile::flush() {
+    if (data_) FlushViewOfFile(data_, size_);
+}
+
+#else
+
+bool MappedFile::openRead(const std::string& path) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+    void* p = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+        ::close(fd);
+        return false;
+    }
+    fd_   = fd;
+    data_ = p;
+    size_ = static_cast<std::size_t>(st.st_size);
+    return true;
+}
+
+bool MappedFile::openReadWrite(const std::string& path, std::size_t size) {
+    close();
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+    std::size_t mapSize = static_cast<std::size_t>(st.st_size);
+    if (mapSize < size) {
+        // ftruncate 扩出来的部分读出来都是 0
+        if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            ::close(fd);
+            return false;
+        }
+        mapSize = size;
+    }
+    if (mapSize == 0) {
+        ::close(fd);
+        return false;
+    }
+    void* p = mmap(nullptr, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+        ::close(fd);
+        return false;
+    }
+    fd_   = fd;
+    data_ = p;
+    size_ = mapSize;
+    return true;
+}
+
+void MappedFile::close() {
+    if (data_) munmap(data_, size_);
+    if (fd_ >= 0) ::close(fd_);
+    data_ = nullptr;
+    fd_   = -1;
+    size_ = 0;
+}
+
+void MappedFile::flush() {
+    if (data_) msync(data_, size_, MS_ASYNC);
+}
+
+#endif
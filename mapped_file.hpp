@@ -0,0 +1,36 @@
+#pragma once
+// 内存映射文件（Windows / POSIX 通用）
+#include <cstddef>
+#include <string>
+
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // 只读映射整个文件
+    bool openRead(const std::string& path);
+    // 读写映射；文件不足 size 字节时补零扩到 size（多进程可同时映射同一文件）
+    bool openReadWrite(const std::string& path, std::size_t size);
+    void close();
+
+    bool        isOpen() const { return data_ != nullptr; }
+    void*       data()         { return data_; }
+    const void* data()   const { return data_; }
+    std::size_t size()   const { return size_; }
+
+    void flush();   // 把脏页写回磁盘
+
+private:
+    void*       data_ = nullptr;
+    std::size_t size_ = 0;
+#ifdef _WIN32
+    void* file_    = nullptr;   // HANDLE
+    void* mapping_ = nullptr;   // HANDLE
+#else
+    int   fd_      = -1;
+#endif
+};
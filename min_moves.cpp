@@ -0,0 +1,528 @@
+// 最少步数求解
+#include "min_moves.hpp"
+#include "solver.hpp"
+#include "solver_stats.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+static const int CELLS    = Board::Rows * Board::Cols;
+static const int MAX_HOPS = CELLS - 1;
+static const int INFINITE = 1 << 20;
+
+static int popCount(std::uint64_t m) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(m);
+#else
+    int n = 0;
+    while (m) { m &= m - 1; ++n; }
+    return n;
+#endif
+}
+
+// ===== 棋盘几何：跳跃表、角格、对称 =====
+
+struct MoveGeometry {
+    struct Hop {
+        int over;
+        int to;
+    };
+    Hop           hops[CELLS][4];
+    int           hopCount[CELLS] = {};
+
+    std::uint64_t valid   = 0;
+    std::uint64_t land    = 0;      // 能落子的格（不是障碍）
+    std::uint64_t swamp   = 0;      // 沼泽：棋子不能被选中，连跳到这里就停
+    std::uint64_t corner  = 0;      // 不会被跳过的格
+    std::uint64_t goal    = 0;      // 最后一颗可以停的格
+
+    // 对称：按字节查表，map[s][k][v] 是第 k 个字节取值 v 变换后的掩码
+    int           symCount = 0;
+    std::uint64_t map[8][8][256];
+
+    std::uint64_t canonical(std::uint64_t pegs) const {
+        std::uint64_t best = ~0ULL;
+        for (int s = 0; s < symCount; ++s) {
+            std::uint64_t m = 0;
+            for (int k = 0; k < 7; ++k) {
+                m |= map[s][k][(pegs >> (8 * k)) & 0xFF];
+            }
+            if (m < best) best = m;
+        }
+        return best;
+    }
+};
+
+static int symTarget(int sym, int cell) {
+    // Board::symHash 的逆：变换后的 (r, c) 取原来的 (sr, sc)，这里反过来求原格子去了哪里
+    int r = cell / Board::Cols, c = cell % Board::Cols;
+    int a = (sym & 1) ? Board::Rows - 1 - r : r;
+    int b = (sym & 2) ? Board::Cols - 1 - c : c;
+    return (sym & 4) ? b * Board::Cols + a : a * Board::Cols + b;
+}
+
+static std::uint64_t transformMask(int sym, std::uint64_t mask) {
+    std::uint64_t out = 0;
+    while (mask) {
+        out |= 1ULL << symTarget(sym, popCell(mask));
+    }
+    return out;
+}
+
+static bool buildGeometry(const Board& board, GameMode mode, MoveGeometry& g, std::string& error) {
+    if (mode == GameMode::Chess) {
+        error = "King mode is not supported";
+        return false;
+    }
+    for (int r = 0; r < Board::Rows; ++r) {
+        for (int c = 0; c < Board::Cols; ++c) {
+            if (!board.inBounds(r, c)) continue;
+            std::uint64_t bit = cellBit(r, c);
+            CellType t = board.typeAt(r, c);
+            if (t == CellType::Ice || t == CellType::King || t == CellType::Teleport) {
+                error = "ice, King and teleport tiles are not supported";
+                return false;
+            }
+            g.valid |= bit;
+            if (t != CellType::Barrier) g.land  |= bit;
+            if (t == CellType::Swamp)   g.swamp |= bit;
+            if (mode == GameMode::Classic || t == CellType::Goal) g.goal |= bit;
+        }
+    }
+
+    static const int DR[4] = {-1, 1, 0, 0};
+    static const int DC[4] = {0, 0, -1, 1};
+    std::uint64_t jumpable = 0;
+    for (int i = 0; i < CELLS; ++i) {
+        if (!(g.valid >> i & 1)) continue;
+        int r = i / Board::Cols, c = i % Board::Cols;
+        for (int d = 0; d < 4; ++d) {
+            int rm = r + DR[d], cm = c + DC[d];
+            int rt = r + 2 * DR[d], ct = c + 2 * DC[d];
+            if (rt < 0 || rt >= Board::Rows || ct < 0 || ct >= Board::Cols) continue;
+            int over = rm * Board::Cols + cm, to = rt * Board::Cols + ct;
+            if (!(g.land >> over & 1) || !(g.land >> to & 1)) continue;
+            g.hops[i][g.hopCount[i]++] = {over, to};
+            jumpable |= 1ULL << over;
+        }
+    }
+    g.corner = g.valid & ~jumpable;
+
+    // 只用格子布局也对称的变换
+    for (int s = 0; s < 8; ++s) {
+        if (transformMask(s, g.valid) != g.valid || transformMask(s, g.land) != g.land ||
+            transformMask(s, g.swamp) != g.swamp || transformMask(s, g.goal) != g.goal) {
+            continue;
+        }
+        int slot = g.symCount++;
+        for (int k = 0; k < 8; ++k) {
+            for (int v = 0; v < 256; ++v) {
+                g.map[slot][k][v] = transformMask(s, static_cast<std::uint64_t>(v) << (8 * k) &
+                                                     ((1ULL << CELLS) - 1));
+            }
+        }
+    }
+    return true;
+}
+
+// 还要几步的下界；INFINITE 表示已不可能获胜
+static int lowerBound(const MoveGeometry& g, std::uint64_t pegs) {
+    if (popCount(pegs) <= 1) return (pegs & g.goal) ? 0 : INFINITE;
+
+    std::uint64_t stuck  = pegs & g.corner & g.swamp;     // 既走不了也不会被吃
+    std::uint64_t movers = pegs & g.corner & ~g.swamp;
+    int nStuck = popCount(stuck);
+    if (nStuck > 1 || (nStuck == 1 && !(stuck & g.goal))) return INFINITE;
+
+    int h = popCount(movers);
+    if (nStuck == 0 && (movers & g.goal)) h--;            // 最后留下的可能就是其中一颗
+    return std::max(h, 1);
+}
+
+// ===== 置换表：一个字一个条目，(规范掩码 << 8) | 已证明不够的剩余步数 =====
+
+class MoveTable {
+public:
+    static constexpr int Ways = 4;
+
+    explicit MoveTable(std::size_t bytes) {
+        std::size_t buckets = 1;
+        while (buckets * 2 * Ways * sizeof(std::uint64_t) <= bytes) buckets *= 2;
+        mask_  = buckets - 1;
+        slots_.reset(new std::atomic<std::uint64_t>[buckets * Ways]);
+        for (std::size_t i = 0; i < buckets * Ways; ++i) {
+            slots_[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    int probe(std::uint64_t key) const {
+        const std::atomic<std::uint64_t>* b = bucket(key);
+        for (int i = 0; i < Ways; ++i) {
+            std::uint64_t w = b[i].load(std::memory_order_relaxed);
+            if ((w >> 8) == key) return static_cast<int>(w & 0xFF);
+        }
+        return 0;
+    }
+
+    // 同键留较大的步数；没有时挤掉步数最小的（剩余步数越大，搜索越贵）。返回是否挤掉了别的局面
+    bool store(std::uint64_t key, int budget) {
+        std::atomic<std::uint64_t>* b = bucket(key);
+        std::uint64_t word = (key << 8) | static_cast<std::uint64_t>(std::min(budget, 255));
+        int victim = 0, victimBudget = 256;
+        for (int i = 0; i < Ways; ++i) {
+            std::uint64_t w = b[i].load(std::memory_order_relaxed);
+            if ((w >> 8) == key) {
+                if (static_cast<int>(w & 0xFF) < budget) b[i].store(word, std::memory_order_relaxed);
+                return false;
+            }
+            int wb = w ? static_cast<int>(w & 0xFF) : -1;
+            if (wb < victimBudget) {
+                victim = i;
+                victimBudget = wb;
+            }
+        }
+        b[victim].store(word, std::memory_order_relaxed);
+        return victimBudget >= 0;
+    }
+
+private:
+    std::atomic<std::uint64_t>* bucket(std::uint64_t key) const {
+        std::uint64_t h = key * 0x9E3779B97F4A7C15ULL;
+        return slots_.get() + ((h >> 20) & mask_) * Ways;
+    }
+
+    std::unique_ptr<std::atomic<std::uint64_t>[]> slots_;
+    std::size_t                                   mask_ = 0;
+};
+
+// ===== 一步 = 一串连跳 =====
+
+struct ChainMove {
+    std::uint64_t pegs;             // 走完之后
+    std::uint64_t touched;          // 起点、被跳过的格、各落点
+    int           bound;            // 走完之后的步数下界（排序用）
+    int           hops;
+    std::uint8_t  path[MAX_HOPS + 1];   // 起点 + 每一跳的落点
+
+    int start() const { return path[0]; }
+    int end()   const { return path[hops]; }
+};
+
+static void extendChain(const MoveGeometry& g, std::uint64_t pegs, ChainMove& cur,
+                        std::vector<ChainMove>& out)
+{
+    int from = cur.path[cur.hops];
+    for (int k = 0; k < g.hopCount[from]; ++k) {
+        const MoveGeometry::Hop& h = g.hops[from][k];
+        if (!(pegs >> h.over & 1) || (pegs >> h.to & 1)) continue;
+        std::uint64_t next    = pegs ^ (1ULL << from) ^ (1ULL << h.over) ^ (1ULL << h.to);
+        std::uint64_t touched = cur.touched;
+        cur.path[++cur.hops] = static_cast<std::uint8_t>(h.to);
+        cur.pegs     = next;
+        cur.touched |= (1ULL << h.over) | (1ULL << h.to);
+        out.push_back(cur);
+        if (!(g.swamp >> h.to & 1)) extendChain(g, next, cur, out);
+        cur.hops--;
+        cur.touched = touched;
+    }
+}
+
+// 所有一步可达的子局面；prev 是上一步（根为空），用来去掉与它等价的走法：
+//   从上一步的落点起跳 —— 属于上一步的连跳；
+//   和上一步不碰同一格、起点编号又更小 —— 两步可以交换，只按起点从小到大的顺序搜一次。
+// stats 不为空时记下各条规则去掉了多少
+static void collectChainMoves(const MoveGeometry& g, std::uint64_t pegs, const ChainMove* prev,
+                              std::vector<ChainMove>& out, SolverProbe* stats = nullptr)
+{
+    out.clear();
+    std::uint64_t movable = pegs & ~g.swamp;
+    while (movable) {
+        int from = popCell(movable);
+        if (prev && from == prev->end()) {
+            if (stats) stats->prune(PruneRule::ChainContinue);
+            continue;
+        }
+        ChainMove cur;
+        cur.touched = 1ULL << from;
+        cur.hops    = 0;
+        cur.path[0] = static_cast<std::uint8_t>(from);
+        extendChain(g, pegs, cur, out);
+    }
+    if (prev) {
+        std::size_t before = out.size();
+        out.erase(std::remove_if(out.begin(), out.end(), [prev](const ChainMove& m) {
+            return !(m.touched & prev->touched) && m.start() < prev->start();
+        }), out.end());
+        if (stats) stats->prune(PruneRule::Commute, before - out.size());
+    }
+
+    // 不同连跳走到同一局面、同一落点时只留一个；下界小的先搜，其次剩子少的（链长的）
+    std::sort(out.begin(), out.end(), [](const ChainMove& a, const ChainMove& b) {
+        if (a.pegs != b.pegs) return a.pegs < b.pegs;
+        return a.end() < b.end();
+    });
+    std::size_t before = out.size();
+    out.erase(std::unique(out.begin(), out.end(), [](const ChainMove& a, const ChainMove& b) {
+        return a.pegs == b.pegs && a.end() == b.end();
+    }), out.end());
+    if (stats) stats->prune(PruneRule::Duplicate, before - out.size());
+    for (auto& m : out) {
+        m.bound = lowerBound(g, m.pegs);
+    }
+    std::stable_sort(out.begin(), out.end(), [](const ChainMove& a, const ChainMove& b) {
+        if (a.bound != b.bound) return a.bound < b.bound;
+        return a.hops > b.hops;
+    });
+}
+
+static void appendJumps(const ChainMove& m, std::vector<Jump>& out) {
+    for (int i = 0; i < m.hops; ++i) {
+        Jump j;
+        j.floor = 0;
+        j.r1 = m.path[i] / Board::Cols;
+        j.c1 = m.path[i] % Board::Cols;
+        j.r2 = m.path[i + 1] / Board::Cols;
+        j.c2 = m.path[i + 1] % Board::Cols;
+        out.push_back(j);
+    }
+}
+
+// ===== IDA* =====
+
+struct SharedSearch {
+    const MoveGeometry&     geo;
+    MoveTable&              table;
+    long long               nodeLimit;
+    std::atomic<long long>  nodes{0};
+    std::atomic<bool>       found{false};
+    std::atomic<bool>       aborted{false};
+
+    SharedSearch(const MoveGeometry& g, MoveTable& t, long long limit)
+        : geo(g), table(t), nodeLimit(limit) {}
+};
+
+class MoveSearch {
+public:
+    MoveSearch(SharedSearch& shared, int maxDepth)
+        : shared_(shared), frames_(maxDepth + 2) {}
+
+    // 从 pegs 出发能否在 budget 步内获胜；prev 是走到这里的上一步（根为空），ply 是离根的步数（计数用）。
+    // 找到时 line() 是走法（从这里开始）
+    bool run(std::uint64_t pegs, const ChainMove* prev, int budget, int ply = 0) {
+        line_.clear();
+        ply_ = ply;
+        bool ok = search(pegs, prev, budget, 0);
+        flushNodes();
+        if (ok) std::reverse(line_.begin(), line_.end());
+        return ok;
+    }
+
+    const std::vector<ChainMove>& line() const { return line_; }
+
+private:
+    bool search(std::uint64_t pegs, const ChainMove* prev, int budget, int depth) {
+        if (++localNodes_ >= 4096) flushNodes();
+        if (shared_.found.load(std::memory_order_relaxed) ||
+            shared_.aborted.load(std::memory_order_relaxed)) {
+            return false;
+        }
+
+        stats_.node(ply_ + depth);
+        if (popCount(pegs) == 1) return (pegs & shared_.geo.goal) != 0;
+        if (lowerBound(shared_.geo, pegs) > budget) {
+            stats_.prune(PruneRule::LowerBound);
+            return false;
+        }
+
+        // 只剩一步时直接看有没有一串连跳走完，不值得查表
+        bool useTable = budget > 1;
+        std::uint64_t key = 0;
+        if (useTable) {
+            key = shared_.geo.canonical(pegs);
+            if (shared_.table.probe(key) >= budget) {
+                stats_.tableHit();
+                stats_.prune(PruneRule::TableDead);
+                return false;
+            }
+            stats_.tableMiss();
+        }
+
+        std::vector<ChainMove>& children = frames_[depth];
+        collectChainMoves(shared_.geo, pegs, prev, children, &stats_);
+        stats_.children(ply_ + depth, static_cast<int>(children.size()));
+        for (std::size_t i = 0; i < children.size(); ++i) {
+            const ChainMove& m = children[i];
+            if (m.bound > budget - 1) {         // 按下界排好序，后面的都不够
+                stats_.prune(PruneRule::BoundOrder, children.size() - i);
+                break;
+            }
+            if (search(m.pegs, &m, budget - 1, depth + 1)) {
+                line_.push_back(m);
+                return true;
+            }
+        }
+        // 被别的线程打断时结论不完整，不能记
+        if (shared_.found.load(std::memory_order_relaxed) ||
+            shared_.aborted.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        if (useTable) stats_.tableStore(shared_.table.store(key, budget));
+        return false;
+    }
+
+    void flushNodes() {
+        long long total = shared_.nodes.fetch_add(localNodes_, std::memory_order_relaxed) + localNodes_;
+        localNodes_ = 0;
+        if (shared_.nodeLimit > 0 && total > shared_.nodeLimit) {
+            shared_.aborted.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    SharedSearch&                       shared_;
+    std::vector<std::vector<ChainMove>> frames_;    // 每层递归复用自己的子局面表
+    std::vector<ChainMove>              line_;
+    long long                           localNodes_ = 0;
+    int                                 ply_        = 0;
+    SolverProbe                         stats_{"min_moves"};
+};
+
+// 根附近按步展开（对称去重），直到子局面够分给各线程；每项带着从根走来的路径
+struct FrontierItem {
+    std::uint64_t          pegs;
+    std::vector<ChainMove> path;
+
+    const ChainMove* prev() const { return path.empty() ? nullptr : &path.back(); }
+    int              end()  const { return path.empty() ? -1 : path.back().end(); }
+};
+
+static std::vector<FrontierItem> splitFrontier(const MoveGeometry& g, std::uint64_t root,
+                                               int maxDepth, std::size_t want)
+{
+    std::vector<FrontierItem> frontier{{root, {}}};
+    std::vector<ChainMove> children;
+    for (int depth = 0; depth < maxDepth && frontier.size() < want; ++depth) {
+        std::vector<FrontierItem> next;
+        for (const auto& item : frontier) {
+            if (popCount(item.pegs) == 1) {     // 已经走完，原样留到下一层
+                next.push_back(item);
+                continue;
+            }
+            collectChainMoves(g, item.pegs, item.prev(), children);
+            for (const auto& m : children) {
+                next.push_back({m.pegs, item.path});
+                next.back().path.push_back(m);
+            }
+        }
+        if (next.empty()) break;
+        // 同一规范局面 + 同一落点只留第一条路径
+        std::stable_sort(next.begin(), next.end(), [&g](const FrontierItem& a, const FrontierItem& b) {
+            std::uint64_t ka = g.canonical(a.pegs), kb = g.canonical(b.pegs);
+            return ka != kb ? ka < kb : a.end() < b.end();
+        });
+        next.erase(std::unique(next.begin(), next.end(), [&g](const FrontierItem& a, const FrontierItem& b) {
+            return a.pegs == b.pegs && a.end() == b.end();
+        }), next.end());
+        frontier.swap(next);
+    }
+    return frontier;
+}
+
+// ===== 入口 =====
+
+MinMoveReport solveMinMoves(const Board& start, GameMode mode, const MinMoveConfig& cfg) {
+    auto startTime = std::chrono::steady_clock::now();
+    MinMoveReport report;
+
+    std::unique_ptr<MoveGeometry> geo(new MoveGeometry());
+    if (!buildGeometry(start, mode, *geo, report.error)) return report;
+    report.ok = true;
+
+    std::uint64_t root = 0;
+    for (int r = 0; r < Board::Rows; ++r) {
+        for (int c = 0; c < Board::Cols; ++c) {
+            if (start.inBounds(r, c) && start.at(r, c) == CellState::Peg) root |= cellBit(r, c);
+        }
+    }
+    int pegs = popCount(root);
+    if (pegs <= 1) {
+        report.solved = (root & geo->goal) != 0;
+        report.moves  = 0;
+        report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        return report;
+    }
+
+    int threads = cfg.threads;
+    if (threads <= 0) {
+        threads = static_cast<int>(std::thread::hardware_concurrency());
+        if (threads <= 0) threads = 1;
+    }
+    int maxMoves = cfg.maxMoves > 0 ? std::min(cfg.maxMoves, pegs - 1) : pegs - 1;
+
+    MoveTable    table(cfg.memoryBytes ? cfg.memoryBytes : solverMemoryBudget());
+    SharedSearch shared(*geo, table, cfg.nodeLimit);
+
+    // 分给各线程的子局面（一两步之内），每轮都用同一批
+    std::vector<FrontierItem> frontier;
+    if (threads > 1) {
+        frontier = splitFrontier(*geo, root, 2, static_cast<std::size_t>(threads) * 16);
+    }
+
+    int bound = lowerBound(*geo, root);
+    for (; bound <= maxMoves; ++bound) {
+        long long before = shared.nodes.load();
+        std::vector<ChainMove> line;
+
+        if (frontier.empty()) {
+            MoveSearch search(shared, maxMoves);
+            if (search.run(root, nullptr, bound)) line = search.line();
+        } else {
+            std::atomic<std::size_t> nextIndex{0};
+            std::mutex               lineMutex;
+            std::vector<std::thread> pool;
+            for (int t = 0; t < threads; ++t) {
+                pool.emplace_back([&] {
+                    MoveSearch search(shared, maxMoves);
+                    for (;;) {
+                        std::size_t i = nextIndex.fetch_add(1, std::memory_order_relaxed);
+                        if (i >= frontier.size()) break;
+                        const FrontierItem& item = frontier[i];
+                        int left = bound - static_cast<int>(item.path.size());
+                        if (left < 0) continue;
+                        if (!search.run(item.pegs, item.prev(), left,
+                                        static_cast<int>(item.path.size()))) continue;
+
+                        std::lock_guard<std::mutex> lock(lineMutex);
+                        if (shared.found.exchange(true)) break;
+                        line = item.path;
+                        line.insert(line.end(), search.line().begin(), search.line().end());
+                        break;
+                    }
+                });
+            }
+            for (auto& th : pool) th.join();
+        }
+        report.iterationNodes.push_back(shared.nodes.load() - before);
+
+        if (!line.empty()) {
+            report.solved = true;
+            report.moves  = static_cast<int>(line.size());
+            for (const auto& m : line) {
+                report.line.emplace_back();
+                appendJumps(m, report.line.back());
+            }
+            break;
+        }
+        if (shared.aborted.load()) {
+            report.aborted = true;
+            break;
+        }
+    }
+    if (!report.solved) report.moves = bound;   // 已证明至少要这么多步（无解时超出上限）
+
+    report.nodes   = shared.nodes.load();
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    return report;
+}
@@ -0,0 +1,35 @@
+#pragma once
+// 最少步数求解：经典计步（同一颗棋子连续跳跃算一步）下的最优解，迭代加深 A*（IDA*）
+//
+// 单层棋盘压成 49 位棋子掩码。一“步”是一颗棋子的一串连跳，停在链上任何一处都是一个子局面。
+// 下界：角格（任何方向都不会被跳过的格子）上的棋子只能自己走开，每颗至少占一步，最后留下的那颗除外。
+// 剪枝：下一步不从上一步的落点起跳（那属于上一步的连跳），与上一步互不相碰的两步只按一种顺序搜；
+// 置换表按对称归一的棋子掩码记“剩 d 步不够”，跨轮保留。
+// 并行：每一轮把根展开成一批子局面，各线程从共享队列领取，置换表共享，有人找到就全部停下。
+#include "board.hpp"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+struct MinMoveConfig {
+    int         threads     = 0;    // 0 = 按 CPU 核数
+    int         maxMoves    = 0;    // 步数上限，0 = 棋子数 - 1
+    long long   nodeLimit   = 0;    // 0 = 不限
+    std::size_t memoryBytes = 0;    // 置换表大小，0 用 solverMemoryBudget()
+};
+
+struct MinMoveReport {
+    bool        ok      = false;    // 局面受支持（单层，无冰格、国王、传送格）
+    std::string error;
+    bool        solved  = false;
+    bool        aborted = false;    // 超出节点上限，步数下限未证实
+    int         moves   = -1;       // 最少步数；未解出时为已证明的下限
+    std::vector<std::vector<Jump>> line;            // 每步一串连跳
+    std::vector<long long>         iterationNodes;  // 每一轮（步数上限从小到大）的节点数
+    long long   nodes   = 0;
+    double      seconds = 0.0;
+};
+
+// 胜利条件与 goalForMode 相同：传统模式剩一颗，目标模式剩一颗且在 Goal 上
+MinMoveReport solveMinMoves(const Board& start, GameMode mode,
+                            const MinMoveConfig& cfg = MinMoveConfig());
@@ -0,0 +1,335 @@
+// 开局库
+#include "opening_book.hpp"
+#include "solve_cache.hpp"
+#include "solver.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <ostream>
+#include <unordered_map>
+
+struct BookHeader {
+    char          magic[8];     // "PEGBOK01"
+    std::uint32_t version;
+    std::uint32_t depth;
+    std::uint64_t count;
+    char          reserved[40];
+};
+static_assert(sizeof(BookHeader) == 64, "开局库文件头必须是 64 字节");
+
+// 走法：规范朝向下的起点格 * 4 + 方向（上、下、左、右）
+struct BookEntry {
+    std::uint64_t key;
+    std::uint8_t  outcome;      // 0 未知 / 1 无解 / 2 有解
+    std::int8_t   bestPegs;     // -1 未知
+    std::uint8_t  moveCount;
+    std::uint8_t  reserved;
+    std::uint8_t  moves[BookHit::MaxMoves];
+};
+static_assert(sizeof(BookEntry) == 16, "开局库条目必须是 16 字节");
+
+static const char          BOOK_MAGIC[8] = {'P','E','G','B','O','K','0','1'};
+static const std::uint32_t BOOK_VERSION  = 1;
+
+enum : std::uint8_t {
+    OUTCOME_UNKNOWN = 0,
+    OUTCOME_LOSE    = 1,
+    OUTCOME_WIN     = 2
+};
+
+static const int DIR_R[4] = {-2, 2, 0, 0};
+static const int DIR_C[4] = {0, 0, -2, 2};
+
+// ===== 对称朝向 =====
+//
+// 与 Board::symHash 一致：变换后的 (r, c) 取原棋盘的 src(r, c)。
+// 规范朝向是让多层哈希最小的那个变换（相同时取编号小的）。
+
+static int canonicalSym(const std::vector<Board>& floors) {
+    int bestSym = 0;
+    std::uint64_t best = 0;
+    for (int s = 0; s < 8; ++s) {
+        std::uint64_t h = 0;
+        for (const auto& b : floors) {
+            h = (h ^ b.symHash(s)) * 0x9E3779B97F4A7C15ULL;
+        }
+        if (s == 0 || h < best) {
+            best = h;
+            bestSym = s;
+        }
+    }
+    return bestSym;
+}
+
+// 规范朝向 → 当前朝向
+static void fromCanonical(int sym, int r, int c, int& outR, int& outC) {
+    outR = (sym & 4) ? c : r;
+    outC = (sym & 4) ? r : c;
+    if (sym & 1) outR = Board::Rows - 1 - outR;
+    if (sym & 2) outC = Board::Cols - 1 - outC;
+}
+
+// 当前朝向 → 规范朝向
+static void toCanonical(int sym, int r, int c, int& outR, int& outC) {
+    int a = (sym & 1) ? Board::Rows - 1 - r : r;
+    int b = (sym & 2) ? Board::Cols - 1 - c : c;
+    outR = (sym & 4) ? b : a;
+    outC = (sym & 4) ? a : b;
+}
+
+static std::uint8_t encodeMove(int sym, const Jump& j) {
+    int r1, c1, r2, c2;
+    toCanonical(sym, j.r1, j.c1, r1, c1);
+    toCanonical(sym, j.r2, j.c2, r2, c2);
+    int dir = 0;
+    while (dir < 3 && !(r2 - r1 == DIR_R[dir] && c2 - c1 == DIR_C[dir])) ++dir;
+    return static_cast<std::uint8_t>((r1 * Board::Cols + c1) * 4 + dir);
+}
+
+static Jump decodeMove(int sym, std::uint8_t code) {
+    int cell = code / 4, dir = code % 4;
+    int r1 = cell / Board::Cols, c1 = cell % Board::Cols;
+    Jump j;
+    j.floor = 0;
+    fromCanonical(sym, r1, c1, j.r1, j.c1);
+    fromCanonical(sym, r1 + DIR_R[dir], c1 + DIR_C[dir], j.r2, j.c2);
+    return j;
+}
+
+// ===== 生成 =====
+
+struct BookResult {
+    std::uint8_t outcome  = OUTCOME_UNKNOWN;
+    int          bestPegs = -1;
+};
+
+// 一种开局：按层展开，最深一层之后求解，再逐层往回推
+static void buildForStart(GameMode mode, MapShape shape, const BookBuildConfig& cfg,
+                          std::vector<BookEntry>& out, long long& unknown)
+{
+    std::vector<Board> root{Board(mode, shape, SpecialConfig())};
+    SolveGoal goal = goalForMode(mode, root);
+
+    std::vector<std::vector<std::vector<Board>>> levels{{root}};
+    std::unordered_map<std::uint64_t, BookResult> results;
+    results[SolveCache::keyFor(mode, root)];
+
+    std::vector<Jump> jumps;
+    for (int depth = 0; depth <= cfg.depth; ++depth) {
+        std::vector<std::vector<Board>> next;
+        for (const auto& pos : levels[depth]) {
+            collectFloorJumps(pos, jumps);
+            for (const auto& j : jumps) {
+                std::vector<Board> child = pos;
+                MoveResult mv;
+                applyFloorMove(child, j.floor, j.r1, j.c1, j.r2, j.c2, mv);
+                if (goal.isDead && goal.isDead(child, mv)) continue;
+                if (results.emplace(SolveCache::keyFor(mode, child), BookResult()).second) {
+                    next.push_back(std::move(child));
+                }
+            }
+        }
+        levels.push_back(std::move(next));
+    }
+
+    // 最深一层：逐个求解。同一个 Solver 的死局表跨局面保留，越算越快
+    Solver solver(goal, cfg.leafNodes);
+    for (const auto& pos : levels.back()) {
+        SolveResult res = solver.solve(pos);
+        BookResult& r = results[SolveCache::keyFor(mode, pos)];
+        if (res.solved) {
+            r.outcome  = OUTCOME_WIN;
+            r.bestPegs = res.bestPegs;
+        } else if (!res.aborted) {
+            r.outcome  = OUTCOME_LOSE;
+            r.bestPegs = res.bestPegs;
+        }
+    }
+
+    // 往回推：能赢的子局面优先，其次剩子最少；都不知道时记为未知
+    for (int depth = cfg.depth; depth >= 0; --depth) {
+        for (const auto& pos : levels[depth]) {
+            std::uint64_t key = SolveCache::keyFor(mode, pos);
+            int sym = canonicalSym(pos);
+
+            struct Candidate {
+                Jump       move;
+                BookResult result;
+            };
+            std::vector<Candidate> cands;
+            collectFloorJumps(pos, jumps);
+            for (const auto& j : jumps) {
+                std::vector<Board> child = pos;
+                MoveResult mv;
+                applyFloorMove(child, j.floor, j.r1, j.c1, j.r2, j.c2, mv);
+                if (goal.isDead && goal.isDead(child, mv)) continue;
+                cands.push_back({j, results[SolveCache::keyFor(mode, child)]});
+            }
+
+            BookResult& r = results[key];
+            if (jumps.empty()) {
+                r.outcome  = goal.isWin(pos) ? OUTCOME_WIN : OUTCOME_LOSE;
+                r.bestPegs = floorsPegs(pos);
+            } else {
+                bool anyWin = false, anyUnknown = false;
+                int best = -1;
+                for (const auto& c : cands) {
+                    if (c.result.outcome == OUTCOME_WIN)     anyWin = true;
+                    if (c.result.outcome == OUTCOME_UNKNOWN) anyUnknown = true;
+                    if (c.result.bestPegs >= 0 && (best < 0 || c.result.bestPegs < best)) {
+                        best = c.result.bestPegs;
+                    }
+                }
+                r.outcome  = anyWin ? OUTCOME_WIN : (anyUnknown ? OUTCOME_UNKNOWN : OUTCOME_LOSE);
+                r.bestPegs = (r.outcome == OUTCOME_UNKNOWN) ? -1 : best;
+            }
+
+            std::stable_sort(cands.begin(), cands.end(), [](const Candidate& a, const Candidate& b) {
+                if (a.result.outcome != b.result.outcome) {
+                    // 有解 > 无解 > 未知
+                    auto rank = [](std::uint8_t o) { return o == OUTCOME_WIN ? 0 : (o == OUTCOME_LOSE ? 1 : 2); };
+                    return rank(a.result.outcome) < rank(b.result.outcome);
+                }
+                int pa = a.result.bestPegs < 0 ? 1 << 20 : a.result.bestPegs;
+                int pb = b.result.bestPegs < 0 ? 1 << 20 : b.result.bestPegs;
+                return pa < pb;
+            });
+
+            BookEntry e{};
+            e.key      = key;
+            e.outcome  = r.outcome;
+            e.bestPegs = static_cast<std::int8_t>(r.bestPegs);
+            for (const auto& c : cands) {
+                if (e.moveCount == BookHit::MaxMoves) break;
+                if (c.result.outcome == OUTCOME_UNKNOWN) break;
+                if (r.outcome == OUTCOME_WIN && c.result.outcome != OUTCOME_WIN) break;
+                if (r.outcome == OUTCOME_LOSE && c.result.bestPegs != r.bestPegs) break;
+                e.moves[e.moveCount++] = encodeMove(sym, c.move);
+            }
+            if (e.outcome == OUTCOME_UNKNOWN) unknown++;
+            out.push_back(e);
+        }
+    }
+}
+
+BookBuildReport buildOpeningBook(const std::string& path, const BookBuildConfig& cfg,
+                                 std::ostream* progress)
+{
+    auto start = std::chrono::steady_clock::now();
+    BookBuildReport report;
+
+    static const GameMode MODES[]  = {GameMode::Classic, GameMode::Lattice, GameMode::Chess};
+    static const MapShape SHAPES[] = {MapShape::Cross, MapShape::BigCross,
+                                      MapShape::Triangle, MapShape::Diamond};
+    std::vector<BookEntry> entries;
+    for (MapShape shape : SHAPES) {
+        for (GameMode mode : MODES) {
+            std::size_t before = entries.size();
+            long long   unknownBefore = report.unknown;
+            buildForStart(mode, shape, cfg, entries, report.unknown);
+            if (progress) {
+                *progress << "book shape=" << static_cast<int>(shape) + 1
+                          << " mode=" << static_cast<int>(mode) + 1
+                          << " positions=" << entries.size() - before
+                          << " unknown=" << report.unknown - unknownBefore << std::endl;
+            }
+        }
+    }
+
+    // 不同开局之间的键不会相同（布局不同），保险起见仍去重
+    std::sort(entries.begin(), entries.end(),
+              [](const BookEntry& a, const BookEntry& b) { return a.key < b.key; });
+    entries.erase(std::unique(entries.begin(), entries.end(),
+                              [](const BookEntry& a, const BookEntry& b) { return a.key == b.key; }),
+                  entries.end());
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        report.error = "cannot write " + path;
+        return report;
+    }
+    BookHeader header{};
+    std::memcpy(header.magic, BOOK_MAGIC, sizeof(BOOK_MAGIC));
+    header.version = BOOK_VERSION;
+    header.depth   = static_cast<std::uint32_t>(cfg.depth);
+    header.count   = entries.size();
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(entries.data()),
+              static_cast<std::streamsize>(entries.size() * sizeof(BookEntry)));
+    if (!out) {
+        report.error = "write failed: " + path;
+        return report;
+    }
+
+    report.ok      = true;
+    report.entries = static_cast<long long>(entries.size());
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return report;
+}
+
+// ===== 查找 =====
+
+bool OpeningBook::open(const std::string& path) {
+    close();
+    if (!file_.openRead(path)) return false;
+
+    BookHeader header;
+    if (file_.size() < sizeof(header)) {
+        close();
+        return false;
+    }
+    std::memcpy(&header, file_.data(), sizeof(header));
+    if (std::memcmp(header.magic, BOOK_MAGIC, sizeof(BOOK_MAGIC)) != 0 ||
+        header.version != BOOK_VERSION ||
+        file_.size() != sizeof(header) + header.count * sizeof(BookEntry)) {
+        close();
+        return false;
+    }
+    entries_ = reinterpret_cast<const BookEntry*>(
+        static_cast<const char*>(file_.data()) + sizeof(header));
+    count_ = static_cast<std::size_t>(header.count);
+    return true;
+}
+
+void OpeningBook::close() {
+    file_.close();
+    entries_ = nullptr;
+    count_   = 0;
+}
+
+bool OpeningBook::lookup(GameMode mode, const std::vector<Board>& floors, BookHit& out) const {
+    if (!entries_ || count_ == 0 || floors.size() != 1) return false;
+    std::uint64_t key = SolveCache::keyFor(mode, floors);
+
+    // 插值查找：键是均匀的哈希，通常两三步就到；区间变小或步数过多时改用二分
+    std::size_t lo = 0, hi = count_;     // [lo, hi)
+    for (int step = 0; step < 8 && hi - lo > 16; ++step) {
+        std::uint64_t kLo = entries_[lo].key;
+        std::uint64_t kHi = entries_[hi - 1].key;
+        if (key < kLo || key > kHi) return false;
+        if (kHi == kLo) break;
+        double frac = static_cast<double>(key - kLo) / static_cast<double>(kHi - kLo);
+        std::size_t mid = lo + static_cast<std::size_t>(frac * static_cast<double>(hi - 1 - lo));
+        if (mid >= hi) mid = hi - 1;
+        if (entries_[mid].key == key) {
+            lo = mid;
+            hi = mid + 1;
+            break;
+        }
+        if (entries_[mid].key < key) lo = mid + 1;
+        else                         hi = mid;
+    }
+    const BookEntry* it = std::lower_bound(entries_ + lo, entries_ + hi, key,
+                                           [](const BookEntry& e, std::uint64_t k) { return e.key < k; });
+    if (it == entries_ + hi || it->key != key || it->outcome == OUTCOME_UNKNOWN) return false;
+
+    int sym = canonicalSym(floors);
+    out.solvable  = (it->outcome == OUTCOME_WIN);
+    out.bestPegs  = it->bestPegs;
+    out.moveCount = it->moveCount;
+    for (int i = 0; i < it->moveCount; ++i) {
+        out.moves[i] = decodeMove(sym, it->moves[i]);
+    }
+    return true;
+}
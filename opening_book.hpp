@@ -0,0 +1,58 @@
+#pragma once
+// 开局库：标准开局（单层、无特殊格、不挖洞，即 Board::reset 的原始形状）前几步的结论和最佳走法
+//
+// 离线生成：每种形状 × 规则，从开局按层展开到 depth 步（对称去重），再深一层的局面交给 Solver，
+// 然后逐层往回推：有一个子局面能赢就能赢；每个局面最多记 4 个最佳走法（能赢的在前，其次剩子最少）。
+// 文件：64 字节文件头 + 按键排序的 16 字节条目，整块内存映射，用插值查找（键是均匀分布的哈希）。
+// 键与持久求解缓存相同（对称归一 + 规则），走法按规范朝向存，查到后再变换回当前朝向。
+#include "board.hpp"
+#include "mapped_file.hpp"
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+struct BookHit {
+    static constexpr int MaxMoves = 4;
+
+    bool solvable  = false;
+    int  bestPegs  = -1;        // 能走到的最少棋子数，未知为 -1
+    int  moveCount = 0;
+    Jump moves[MaxMoves];       // 当前朝向下的走法，最好的在前
+};
+
+struct BookBuildConfig {
+    int       depth     = 4;            // 收录开局后 0..depth 步的局面
+    long long leafNodes = 2000000;      // 最深一层之后每个局面的求解节点上限，超出记为未知
+};
+
+struct BookBuildReport {
+    bool        ok       = false;
+    std::string error;
+    long long   entries  = 0;
+    long long   unknown  = 0;           // 求解超限、结论未知的条目
+    double      seconds  = 0.0;
+};
+
+// 生成开局库文件；progress 不为空时每种开局输出一行进度
+BookBuildReport buildOpeningBook(const std::string& path, const BookBuildConfig& cfg,
+                                 std::ostream* progress = nullptr);
+
+struct BookEntry;   // 文件里的条目，定义在 opening_book.cpp
+
+class OpeningBook {
+public:
+    bool open(const std::string& path);
+    void close();
+
+    bool        isOpen() const { return entries_ != nullptr; }
+    std::size_t size()   const { return count_; }
+
+    // 只收录单层局面；结论未知的条目当作未命中
+    bool lookup(GameMode mode, const std::vector<Board>& floors, BookHit& out) const;
+
+private:
+    MappedFile       file_;
+    const BookEntry* entries_ = nullptr;
+    std::size_t      count_   = 0;
+};
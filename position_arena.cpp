@@ -0,0 +1,294 @@
+// 结构数组式局面仓库
+#include "position_arena.hpp"
+#include <cstdlib>
+
+static const int CELLS   = Board::Rows * Board::Cols;
+static const int NO_KING = 127;
+
+static int popcount64(std::uint64_t x) {
+    int n = 0;
+    while (x) {
+        x &= x - 1;
+        ++n;
+    }
+    return n;
+}
+
+// ===== 布局 =====
+
+std::shared_ptr<const TileLayout> TileLayout::fromFloors(const std::vector<Board>& floors) {
+    auto layout = std::make_shared<TileLayout>();
+    layout->assign(floors);
+    return layout;
+}
+
+void TileLayout::assign(const std::vector<Board>& floors) {
+    base  = floors;
+    kings = false;
+    valid.clear();
+    for (const auto& b : floors) {
+        std::uint64_t mask = 0;
+        for (int i = 0; i < CELLS; ++i) {
+            int r = i / Board::Cols, c = i % Board::Cols;
+            if (b.inBounds(r, c)) mask |= 1ULL << i;
+            if (b.typeAt(r, c) == CellType::King) kings = true;
+        }
+        valid.push_back(mask);
+    }
+}
+
+// ===== 视图 =====
+
+CellState PositionView::at(int r, int c) const {
+    int i = r * Board::Cols + c;
+    if (!((layout_->valid[floor_] >> i) & 1)) return CellState::Invalid;
+    return ((pegs_ >> i) & 1) ? CellState::Peg : CellState::Empty;
+}
+
+CellType PositionView::typeAt(int r, int c) const {
+    if (layout_->kings) {
+        int i = r * Board::Cols + c;
+        if (static_cast<int>(extra_ >> 56) == i) return CellType::King;
+        if ((extra_ >> i) & 1)                   return CellType::Normal;
+    }
+    return layout_->base[floor_].typeAt(r, c);
+}
+
+bool PositionView::inBounds(int r, int c) const {
+    if (r < 0 || r >= Board::Rows || c < 0 || c >= Board::Cols) return false;
+    return (layout_->valid[floor_] >> (r * Board::Cols + c)) & 1;
+}
+
+// 与 Board::canJump 相同的规则
+bool PositionView::canJump(int r1, int c1, int r2, int c2) const {
+    if (!inBounds(r1, c1) || !inBounds(r2, c2)) return false;
+
+    if (at(r1, c1) != CellState::Peg)   return false;
+    if (at(r2, c2) != CellState::Empty) return false;
+
+    if (typeAt(r2, c2) == CellType::Barrier) return false;
+
+    int dr = r2 - r1;
+    int dc = c2 - c1;
+    if (!((std::abs(dr) == 2 && dc == 0) ||
+          (std::abs(dc) == 2 && dr == 0))) {
+        return false;
+    }
+
+    int rm = r1 + dr / 2;
+    int cm = c1 + dc / 2;
+    if (!inBounds(rm, cm)) return false;
+    if (at(rm, cm) != CellState::Peg) return false;
+    if (typeAt(rm, cm) == CellType::Barrier) return false;
+
+    return true;
+}
+
+bool PositionView::canMove(int r, int c) const {
+    static const int dr[4] = {-2, 2, 0, 0};
+    static const int dc[4] = {0, 0, -2, 2};
+    for (int k = 0; k < 4; ++k) {
+        if (canJump(r, c, r + dr[k], c + dc[k])) return true;
+    }
+    return false;
+}
+
+bool PositionView::hasMove() const {
+    std::uint64_t bits = pegs_;
+    for (int i = 0; bits; ++i, bits >>= 1) {
+        if ((bits & 1) && canMove(i / Board::Cols, i % Board::Cols)) return true;
+    }
+    return false;
+}
+
+int PositionView::countPegs() const {
+    return popcount64(pegs_);
+}
+
+// ===== 仓库 =====
+
+PositionArena::PositionArena(std::size_t chunkPositions)
+    : chunkSize_(chunkPositions > 0 ? chunkPositions : 1)
+{
+}
+
+void PositionArena::reset(std::shared_ptr<const TileLayout> layout) {
+    int columns = 0;
+    if (layout) {
+        int floors = static_cast<int>(layout->base.size());
+        columns = layout->kings ? floors * 2 : floors;
+    }
+    // 列数不变时留着第一块，频繁重开的撤销栈不用重新分配
+    if (columns != columns_ && !chunks_.empty()) chunks_.clear();
+    if (chunks_.size() > 1) chunks_.resize(1);
+    if (!chunks_.empty()) chunks_[0].live = 0;
+
+    layout_  = std::move(layout);
+    columns_ = columns;
+    next_    = 0;
+    live_    = 0;
+}
+
+void PositionArena::resetFrom(const std::vector<Board>& floors) {
+    // 布局都由 fromFloors 建成（非 const 对象），没有别人持有时可以直接改
+    if (layout_ && layout_.use_count() == 1) {
+        std::const_pointer_cast<TileLayout>(layout_)->assign(floors);
+        reset(std::move(layout_));
+    } else {
+        reset(TileLayout::fromFloors(floors));
+    }
+}
+
+void PositionArena::clear() {
+    reset(layout_);
+}
+
+std::uint64_t* PositionArena::column(Index i, int col) {
+    Chunk& ch = chunks_[i / chunkSize_];
+    return ch.words.get() + col * chunkSize_ + i % chunkSize_;
+}
+
+const std::uint64_t* PositionArena::column(Index i, int col) const {
+    const Chunk& ch = chunks_[i / chunkSize_];
+    return ch.words.get() + col * chunkSize_ + i % chunkSize_;
+}
+
+void PositionArena::claim(Index i) {
+    std::size_t c = i / chunkSize_;
+    if (c >= chunks_.size()) chunks_.resize(c + 1);
+    Chunk& ch = chunks_[c];
+    if (!ch.words) ch.words.reset(new std::uint64_t[columns_ * chunkSize_]);
+    ch.live++;
+    live_++;
+}
+
+void PositionArena::storeFloor(Index i, int f, const Board& b) {
+    const Board& t = layout_->base[f];
+    std::uint64_t pegs = 0, trail = 0;
+    int king = NO_KING;
+    for (int k = 0; k < CELLS; ++k) {
+        int r = k / Board::Cols, cc = k % Board::Cols;
+        if (b.at(r, cc) == CellState::Peg) pegs |= 1ULL << k;
+        if (!layout_->kings) continue;
+        CellType type = b.typeAt(r, cc);
+        if (type == CellType::King)      king = k;
+        else if (type != t.typeAt(r, cc)) trail |= 1ULL << k;
+    }
+    *column(i, f) = pegs;
+    if (layout_->kings) {
+        const int floorCount = static_cast<int>(layout_->base.size());
+        *column(i, floorCount + f) = trail | (static_cast<std::uint64_t>(king) << 56);
+    }
+}
+
+void PositionArena::store(Index i, const std::vector<Board>& floors) {
+    claim(i);
+    const int floorCount = static_cast<int>(layout_->base.size());
+    for (int f = 0; f < floorCount; ++f) {
+        storeFloor(i, f, floors[f]);
+    }
+}
+
+PositionArena::Index PositionArena::append(const std::vector<Board>& floors) {
+    Index i = static_cast<Index>(next_++);
+    store(i, floors);
+    return i;
+}
+
+PositionArena::Index PositionArena::appendFrom(Index prev, const std::vector<Board>& floors,
+                                               const int* changed, int count)
+{
+    Index i = static_cast<Index>(next_++);
+    claim(i);
+    for (int col = 0; col < columns_; ++col) {
+        *column(i, col) = *column(prev, col);
+    }
+    for (int k = 0; k < count; ++k) {
+        if (changed[k] >= 0) storeFloor(i, changed[k], floors[changed[k]]);
+    }
+    return i;
+}
+
+PositionArena::Index PositionArena::appendBulk(const std::vector<std::vector<Board>>& list) {
+    Index first = static_cast<Index>(next_);
+    // 先把要用的块都准备好，再顺序写入
+    std::size_t lastChunk = (next_ + list.size() + chunkSize_ - 1) / chunkSize_;
+    if (lastChunk > chunks_.size()) chunks_.resize(lastChunk);
+    for (const auto& floors : list) {
+        store(static_cast<Index>(next_++), floors);
+    }
+    return first;
+}
+
+void PositionArena::copyWords(Index i, std::uint64_t* out) const {
+    for (int col = 0; col < columns_; ++col) out[col] = *column(i, col);
+}
+
+PositionArena::Index PositionArena::appendWords(const std::uint64_t* words) {
+    Index i = static_cast<Index>(next_++);
+    claim(i);
+    for (int col = 0; col < columns_; ++col) *column(i, col) = words[col];
+    return i;
+}
+
+void PositionArena::release(Index first, std::size_t count) {
+    if (count == 0 || first >= next_) return;
+    std::size_t end = (count < next_ - first) ? first + count : next_;
+
+    for (std::size_t i = first; i < end; ++i) {
+        Chunk& ch = chunks_[i / chunkSize_];
+        if (!ch.words || ch.live == 0) continue;
+        ch.live--;
+        live_--;
+    }
+    // 释放的是末尾（撤销栈这类后进先出的用法）：编号收回，下次追加接着用
+    if (end == next_) next_ = first;
+
+    // 整块都空了就归还内存；正在追加的那一块留着，避免来回分配
+    std::size_t tail = next_ / chunkSize_;
+    for (std::size_t c = first / chunkSize_; c <= (end - 1) / chunkSize_; ++c) {
+        if (c != tail && chunks_[c].live == 0) chunks_[c].words.reset();
+    }
+}
+
+void PositionArena::load(Index i, std::vector<Board>& floors) const {
+    floors.resize(layout_->base.size());
+    const int floorCount = static_cast<int>(floors.size());
+    for (int f = 0; f < floorCount; ++f) {
+        loadFloor(i, f, floors[f]);
+    }
+}
+
+void PositionArena::loadFloor(Index i, int floor, Board& out) const {
+    out = layout_->base[floor];
+    PositionView v = view(i, floor);
+    for (int r = 0; r < Board::Rows; ++r) {
+        for (int c = 0; c < Board::Cols; ++c) {
+            if (!out.inBounds(r, c)) continue;
+            out.set(r, c, v.at(r, c));
+            if (layout_->kings) out.setType(r, c, v.typeAt(r, c));
+        }
+    }
+}
+
+PositionView PositionArena::view(Index i, int floor) const {
+    const int floorCount = static_cast<int>(layout_->base.size());
+    std::uint64_t extra = layout_->kings ? *column(i, floorCount + floor)
+                                         : (static_cast<std::uint64_t>(NO_KING) << 56);
+    return PositionView(layout_.get(), floor, *column(i, floor), extra);
+}
+
+int PositionArena::pegs(Index i) const {
+    int n = 0;
+    const int floorCount = static_cast<int>(layout_->base.size());
+    for (int f = 0; f < floorCount; ++f) n += popcount64(*column(i, f));
+    return n;
+}
+
+std::size_t PositionArena::bytes() const {
+    std::size_t n = 0;
+    for (const auto& ch : chunks_) {
+        if (ch.words) n += columns_ * chunkSize_ * sizeof(std::uint64_t);
+    }
+    return n;
+}
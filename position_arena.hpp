@@ -0,0 +1,103 @@
+#pragma once
+// 结构数组式局面仓库：批量分析 / 撤销栈里代替成堆的 Board 对象
+//
+// 同一局配置的所有局面共用一份 TileLayout（形状 + 初始格子类型），
+// 每个局面每层只存一个 64 位棋子掩码；有国王时每层再存一个字
+// （国王位置 + 国王走过后变回 Normal 的格子）。单层传统局面 8 字节，Board 约 400 字节。
+// 按块分配：编号在释放之前一直有效，整块局面都释放后归还内存。
+#include "board.hpp"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// 一局配置共用的格子布局
+struct TileLayout {
+    std::vector<Board>         base;            // 初始局面（提供形状和格子类型）
+    std::vector<std::uint64_t> valid;           // 每层有效格掩码
+    bool                       kings = false;   // 是否需要记录国王
+
+    static std::shared_ptr<const TileLayout> fromFloors(const std::vector<Board>& floors);
+    void assign(const std::vector<Board>& floors);   // 原地重建，沿用两个 vector 的容量
+};
+
+// 单层只读视图：接口与 Board 的读取部分一致，按值保存，不依赖仓库
+class PositionView {
+public:
+    CellState at(int r, int c) const;
+    CellType  typeAt(int r, int c) const;
+    bool      inBounds(int r, int c) const;
+
+    bool canJump(int r1, int c1, int r2, int c2) const;
+    bool canMove(int r, int c) const;
+    bool hasMove() const;
+
+    int  countPegs() const;
+    bool isSolved() const { return countPegs() == 1; }
+
+private:
+    friend class PositionArena;
+    PositionView(const TileLayout* layout, int floor, std::uint64_t pegs, std::uint64_t extra)
+        : layout_(layout), floor_(floor), pegs_(pegs), extra_(extra) {}
+
+    const TileLayout* layout_;
+    int               floor_;
+    std::uint64_t     pegs_;
+    std::uint64_t     extra_;   // 0-48 变回 Normal 的格 / 56-62 国王格
+};
+
+class PositionArena {
+public:
+    using Index = std::uint32_t;
+
+    explicit PositionArena(std::size_t chunkPositions = 4096);
+
+    // 换一局配置：清空所有局面（保留第一块内存）
+    void reset(std::shared_ptr<const TileLayout> layout);
+    // 按这组局面换布局：布局只有自己持有时原地重建，重开不再分配
+    void resetFrom(const std::vector<Board>& floors);
+    void clear();
+    const TileLayout* layout() const { return layout_.get(); }
+
+    Index append(const std::vector<Board>& floors);
+    // 从 prev 整列复制（每层一两个字），只重新打包 changed 里列出的层（负数跳过）。
+    // 撤销栈用：相邻快照之间只有上一步碰到的层不同
+    Index appendFrom(Index prev, const std::vector<Board>& floors, const int* changed, int count);
+    // 批量追加，返回第一个编号，其余编号连续
+    Index appendBulk(const std::vector<std::vector<Board>>& list);
+    // 释放 [first, first+count)；只有释放到末尾时编号才会被收回复用
+    void  release(Index first, std::size_t count = 1);
+
+    // 紧凑列原样导出 / 导入（存档用）：每个局面 columns() 个字，不展开成 Board
+    int   columns() const { return columns_; }
+    void  copyWords(Index i, std::uint64_t* out) const;
+    Index appendWords(const std::uint64_t* words);
+
+    // 还原成 Board（需要走规则时用）
+    void         load(Index i, std::vector<Board>& floors) const;
+    void         loadFloor(Index i, int floor, Board& out) const;   // 只还原一层
+    PositionView view(Index i, int floor = 0) const;
+    int          pegs(Index i) const;
+
+    std::size_t size()  const { return next_; }   // 已发出的编号数
+    std::size_t live()  const { return live_; }   // 未释放的局面数
+    std::size_t bytes() const;                    // 实际占用的块内存
+
+private:
+    struct Chunk {
+        std::unique_ptr<std::uint64_t[]> words;   // 列优先：第 k 列占 [k*chunk, (k+1)*chunk)
+        std::uint32_t                    live = 0;
+    };
+
+    std::uint64_t* column(Index i, int col);
+    const std::uint64_t* column(Index i, int col) const;
+    void store(Index i, const std::vector<Board>& floors);
+    void storeFloor(Index i, int floor, const Board& b);
+    void claim(Index i);    // 准备 i 所在的块并计入 live
+
+    std::shared_ptr<const TileLayout> layout_;
+    std::size_t        chunkSize_;
+    int                columns_ = 0;
+    std::vector<Chunk> chunks_;
+    std::size_t        next_ = 0;
+    std::size_t        live_ = 0;
+};
@@ -0,0 +1,110 @@
+// 局面键
+#include "position_codec.hpp"
+
+PositionCodec::PositionCodec(const std::vector<Board>& root) : tmpl_(root) {
+    floors_ = static_cast<int>(root.size());
+    kings_  = false;
+    for (const auto& b : root) {
+        for (int r = 0; r < Board::Rows; ++r) {
+            for (int c = 0; c < Board::Cols; ++c) {
+                if (b.typeAt(r, c) == CellType::King) kings_ = true;
+            }
+        }
+    }
+    words_ = kings_ ? floors_ * 2 : floors_;
+    if (words_ > PositionKey::MaxWords) floors_ = 0;
+
+    // 对称变换：与 Board::symHash 的约定一致，目标格 d 取源格 src
+    for (int s = 0; s < 8; ++s) {
+        for (int r = 0; r < Board::Rows; ++r) {
+            for (int c = 0; c < Board::Cols; ++c) {
+                int sr = (s & 4) ? c : r;
+                int sc = (s & 4) ? r : c;
+                if (s & 1) sr = Board::Rows - 1 - sr;
+                if (s & 2) sc = Board::Cols - 1 - sc;
+                inv_[s][sr * Board::Cols + sc] = r * Board::Cols + c;
+            }
+        }
+    }
+    // 只用让初始布局（形状 + 格子类型）不变的对称，否则解码会对不上模板
+    for (int s = 0; s < 8; ++s) {
+        bool same = true;
+        for (const auto& b : root) {
+            for (int i = 0; i < Cells && same; ++i) {
+                int d = inv_[s][i];
+                int r1 = i / Board::Cols, c1 = i % Board::Cols;
+                int r2 = d / Board::Cols, c2 = d % Board::Cols;
+                if (b.inBounds(r1, c1) != b.inBounds(r2, c2) ||
+                    b.typeAt(r1, c1) != b.typeAt(r2, c2)) {
+                    same = false;
+                }
+            }
+        }
+        if (same) syms_.push_back(s);
+    }
+}
+
+PositionKey PositionCodec::encode(const std::vector<Board>& floors) const {
+    PositionKey raw{};
+    if (floors_ == 0) return raw;
+    for (int f = 0; f < floors_; ++f) {
+        const Board& b = floors[f];
+        const Board& t = tmpl_[f];
+        std::uint64_t pegs = 0, trail = 0;
+        int king = NoKing;
+        for (int i = 0; i < Cells; ++i) {
+            int r = i / Board::Cols, c = i % Board::Cols;
+            if (b.at(r, c) == CellState::Peg) pegs |= 1ULL << i;
+            if (!kings_) continue;
+            CellType type = b.typeAt(r, c);
+            if (type == CellType::King)     king = i;
+            else if (type != t.typeAt(r, c)) trail |= 1ULL << i;
+        }
+        raw.w[f] = pegs;
+        if (kings_) raw.w[floors_ + f] = trail | (static_cast<std::uint64_t>(king) << 56);
+    }
+
+    PositionKey best = raw;
+    for (int s : syms_) {
+        if (s == 0) continue;
+        PositionKey k{};
+        for (int f = 0; f < floors_; ++f) {
+            k.w[f] = mapBits(raw.w[f], s);
+            if (kings_) {
+                std::uint64_t extra = raw.w[floors_ + f];
+                int king = static_cast<int>(extra >> 56);
+                std::uint64_t out = mapBits(extra & ((1ULL << Cells) - 1), s);
+                out |= static_cast<std::uint64_t>(king == NoKing ? NoKing : inv_[s][king]) << 56;
+                k.w[floors_ + f] = out;
+            }
+        }
+        if (compareKeyWords(k, best, words_) < 0) best = k;
+    }
+    return best;
+}
+
+void PositionCodec::decode(const PositionKey& key, std::vector<Board>& floors) const {
+    floors = tmpl_;
+    for (int f = 0; f < floors_; ++f) {
+        Board& b = floors[f];
+        const Board& t = tmpl_[f];
+        std::uint64_t extra = kings_ ? key.w[floors_ + f] : 0;
+        int king = kings_ ? static_cast<int>(extra >> 56) : NoKing;
+        for (int i = 0; i < Cells; ++i) {
+            int r = i / Board::Cols, c = i % Board::Cols;
+            if (!t.inBounds(r, c)) continue;
+            b.set(r, c, (key.w[f] >> i) & 1 ? CellState::Peg : CellState::Empty);
+            if (!kings_) continue;
+            if (i == king)                b.setType(r, c, CellType::King);
+            else if ((extra >> i) & 1)    b.setType(r, c, CellType::Normal);
+        }
+    }
+}
+
+std::uint64_t PositionCodec::mapBits(std::uint64_t bits, int s) const {
+    std::uint64_t out = 0;
+    for (int i = 0; i < Cells; ++i) {
+        if ((bits >> i) & 1) out |= 1ULL << inv_[s][i];
+    }
+    return out;
+}
@@ -0,0 +1,67 @@
+#pragma once
+// 局面键：多层棋盘 ↔ 定长键，按保持初始布局的对称取最小（规范形）
+//
+// 每层一个 64 位棋子掩码；开局有国王时每层再加一个字：
+//   0-48 位：类型和初始布局不同的格（国王走过 / 国王被吃）
+//   56-62 位：国王所在格，127 表示没有国王
+// 其余格子类型都和初始布局相同，解码时从模板取。
+// 键长固定（MaxWords 个字），层数多了放不下：先用 fits 检查，放不下时 encode / decode 什么也不做。
+#include "board.hpp"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+struct PositionKey {
+    static constexpr int MaxWords = 7;     // 3 层 × 2 个字 + 外存逆向时附带的父局面编号
+    std::uint64_t w[MaxWords];
+};
+
+inline bool operator<(const PositionKey& a, const PositionKey& b) {
+    for (int i = 0; i < PositionKey::MaxWords; ++i) {
+        if (a.w[i] != b.w[i]) return a.w[i] < b.w[i];
+    }
+    return false;
+}
+
+inline bool operator==(const PositionKey& a, const PositionKey& b) {
+    return std::memcmp(a.w, b.w, sizeof(a.w)) == 0;
+}
+
+// 只比较前 words 个字
+inline int compareKeyWords(const PositionKey& a, const PositionKey& b, int words) {
+    for (int i = 0; i < words; ++i) {
+        if (a.w[i] != b.w[i]) return a.w[i] < b.w[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+class PositionCodec {
+public:
+    // root 是开局：决定层数、有没有国王、可用哪些对称
+    explicit PositionCodec(const std::vector<Board>& root);
+
+    int words() const { return words_; }
+
+    // 键里还要附带 extraWords 个字时，开局的层数是否放得下
+    bool fits(int extraWords = 0) const { return words_ + extraWords <= PositionKey::MaxWords; }
+    // 同样的开局（有没有国王）最多能放几层
+    int  maxFloors(int extraWords = 0) const {
+        return (PositionKey::MaxWords - extraWords) / (kings_ ? 2 : 1);
+    }
+
+    PositionKey encode(const std::vector<Board>& floors) const;
+    void        decode(const PositionKey& key, std::vector<Board>& floors) const;
+
+private:
+    static constexpr int Cells  = Board::Rows * Board::Cols;
+    static constexpr int NoKing = 127;
+
+    std::uint64_t mapBits(std::uint64_t bits, int s) const;
+
+    std::vector<Board> tmpl_;
+    int                floors_ = 0;     // 放不下时为 0
+    bool               kings_  = false;
+    int                words_  = 0;
+    int                inv_[8][Cells];     // 源格 → 变换后的格
+    std::vector<int>   syms_;
+};
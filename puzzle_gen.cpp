@@ -0,0 +1,175 @@
+// 反向生成题目
+#include "puzzle_gen.hpp"
+#include <algorithm>
+#include <cstring>
+
+// ===== 反跳 =====
+//
+// 当前局面里的棋子 P 倒退一步：正向是 A 跳过 M 落到 B，必要时在冰格 B 上再滑到 P。
+//   直接落下：B = P,       M = P - d,  A = P - 2d
+//   冰上滑行：B = P - d,   M = P - 2d, A = P - 3d（B 必须是空的冰格）
+// 反跳后 A、M 放上棋子、P 清空。棋子始终不进沼泽和障碍，国王跟着棋子倒退。
+
+static const int DIR_R[4] = {-1, 1, 0, 0};
+static const int DIR_C[4] = {0, 0, -1, 1};
+
+struct UnJump {
+    int ar, ac;     // 起跳格
+    int mr, mc;     // 被吃的格
+    int br, bc;     // 落点（点击位置）
+    int pr, pc;     // 正向走完后棋子所在格
+};
+
+// 能放新棋子的空格：有效、空、不是沼泽和障碍
+static bool canHoldPeg(const Board& b, int r, int c) {
+    if (!b.inBounds(r, c) || b.at(r, c) != CellState::Empty) return false;
+    CellType t = b.typeAt(r, c);
+    return t != CellType::Swamp && t != CellType::Barrier;
+}
+
+static bool sameCells(const Board& a, const Board& b) {
+    std::uint8_t pa[Board::PackedSize];
+    std::uint8_t pb[Board::PackedSize];
+    a.packCells(pa);
+    b.packCells(pb);
+    return std::memcmp(pa, pb, Board::PackedSize) == 0;
+}
+
+// 构造反跳前的局面，再用正向规则走一遍，必须正好回到 cur
+static bool buildPrevious(const Board& cur, const Board& layout, const UnJump& u, Board& prev) {
+    prev = cur;
+    prev.set(u.pr, u.pc, CellState::Empty);
+    prev.set(u.mr, u.mc, CellState::Peg);
+    prev.set(u.ar, u.ac, CellState::Peg);
+    if (cur.typeAt(u.pr, u.pc) == CellType::King) {
+        // 国王离开的格子在正向里会变成普通格，所以 A 现在必须是普通格（由下面的核对保证）
+        CellType under = layout.typeAt(u.pr, u.pc);
+        prev.setType(u.pr, u.pc, under == CellType::King ? CellType::Normal : under);
+        prev.setType(u.ar, u.ac, CellType::King);
+    }
+    if (prev.typeAt(u.mr, u.mc) == CellType::King) return false;   // 吃掉国王直接输
+
+    Board next = prev;
+    int finalR, finalC;
+    if (!next.canJump(u.ar, u.ac, u.br, u.bc)) return false;
+    next.applyMove(u.ar, u.ac, u.br, u.bc, finalR, finalC);
+    return finalR == u.pr && finalC == u.pc && sameCells(next, cur);
+}
+
+// 列出所有形状上可行的反跳（只做廉价检查，规则核对留给 buildPrevious）
+static int collectUnJumps(const Board& cur, UnJump* out) {
+    int n = 0;
+    for (int r = 0; r < Board::Rows; ++r) {
+        for (int c = 0; c < Board::Cols; ++c) {
+            if (cur.at(r, c) != CellState::Peg) continue;
+            for (int k = 0; k < 4; ++k) {
+                int dr = DIR_R[k], dc = DIR_C[k];
+                // 直接落下
+                if (canHoldPeg(cur, r - dr, c - dc) && canHoldPeg(cur, r - 2 * dr, c - 2 * dc)) {
+                    out[n++] = {r - 2 * dr, c - 2 * dc, r - dr, c - dc, r, c, r, c};
+                }
+                // 冰上滑行
+                int br = r - dr, bc = c - dc;
+                if (cur.inBounds(br, bc) && cur.at(br, bc) == CellState::Empty &&
+                    cur.typeAt(br, bc) == CellType::Ice &&
+                    canHoldPeg(cur, r - 2 * dr, c - 2 * dc) &&
+                    canHoldPeg(cur, r - 3 * dr, c - 3 * dc)) {
+                    out[n++] = {r - 3 * dr, c - 3 * dc, r - 2 * dr, c - 2 * dc, br, bc, r, c};
+                }
+            }
+        }
+    }
+    return n;
+}
+
+// ===== 终局 =====
+
+// 清空棋子后按模式放下最后一个棋子；没有合适的格子时返回 false
+static bool placeFinalPeg(Board& b, GameMode mode, BoardRng& rng) {
+    int cells[Board::Rows * Board::Cols];
+    int n = 0;
+    for (int r = 0; r < Board::Rows; ++r) {
+        for (int c = 0; c < Board::Cols; ++c) {
+            if (!b.inBounds(r, c)) continue;
+            b.set(r, c, CellState::Empty);
+            CellType t = b.typeAt(r, c);
+            bool ok = false;
+            switch (mode) {
+            case GameMode::Classic: ok = (t != CellType::Swamp && t != CellType::Barrier); break;
+            case GameMode::Lattice: ok = (t == CellType::Goal); break;
+            case GameMode::Chess:   ok = (t == CellType::King); break;
+            }
+            if (ok) cells[n++] = r * Board::Cols + c;
+        }
+    }
+    if (n == 0) return false;
+    int k = cells[rng.range(0, n - 1)];
+    b.set(k / Board::Cols, k % Board::Cols, CellState::Peg);
+    return true;
+}
+
+// ===== 入口 =====
+
+bool generatePuzzle(const PuzzleConfig& cfg, std::uint64_t seed, Puzzle& out) {
+    SpecialConfig special = cfg.special;
+    special.extraHoles = false;
+
+    BoardRng rng(seed);
+    std::vector<Jump> reversed;
+    UnJump candidates[Board::Rows * Board::Cols * 8];
+    int bestPegs = 0;
+
+    for (int attempt = 0; attempt < std::max(1, cfg.attempts); ++attempt) {
+        // 每次尝试换一张布局：障碍把棋盘切碎时换一张更容易退够步数
+        Board layout(cfg.mode, cfg.shape, special, rng.next());
+        Board cur = layout;
+        if (!placeFinalPeg(cur, cfg.mode, rng)) continue;
+
+        reversed.clear();
+        int pegs = 1;
+        Board prev;
+        while (pegs < cfg.targetPegs) {
+            int n = collectUnJumps(cur, candidates);
+            bool moved = false;
+            // 不放回地随机抽，第一个核对通过的就用
+            while (n > 0) {
+                int k = rng.range(0, n - 1);
+                UnJump u = candidates[k];
+                candidates[k] = candidates[--n];
+                if (!buildPrevious(cur, layout, u, prev)) continue;
+                cur = prev;
+                reversed.push_back({0, u.ar, u.ac, u.br, u.bc});
+                moved = true;
+                break;
+            }
+            if (!moved) break;
+            ++pegs;
+        }
+
+        if (pegs > bestPegs) {
+            bestPegs     = pegs;
+            out.board    = cur;
+            out.solution.assign(reversed.rbegin(), reversed.rend());
+        }
+        if (pegs >= cfg.targetPegs) return true;
+    }
+    return false;
+}
+
+bool replayPuzzle(const Puzzle& puzzle, GameMode mode) {
+    Board b = puzzle.board;
+    for (const auto& j : puzzle.solution) {
+        if (b.typeAt(j.r1, j.c1) == CellType::Swamp) return false;
+        if (!b.canJump(j.r1, j.c1, j.r2, j.c2)) return false;
+        int finalR, finalC;
+        b.applyMove(j.r1, j.c1, j.r2, j.c2, finalR, finalC);
+        if (mode == GameMode::Chess && !isKingAlive(b)) return false;
+    }
+    if (b.hasMove()) return false;
+    switch (mode) {
+    case GameMode::Classic: return b.isSolved();
+    case GameMode::Lattice: return isGoalWin(b);
+    case GameMode::Chess:   return isKingAlive(b);
+    }
+    return false;
+}
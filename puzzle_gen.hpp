@@ -0,0 +1,30 @@
+#pragma once
+// 反向生成题目：从获胜终局出发随机“反跳”，倒推出开局
+//
+// 终局：传统模式一个棋子（随机格），目标模式一个棋子在 Goal 格，保护国王模式只剩国王。
+// 每一步反跳都用正向规则（canJump + applyMove，含冰滑、国王移动）核对过，
+// 沿记录的走法正着走一定回到终局，所以不需要求解器，生成出来必然有解。
+// 只生成单层（传送格只在多层时出现）。
+#include "board.hpp"
+#include <cstdint>
+#include <vector>
+
+struct PuzzleConfig {
+    GameMode      mode       = GameMode::Classic;
+    MapShape      shape      = MapShape::Cross;
+    SpecialConfig special;                  // extraHoles 不起作用：棋子分布由反跳决定
+    int           targetPegs = 16;          // 开局棋子数
+    int           attempts   = 8;           // 中途无路可退时换一串随机数重来
+};
+
+struct Puzzle {
+    Board             board;
+    std::vector<Jump> solution;             // 正向走法，solution.size() == 开局棋子数 - 1
+};
+
+// 达到 targetPegs 返回 true；否则 out 是各次尝试里棋子最多的一个（同样有解）。
+// 同一配置 + 同一种子 = 同一道题
+bool generatePuzzle(const PuzzleConfig& cfg, std::uint64_t seed, Puzzle& out);
+
+// 按记录的走法正着走一遍，检查每步合法、最后按 mode 判定为胜
+bool replayPuzzle(const Puzzle& puzzle, GameMode mode);
@@ -0,0 +1,403 @@
+// 对局存档
+#include "save_game.hpp"
+#include "mapped_file.hpp"
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+
+static_assert(std::is_trivially_copyable<Board>::value, "存档按字节拷贝 Board");
+
+struct SaveHeader {
+    char          magic[8];         // "PEGSAV01"
+    std::uint32_t version;
+    std::uint32_t boardBytes;       // sizeof(Board)
+    std::uint32_t layers;
+    std::uint32_t currentFloor;
+    std::uint32_t moveCount;
+    std::uint32_t historyCount;     // 撤销栈快照数，第一个是开局
+    std::uint64_t seed;             // 本局实际种子
+    std::uint64_t configSeed;       // GameConfig::seed（0 表示每局随机）
+    std::int32_t  puzzlePegs;
+    std::uint32_t mapPathBytes;
+    std::uint8_t  winMode;
+    std::uint8_t  mapShape;
+    std::uint8_t  tiles;            // 1 冰格 2 沼泽 4 障碍
+    std::uint8_t  reserved[5];
+};
+static_assert(sizeof(SaveHeader) == 64, "存档文件头必须是 64 字节");
+
+static const char          SAVE_MAGIC[8] = {'P','E','G','S','A','V','0','1'};
+static const std::uint32_t SAVE_VERSION  = 4;     // 2：加了经典计步；3：加了自定义传送链接；
+                                                  // 4：撤销栈存格子布局 + 紧凑列（旧版本仍可读）
+
+// 经典计步：当前一条 + 每个撤销快照一条，跟在棋盘之后
+struct SaveChain {
+    std::int32_t moves;
+    std::int32_t floor;
+    std::int32_t row;
+    std::int32_t col;
+};
+static_assert(sizeof(SaveChain) == 16, "计步记录必须是 16 字节");
+
+// 自定义传送链接（GameConfig::teleports）：先写条数（uint32），再逐条写，跟在计步之后
+struct SaveLink {
+    std::int32_t floor, row, col;
+    std::int32_t toFloor, toRow, toCol;
+};
+static_assert(sizeof(SaveLink) == 24, "传送链接记录必须是 24 字节");
+
+enum : std::uint8_t {
+    SAVE_ICE     = 1,
+    SAVE_SWAMP   = 2,
+    SAVE_BARRIER = 4
+};
+
+// ===== 打包 =====
+
+static void appendBoards(std::vector<std::uint8_t>& out, const std::vector<Board>& floors) {
+    std::size_t at = out.size();
+    out.resize(at + floors.size() * sizeof(Board));
+    std::memcpy(out.data() + at, floors.data(), floors.size() * sizeof(Board));
+}
+
+static void appendChain(std::vector<std::uint8_t>& out, const MoveChain& chain) {
+    SaveChain rec{chain.moves, chain.floor, chain.row, chain.col};
+    std::size_t at = out.size();
+    out.resize(at + sizeof(rec));
+    std::memcpy(out.data() + at, &rec, sizeof(rec));
+}
+
+static MoveChain readChain(const std::uint8_t* p) {
+    SaveChain rec;
+    std::memcpy(&rec, p, sizeof(rec));
+    MoveChain chain;
+    chain.moves = rec.moves;
+    chain.floor = rec.floor;
+    chain.row   = rec.row;
+    chain.col   = rec.col;
+    return chain;
+}
+
+static void packGame(const GameRuntime& rt, std::vector<std::uint8_t>& out) {
+    const GameConfig& cfg = rt.config;
+
+    SaveHeader h{};
+    std::memcpy(h.magic, SAVE_MAGIC, sizeof(SAVE_MAGIC));
+    h.version      = SAVE_VERSION;
+    h.boardBytes   = sizeof(Board);
+    h.layers       = static_cast<std::uint32_t>(rt.floors.size());
+    h.currentFloor = static_cast<std::uint32_t>(rt.currentFloor);
+    h.moveCount    = static_cast<std::uint32_t>(rt.moveCount);
+    h.historyCount = static_cast<std::uint32_t>(rt.historyIds.size());
+    h.seed         = rt.seed;
+    h.configSeed   = cfg.seed;
+    h.puzzlePegs   = cfg.puzzlePegs;
+    h.mapPathBytes = static_cast<std::uint32_t>(cfg.mapPath.size());
+    h.winMode      = static_cast<std::uint8_t>(cfg.winMode);
+    h.mapShape     = static_cast<std::uint8_t>(cfg.mapShape);
+    h.tiles        = static_cast<std::uint8_t>((cfg.useIce     ? SAVE_ICE     : 0) |
+                                               (cfg.useSwamp   ? SAVE_SWAMP   : 0) |
+                                               (cfg.useBarrier ? SAVE_BARRIER : 0));
+
+    out.clear();
+    out.resize(sizeof(h));
+    std::memcpy(out.data(), &h, sizeof(h));
+    appendBoards(out, rt.floors);
+    // 撤销栈：格子布局 + 每个快照的紧凑列原样拷贝（每层一两个字），不在游戏线程上展开成 Board
+    appendBoards(out, rt.history.layout()->base);
+    const std::size_t snapshotBytes = static_cast<std::size_t>(rt.history.columns()) * sizeof(std::uint64_t);
+    std::uint64_t words[2 * MaxLayers];
+    for (PositionArena::Index id : rt.historyIds) {
+        rt.history.copyWords(id, words);
+        std::size_t at = out.size();
+        out.resize(at + snapshotBytes);
+        std::memcpy(out.data() + at, words, snapshotBytes);
+    }
+    appendChain(out, rt.chain);
+    for (const MoveChain& chain : rt.chainHistory) {
+        appendChain(out, chain);
+    }
+    std::uint32_t linkCount = static_cast<std::uint32_t>(cfg.teleports.size());
+    std::size_t at = out.size();
+    out.resize(at + sizeof(linkCount) + linkCount * sizeof(SaveLink));
+    std::memcpy(out.data() + at, &linkCount, sizeof(linkCount));
+    at += sizeof(linkCount);
+    for (const TeleportLink& l : cfg.teleports) {
+        SaveLink rec{l.floor, l.row, l.col, l.toFloor, l.toRow, l.toCol};
+        std::memcpy(out.data() + at, &rec, sizeof(rec));
+        at += sizeof(rec);
+    }
+    out.insert(out.end(), cfg.mapPath.begin(), cfg.mapPath.end());
+}
+
+// ===== 读取 =====
+
+// 按字节拷进来的棋盘不一定是本程序写的：每格的状态和类型都要落在枚举范围内（同 map_file）
+static bool validCells(const Board& b) {
+    for (int r = 0; r < Board::Rows; ++r) {
+        for (int c = 0; c < Board::Cols; ++c) {
+            int s = static_cast<int>(b.at(r, c));
+            int t = static_cast<int>(b.typeAt(r, c));
+            if (s < 0 || s > static_cast<int>(CellState::Peg) ||
+                t < 0 || t > static_cast<int>(CellType::Teleport)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool loadGame(const std::string& path, GameRuntime& rt, std::string& error) {
+    MappedFile file;
+    if (!file.openRead(path)) {
+        error = "cannot open " + path;
+        return false;
+    }
+    const std::uint8_t* data = static_cast<const std::uint8_t*>(file.data());
+
+    SaveHeader h;
+    if (file.size() < sizeof(h)) {
+        error = "file too small";
+        return false;
+    }
+    std::memcpy(&h, data, sizeof(h));
+    if (std::memcmp(h.magic, SAVE_MAGIC, sizeof(SAVE_MAGIC)) != 0) {
+        error = "not a save file";
+        return false;
+    }
+    if (h.version < 1 || h.version > SAVE_VERSION) {
+        error = "unsupported save version " + std::to_string(h.version);
+        return false;
+    }
+    if (h.boardBytes != sizeof(Board)) {
+        error = "save written by an incompatible build";
+        return false;
+    }
+    if (h.layers < 1 || h.layers > static_cast<std::uint32_t>(MaxLayers) || h.currentFloor >= h.layers || h.historyCount == 0 ||
+        h.winMode > static_cast<std::uint8_t>(GameMode::Chess) ||
+        h.mapShape > static_cast<std::uint8_t>(MapShape::Diamond)) {
+        error = "corrupt header";
+        return false;
+    }
+    std::size_t floorBytes = static_cast<std::size_t>(h.layers) * sizeof(Board);
+    if (file.size() < sizeof(h) + 2 * floorBytes) {
+        error = "truncated save file";
+        return false;
+    }
+    const std::uint8_t* p = data + sizeof(h);
+    std::vector<Board> floors(h.layers);
+    std::memcpy(floors.data(), p, floorBytes);
+    p += floorBytes;
+
+    // 版本 4 起紧跟格子布局，快照是紧凑列；更早的版本每个快照都是整层 Board，第一个是开局
+    std::vector<Board> opening(h.layers);
+    std::memcpy(opening.data(), p, floorBytes);
+    if (h.version >= 4) p += floorBytes;
+
+    for (std::uint32_t i = 0; i < h.layers; ++i) {
+        if (!validCells(floors[i]) || !validCells(opening[i])) {
+            error = "corrupt board data";
+            return false;
+        }
+    }
+
+    // 规则集字节在旧存档里是填充，按格子重新选
+    for (auto& b : floors)  b.refreshRules();
+    for (auto& b : opening) b.refreshRules();
+
+    std::shared_ptr<const TileLayout> layout = TileLayout::fromFloors(opening);
+    std::size_t snapshotBytes = floorBytes;
+    if (h.version >= 4) {
+        snapshotBytes = (layout->kings ? 2 : 1) * static_cast<std::size_t>(h.layers) * sizeof(std::uint64_t);
+    }
+    std::size_t chainBytes = h.version >= 2 ? (1 + static_cast<std::size_t>(h.historyCount)) * sizeof(SaveChain)
+                                            : 0;
+    std::size_t linksAt    = static_cast<std::size_t>(p - data) +
+                             snapshotBytes * static_cast<std::size_t>(h.historyCount) + chainBytes;
+    std::uint32_t linkCount = 0;
+    std::size_t   linkBytes = 0;
+    if (h.version >= 3) {
+        if (file.size() < linksAt + sizeof(linkCount)) {
+            error = "truncated save file";
+            return false;
+        }
+        std::memcpy(&linkCount, data + linksAt, sizeof(linkCount));
+        linkBytes = sizeof(linkCount) + static_cast<std::size_t>(linkCount) * sizeof(SaveLink);
+    }
+    std::size_t expected   = linksAt + linkBytes + h.mapPathBytes;
+    if (file.size() != expected) {
+        error = "truncated save file";
+        return false;
+    }
+    // 旧版本的快照也是整层 Board，压回撤销栈之前先逐层检查
+    if (h.version < 4) {
+        const std::uint8_t* sp = p;
+        Board snap;
+        for (std::uint32_t i = 0; i < h.historyCount * h.layers; ++i, sp += sizeof(Board)) {
+            std::memcpy(&snap, sp, sizeof(Board));
+            if (!validCells(snap)) {
+                error = "corrupt board data";
+                return false;
+            }
+        }
+    }
+
+    // 校验都通过后才改 rt
+    GameConfig cfg;
+    cfg.layers     = static_cast<int>(h.layers);
+    cfg.useIce     = (h.tiles & SAVE_ICE) != 0;
+    cfg.useSwamp   = (h.tiles & SAVE_SWAMP) != 0;
+    cfg.useBarrier = (h.tiles & SAVE_BARRIER) != 0;
+    cfg.winMode    = static_cast<GameMode>(h.winMode);
+    cfg.mapShape   = static_cast<MapShape>(h.mapShape);
+    cfg.mapPath.assign(reinterpret_cast<const char*>(data + expected - h.mapPathBytes),
+                       h.mapPathBytes);
+    cfg.seed       = h.configSeed;
+    cfg.puzzlePegs = h.puzzlePegs;
+    const std::uint8_t* lp = data + linksAt + sizeof(linkCount);
+    for (std::uint32_t i = 0; i < linkCount; ++i, lp += sizeof(SaveLink)) {
+        SaveLink rec;
+        std::memcpy(&rec, lp, sizeof(rec));
+        cfg.teleports.push_back(TeleportLink{rec.floor, rec.row, rec.col,
+                                             rec.toFloor, rec.toRow, rec.toCol});
+    }
+
+    rt.config    = cfg;
+    rt.gameMode  = cfg.winMode;
+    rt.layerMode = layerModeFor(cfg.layers);
+    rt.seed = h.seed;
+
+    // 撤销栈：开局决定格子布局，之后按顺序压回
+    rt.history.reset(layout);
+    rt.historyIds.clear();
+    rt.touchHistory.assign(h.historyCount, HistoryTouch());
+    std::uint64_t words[2 * MaxLayers];
+    for (std::uint32_t i = 0; i < h.historyCount; ++i) {
+        if (h.version >= 4) {
+            std::memcpy(words, p, snapshotBytes);
+            rt.historyIds.push_back(rt.history.appendWords(words));
+        } else {
+            std::memcpy(opening.data(), p, floorBytes);
+            rt.historyIds.push_back(rt.history.append(opening));
+        }
+        p += snapshotBytes;
+    }
+
+    // 版本 1 没有计步记录：每跳算一步，落点未知
+    rt.chainHistory.clear();
+    if (h.version >= 2) {
+        rt.chain = readChain(p);
+        p += sizeof(SaveChain);
+        for (std::uint32_t i = 0; i < h.historyCount; ++i) {
+            rt.chainHistory.push_back(readChain(p));
+            p += sizeof(SaveChain);
+        }
+    } else {
+        for (std::uint32_t i = 0; i < h.historyCount; ++i) {
+            MoveChain chain;
+            chain.moves = i == 0 ? 0 : static_cast<int>(i) - 1;
+            rt.chainHistory.push_back(chain);
+        }
+        rt.chain = MoveChain();
+        rt.chain.moves = static_cast<int>(h.historyCount) - 1;
+    }
+
+    rt.floors.swap(floors);
+    rt.currentFloor = static_cast<int>(h.currentFloor);
+    buildTeleportLinks(rt);     // 传送格已经在存下的棋盘里
+    rt.floorIndex.rebuild(rt.floors);
+
+    rt.selection   = false;
+    rt.selectedRow = -1;
+    rt.selectedCol = -1;
+    rt.possibleTargets = 0;
+
+    rt.moveCount = static_cast<int>(h.moveCount);
+    rt.pegCount  = totalPegs(rt);
+
+    rt.tweens.clear();
+
+    rt.isGameOver = false;
+    if (rt.telemetry) rt.lastActionMs = rt.telemetry->nowMs();
+    return true;
+}
+
+// ===== 自动存档 =====
+
+AutoSave::~AutoSave() {
+    stop();
+}
+
+bool AutoSave::start(const std::string& path) {
+    stop();
+    // 先确认目录可写，免得玩了半天才发现存不下来
+    std::string tmp = path + ".tmp";
+    std::FILE* f = std::fopen(tmp.c_str(), "wb");
+    if (!f) return false;
+    std::fclose(f);
+    std::remove(tmp.c_str());
+
+    path_ = path;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        hasPending_ = false;
+        running_    = true;
+    }
+    worker_ = std::thread(&AutoSave::writeLoop, this);
+    return true;
+}
+
+void AutoSave::stop() {
+    if (!worker_.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    wake_.notify_one();
+    worker_.join();
+}
+
+void AutoSave::request(const GameRuntime& rt) {
+    packGame(rt, packing_);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) return;
+        pending_.swap(packing_);
+        hasPending_ = true;
+    }
+    wake_.notify_one();
+}
+
+void AutoSave::writeLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        wake_.wait(lock, [this] { return hasPending_ || !running_; });
+        if (hasPending_) {
+            writing_.swap(pending_);
+            hasPending_ = false;
+            lock.unlock();
+            if (writeFile(writing_)) saved_.fetch_add(1, std::memory_order_relaxed);
+            else                     failed_.fetch_add(1, std::memory_order_relaxed);
+            lock.lock();
+            continue;       // 写盘期间可能又来了新请求
+        }
+        if (!running_) break;
+    }
+}
+
+// 写临时文件再改名：中途断电也只会留下上一份完整的存档
+bool AutoSave::writeFile(const std::vector<std::uint8_t>& bytes) {
+    std::string tmp = path_ + ".tmp";
+    std::FILE* f = std::fopen(tmp.c_str(), "wb");
+    if (!f) return false;
+    bool ok = std::fwrite(bytes.data(), 1, bytes.size(), f) == bytes.size();
+    ok = (std::fclose(f) == 0) && ok;
+    if (!ok) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+#ifdef _WIN32
+    std::remove(path_.c_str());     // Windows 上 rename 不覆盖已有文件
+#endif
+    return std::rename(tmp.c_str(), path_.c_str()) == 0;
+}
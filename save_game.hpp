@@ -0,0 +1,59 @@
+#pragma once
+// 对局存档：整局可玩状态（各层棋盘和格子类型、当前楼层、步数、配置、撤销栈）
+//
+// 文件：64 字节文件头 + 当前各层 Board 原样字节 + 格子布局（layers 个 Board）
+//       + 撤销栈（每个快照是局面仓库的紧凑列，每层一两个 64 位字）+ 经典计步（当前一条 + 每个快照一条）+ 自定义传送链接（条数 + 每条 24 字节）+ 地图路径。
+// Board 是平凡可拷贝的定长对象，写入和读取都是整块 memcpy，不逐格解析；
+// 文件头记下 sizeof(Board)，换了编译器 / 平台对不上时拒绝加载，而不是读出错乱的棋盘。
+//
+// 自动存档：游戏线程只把状态打包进内存缓冲并交换指针，写临时文件再改名由后台线程做，
+// 不会卡帧；写盘期间又有新请求时只保留最新的一份。
+#include "game.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 读存档：整块内存映射，Board 直接拷回，撤销栈的紧凑列重新压进局面仓库（旧版本存档按 Board 压回）。失败时 error 给出原因，rt 不变
+bool loadGame(const std::string& path, GameRuntime& rt, std::string& error);
+
+class AutoSave {
+public:
+    AutoSave() = default;
+    ~AutoSave();
+
+    AutoSave(const AutoSave&) = delete;
+    AutoSave& operator=(const AutoSave&) = delete;
+
+    bool start(const std::string& path);
+    void stop();                // 写完最后一份再退出
+
+    // 游戏线程调用：打包当前状态（只有 memcpy，撤销栈不展开），交给写盘线程；不做 IO
+    void request(const GameRuntime& rt);
+
+    long long saved()  const { return saved_.load(std::memory_order_relaxed); }
+    long long failed() const { return failed_.load(std::memory_order_relaxed); }
+
+private:
+    void writeLoop();
+    bool writeFile(const std::vector<std::uint8_t>& bytes);
+
+    std::string path_;
+
+    // 三块缓冲轮换：打包 / 待写 / 正在写，容量稳定后不再分配
+    std::vector<std::uint8_t> packing_;
+    std::vector<std::uint8_t> pending_;
+    std::vector<std::uint8_t> writing_;
+
+    std::mutex              mutex_;
+    std::condition_variable wake_;
+    bool                    hasPending_ = false;
+    bool                    running_    = false;
+    std::thread             worker_;
+
+    std::atomic<long long> saved_{0};
+    std::atomic<long long> failed_{0};
+};
@@ -0,0 +1,377 @@
+// 无窗口多局托管：复用 initGame / handlePlaying 的规则
+#include "session_host.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+// ===== 耗时统计 =====
+
+void LatencyStats::record(std::uint64_t ns) {
+    int b = 0;
+    while (b + 1 < Buckets && (std::uint64_t(1) << b) < ns) ++b;
+    buckets[b]++;
+    count++;
+    totalNs += ns;
+    if (ns > maxNs) maxNs = ns;
+}
+
+std::uint64_t LatencyStats::percentile(double p) const {
+    if (count == 0) return 0;
+    std::uint64_t want = static_cast<std::uint64_t>(p * count);
+    if (want >= count) want = count - 1;
+    std::uint64_t seen = 0;
+    for (int b = 0; b < Buckets; ++b) {
+        seen += buckets[b];
+        if (seen > want) return std::uint64_t(1) << b;
+    }
+    return maxNs;
+}
+
+// ===== 小工具：不分配内存的分词 =====
+
+// 跳过空白，取出下一个词；没有词时返回 false
+static bool nextToken(const char*& p, const char*& tok, int& len) {
+    while (*p == ' ' || *p == '\t' || *p == '\r') ++p;
+    if (*p == '\0') return false;
+    tok = p;
+    while (*p != '\0' && *p != ' ' && *p != '\t' && *p != '\r') ++p;
+    len = static_cast<int>(p - tok);
+    return true;
+}
+
+static bool tokenIs(const char* tok, int len, const char* word) {
+    return static_cast<int>(std::strlen(word)) == len &&
+           std::strncmp(tok, word, len) == 0;
+}
+
+static bool nextInt(const char*& p, int& value) {
+    const char* tok;
+    int len;
+    if (!nextToken(p, tok, len)) return false;
+    char* end = nullptr;
+    long v = std::strtol(tok, &end, 10);
+    if (end != tok + len) return false;
+    value = static_cast<int>(v);
+    return true;
+}
+
+static bool nextU64(const char*& p, std::uint64_t& value) {
+    const char* tok;
+    int len;
+    if (!nextToken(p, tok, len)) return false;
+    char* end = nullptr;
+    unsigned long long v = std::strtoull(tok, &end, 10);
+    if (end != tok + len) return false;
+    value = static_cast<std::uint64_t>(v);
+    return true;
+}
+
+// 每个槽位预留的层数
+static const int RESERVED_FLOORS = 4;
+
+static const char* COMMAND_NAMES[] = {
+    "new", "click", "key", "show", "close", "stats"
+};
+
+// ===== 对象池 =====
+
+static int clampCapacity(int capacity) {
+    return std::max(1, std::min(capacity, SessionHost::MaxCapacity));
+}
+
+SessionHost::SessionHost(int capacity)
+    : pool_(new Session[clampCapacity(capacity)]),
+      capacity_(clampCapacity(capacity)),
+      start_(std::chrono::steady_clock::now())
+{
+    // 空闲链表：0 → 1 → ... → capacity-1
+    for (int i = 0; i < capacity_; ++i) {
+        pool_[i].nextFree = (i + 1 < capacity_) ? i + 1 : -1;
+        // 只按少数几层预留（按 MaxLayers 预留时满池要一百多 MB）。
+        // 层数更多的局开局时按需扩容，之后这个槽位的 floors / 撤销仓库 / 传送链接 / 补间都沿用已有容量
+        pool_[i].rt.floors.reserve(RESERVED_FLOORS);
+        pool_[i].rt.historyIds.reserve(64);
+        pool_[i].rt.chainHistory.reserve(64);
+        pool_[i].rt.touchHistory.reserve(64);
+    }
+    freeHead_ = 0;
+}
+
+int SessionHost::open(const GameConfig& cfg) {
+    if (freeHead_ < 0) return -1;
+    int id = freeHead_;
+    Session& s = pool_[id];
+    freeHead_ = s.nextFree;
+
+    s.state    = GameState::Playing;
+    s.active   = true;
+    s.win      = false;
+    s.nextFree = -1;
+    s.rt.telemetry        = telemetry_;
+    s.rt.telemetrySession = static_cast<std::uint16_t>(id);
+    initGame(s.rt, cfg);
+    active_++;
+    return id;
+}
+
+bool SessionHost::close(int id) {
+    Session* s = get(id);
+    if (!s) return false;
+    s->active   = false;
+    s->nextFree = freeHead_;
+    freeHead_   = id;
+    active_--;
+    return true;
+}
+
+Session* SessionHost::get(int id) {
+    if (id < 0 || id >= capacity_) return nullptr;
+    if (!pool_[id].active) return nullptr;
+    return &pool_[id];
+}
+
+void SessionHost::settle(Session& s) {
+    // 无窗口时动画没有意义：一次推进到结束
+    updateAnimations(s.rt, 1e9f);
+    bool win = false;
+    if (checkGameOver(s.rt, win)) {
+        s.win = win;
+    }
+}
+
+// ===== 输出 =====
+
+void SessionHost::printStatus(int id, const Session& s, std::ostream& out, bool withSeed) const {
+    const char* result = "playing";
+    if (s.rt.isGameOver)                   result = s.win ? "win" : "lose";
+    else if (s.state == GameState::Over)   result = "quit";
+
+    out << "ok " << id
+        << " pegs="  << s.rt.pegCount
+        << " moves=" << s.rt.moveCount
+        << " chain=" << s.rt.chain.moves
+        << " floor=" << s.rt.currentFloor
+        << " " << result;
+    if (withSeed) out << " seed=" << s.rt.seed;
+    out << "\n";
+}
+
+// 棋盘字符：空格=无效 o=棋子 K=国王 .=空 ~=冰 %=沼泽 #=障碍 G=目标 @=传送
+void SessionHost::printBoard(int id, const Session& s, std::ostream& out) const {
+    const Board& board = currentBoard(s.rt);
+    out << "ok " << id << " floor=" << s.rt.currentFloor
+        << "/" << s.rt.floors.size() << "\n";
+    for (int r = 0; r < Board::Rows; ++r) {
+        char row[Board::Cols + 1];
+        for (int c = 0; c < Board::Cols; ++c) {
+            CellState state = board.at(r, c);
+            CellType  type  = board.typeAt(r, c);
+            char ch = ' ';
+            if (state == CellState::Peg) {
+                ch = (type == CellType::King) ? 'K' : 'o';
+            } else if (state == CellState::Empty) {
+                switch (type) {
+                case CellType::Ice:      ch = '~'; break;
+                case CellType::Swamp:    ch = '%'; break;
+                case CellType::Barrier:  ch = '#'; break;
+                case CellType::Goal:     ch = 'G'; break;
+                case CellType::Teleport: ch = '@'; break;
+                default:                 ch = '.'; break;
+                }
+            }
+            row[c] = ch;
+        }
+        row[Board::Cols] = '\0';
+        out << row << "\n";
+    }
+}
+
+void SessionHost::printStats(std::ostream& out) const {
+    double elapsed = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start_).count();
+    std::uint64_t total = 0;
+    for (const auto& st : stats_) total += st.count;
+
+    out << "stats sessions=" << active_ << "/" << capacity_
+        << " commands=" << total
+        << " throughput=" << (elapsed > 0 ? total / elapsed : 0.0) << "/s\n";
+    for (int i = 0; i < static_cast<int>(HostCommand::Count); ++i) {
+        const LatencyStats& st = stats_[i];
+        if (st.count == 0) continue;
+        out << "stat " << COMMAND_NAMES[i]
+            << " n="    << st.count
+            << " mean=" << (st.totalNs / st.count) << "ns"
+            << " p50<=" << st.percentile(0.50)  << "ns"
+            << " p99<=" << st.percentile(0.99)  << "ns"
+            << " p999<=" << st.percentile(0.999) << "ns"
+            << " max="  << st.maxNs << "ns\n";
+    }
+    if (telemetry_) {
+        out << "stat telemetry written=" << telemetry_->written()
+            << " dropped=" << telemetry_->dropped() << "\n";
+    }
+}
+
+// ===== 行协议 =====
+//
+//   new <规则1-3> <层数1-64> <形状1-4> [冰0/1] [沼泽0/1] [障碍0/1] [种子]（回复带 seed=，0 或省略为随机）
+//   click <id> <行> <列>
+//   key <id> <q|e|z|r|esc>
+//   show <id>
+//   close <id>
+//   stats
+//   quit
+//
+// 成功回复以 "ok" 开头，失败回复 "err <原因>"
+
+bool SessionHost::handleLine(const std::string& line, std::ostream& out) {
+    const char* p = line.c_str();
+    const char* tok;
+    int len;
+    if (!nextToken(p, tok, len)) return true;   // 空行忽略
+
+    if (tokenIs(tok, len, "quit")) return false;
+
+    HostCommand cmd;
+    if      (tokenIs(tok, len, "new"))   cmd = HostCommand::New;
+    else if (tokenIs(tok, len, "click")) cmd = HostCommand::Click;
+    else if (tokenIs(tok, len, "key"))   cmd = HostCommand::Key;
+    else if (tokenIs(tok, len, "show"))  cmd = HostCommand::Show;
+    else if (tokenIs(tok, len, "close")) cmd = HostCommand::Close;
+    else if (tokenIs(tok, len, "stats")) cmd = HostCommand::Stats;
+    else {
+        out << "err unknown command\n";
+        return true;
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+
+    switch (cmd) {
+    case HostCommand::New: {
+        int mode = 1, layers = 1, shape = 1, ice = 0, swamp = 0, barrier = 0;
+        std::uint64_t seed = 0;
+        if (!nextInt(p, mode) || !nextInt(p, layers) || !nextInt(p, shape)) {
+            out << "err usage: new <mode> <layers> <shape> [ice] [swamp] [barrier] [seed]\n";
+            break;
+        }
+        nextInt(p, ice);
+        nextInt(p, swamp);
+        nextInt(p, barrier);
+        nextU64(p, seed);
+
+        GameConfig cfg = makeConfig(mode, layers, shape, ice != 0, swamp != 0, barrier != 0);
+        cfg.seed = seed;
+
+        int id = open(cfg);
+        if (id < 0) {
+            out << "err pool full\n";
+            break;
+        }
+        Session& s = pool_[id];
+        settle(s);
+        printStatus(id, s, out, true);
+        break;
+    }
+    case HostCommand::Click: {
+        int id, row, col;
+        if (!nextInt(p, id) || !nextInt(p, row) || !nextInt(p, col)) {
+            out << "err usage: click <id> <row> <col>\n";
+            break;
+        }
+        Session* s = get(id);
+        if (!s) {
+            out << "err no session\n";
+            break;
+        }
+        sf::Event event;
+        event.type = sf::Event::MouseButtonPressed;
+        event.mouseButton.button = sf::Mouse::Left;
+        event.mouseButton.x = static_cast<int>((col + 0.5f) * s->rt.cellSize);
+        event.mouseButton.y = static_cast<int>((row + 0.5f) * s->rt.cellSize);
+        if (s->state == GameState::Playing) {
+            handlePlaying(event, s->state, s->rt);
+        }
+        settle(*s);
+        printStatus(id, *s, out);
+        break;
+    }
+    case HostCommand::Key: {
+        int id;
+        const char* name;
+        int nameLen;
+        if (!nextInt(p, id) || !nextToken(p, name, nameLen)) {
+            out << "err usage: key <id> <q|e|z|r|esc>\n";
+            break;
+        }
+        Session* s = get(id);
+        if (!s) {
+            out << "err no session\n";
+            break;
+        }
+        sf::Event event;
+        event.type = sf::Event::KeyPressed;
+        event.key = {};
+        if      (tokenIs(name, nameLen, "q"))   event.key.code = sf::Keyboard::Q;
+        else if (tokenIs(name, nameLen, "e"))   event.key.code = sf::Keyboard::E;
+        else if (tokenIs(name, nameLen, "z"))   event.key.code = sf::Keyboard::Z;
+        else if (tokenIs(name, nameLen, "r"))   event.key.code = sf::Keyboard::R;
+        else if (tokenIs(name, nameLen, "esc")) event.key.code = sf::Keyboard::Escape;
+        else {
+            out << "err unknown key\n";
+            break;
+        }
+        // 重开时恢复 Playing，和窗口版 R 键的效果一致
+        if (event.key.code == sf::Keyboard::R) {
+            s->state = GameState::Playing;
+            s->win   = false;
+            restartGame(s->rt);
+        } else if (s->state == GameState::Playing) {
+            handlePlaying(event, s->state, s->rt);
+        }
+        settle(*s);
+        printStatus(id, *s, out);
+        break;
+    }
+    case HostCommand::Show: {
+        int id;
+        Session* s = nextInt(p, id) ? get(id) : nullptr;
+        if (!s) {
+            out << "err no session\n";
+            break;
+        }
+        printBoard(id, *s, out);
+        break;
+    }
+    case HostCommand::Close: {
+        int id;
+        if (!nextInt(p, id) || !close(id)) {
+            out << "err no session\n";
+            break;
+        }
+        out << "ok " << id << " closed\n";
+        break;
+    }
+    case HostCommand::Stats:
+        printStats(out);
+        break;
+    case HostCommand::Count:
+        break;
+    }
+
+    auto t1 = std::chrono::steady_clock::now();
+    stats_[static_cast<int>(cmd)].record(static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count()));
+    return true;
+}
+
+void SessionHost::run(std::istream& in, std::ostream& out) {
+    std::string line;
+    line.reserve(128);
+    while (std::getline(in, line)) {
+        if (!handleLine(line, out)) break;
+        out.flush();
+    }
+    // 退出时把统计打到标准错误，不干扰协议输出
+    printStats(std::cerr);
+}
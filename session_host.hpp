@@ -0,0 +1,83 @@
+#pragma once
+// 无窗口多局托管：对象池 + 行协议（标准输入 / 标准输出）
+// 用于自动化测试、机器人对局和压力测试
+#include "game.hpp"
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+
+// 单类命令的耗时统计（按 2 的幂纳秒分桶，记录时不分配内存）
+struct LatencyStats {
+    static constexpr int Buckets = 48;
+
+    std::uint64_t count   = 0;
+    std::uint64_t totalNs = 0;
+    std::uint64_t maxNs   = 0;
+    std::uint64_t buckets[Buckets] = {};
+
+    void record(std::uint64_t ns);
+    std::uint64_t percentile(double p) const;   // 返回所在分桶的上界（纳秒）
+};
+
+// 协议命令
+enum class HostCommand {
+    New,
+    Click,
+    Key,
+    Show,
+    Close,
+    Stats,
+    Count
+};
+
+// 池中的一局游戏：GameRuntime 引用自己的 GameState，因此槽位固定不移动
+struct Session {
+    GameState   state = GameState::Playing;
+    GameRuntime rt;
+    bool        active   = false;
+    bool        win      = false;
+    int         nextFree = -1;
+
+    Session() : rt(state) {}
+    Session(const Session&) = delete;
+    Session& operator=(const Session&) = delete;
+};
+
+class SessionHost {
+public:
+    // 遥测里的会话号是 16 位，编号 0..MaxCapacity-1 都放得下
+    static constexpr int MaxCapacity = 65535;
+
+    explicit SessionHost(int capacity);   // 超出 1..MaxCapacity 的容量按边界截取
+
+    int      open(const GameConfig& cfg);   // 返回会话编号，池满返回 -1
+    bool     close(int id);
+    Session* get(int id);
+
+    // 遥测：之后新开的会话都写进这个日志（为空时不记录）
+    void setTelemetry(TelemetryLog* log) { telemetry_ = log; }
+
+    int capacity()    const { return capacity_; }
+    int activeCount() const { return active_; }
+
+    // 处理一行命令，回复写入 out；收到 quit 时返回 false
+    bool handleLine(const std::string& line, std::ostream& out);
+    void run(std::istream& in, std::ostream& out);
+    void printStats(std::ostream& out) const;
+
+private:
+    void settle(Session& s);                // 立即播完动画并结算
+    void printStatus(int id, const Session& s, std::ostream& out, bool withSeed = false) const;
+    void printBoard(int id, const Session& s, std::ostream& out) const;
+
+    std::unique_ptr<Session[]> pool_;
+    int capacity_ = 0;
+    int freeHead_ = -1;
+    int active_   = 0;
+    TelemetryLog* telemetry_ = nullptr;
+
+    LatencyStats stats_[static_cast<int>(HostCommand::Count)];
+    std::chrono::steady_clock::time_point start_;
+};
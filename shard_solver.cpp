@@ -0,0 +1,588 @@
+// 多进程分片求解
+#include "shard_solver.hpp"
+#include "solver.hpp"
+#include <chrono>
+
+#ifdef _WIN32
+
+ShardReport runShardedSolve(const std::vector<Board>&, GameMode, const ShardConfig&) {
+    ShardReport report;
+    report.error = "sharded solve needs fork/pipe (POSIX only)";
+    return report;
+}
+
+#else
+
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_set>
+#include <climits>
+#include <cerrno>
+#include <csignal>
+#include <poll.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// ===== 消息格式 =====
+
+enum : std::uint32_t {
+    MSG_DATA = 1,    // 数据管道：一批后继局面
+    MSG_END  = 2,    // 数据管道：某进程本层发完了
+    MSG_QUIT = 3,    // 数据管道：让读线程退出
+    MSG_GO   = 10,   // 控制管道：开始展开某层
+    MSG_STOP = 11,   // 控制管道：结束
+    MSG_DONE = 20    // 结果管道：本进程本层完成
+};
+
+struct MsgHeader {
+    std::uint32_t type;
+    std::uint32_t level;
+    std::uint32_t count;
+    std::uint32_t from;
+};
+
+struct DoneMsg {
+    MsgHeader    header;
+    std::int64_t expanded;
+    std::int64_t next;
+    std::int64_t wins;
+    std::int64_t saved;     // 下一层的分片检查点写成功为 1（恢复时本层分片还要读成功）
+};
+
+// 多个进程写同一条管道时，不超过 PIPE_BUF 的写入是原子的
+static const std::size_t MAX_MESSAGE = PIPE_BUF;
+
+static bool writeFully(int fd, const void* buf, std::size_t n) {
+    const char* p = static_cast<const char*>(buf);
+    while (n > 0) {
+        ssize_t w = ::write(fd, p, n);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += w;
+        n -= static_cast<std::size_t>(w);
+    }
+    return true;
+}
+
+static bool readFully(int fd, void* buf, std::size_t n) {
+    char* p = static_cast<char*>(buf);
+    while (n > 0) {
+        ssize_t r = ::read(fd, p, n);
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        if (r == 0) return false;
+        p += r;
+        n -= static_cast<std::size_t>(r);
+    }
+    return true;
+}
+
+// ===== 一层的边界：记录 = 8 字节归一哈希 + 各层紧凑编码 =====
+
+struct Frontier {
+    std::unordered_set<std::uint64_t> keys;
+    std::vector<std::uint8_t>         data;
+
+    void add(const std::uint8_t* record, std::size_t recordSize) {
+        std::uint64_t key;
+        std::memcpy(&key, record, sizeof(key));
+        if (!keys.insert(key).second) return;
+        data.insert(data.end(), record, record + recordSize);
+    }
+    void clear() {
+        keys.clear();
+        data.clear();
+    }
+};
+
+struct ShardContext {
+    int                workers    = 0;
+    std::size_t        recordSize = 0;
+    std::vector<Board> root;          // 解码模板（特殊格布局与初始局面相同）
+    GameMode           mode       = GameMode::Classic;
+    std::string        dir;
+    std::vector<int>   dataRead;      // 每个进程自己的数据管道读端
+    std::vector<int>   dataWrite;     // 所有进程数据管道写端
+    std::vector<int>   controlRead;
+    std::vector<int>   controlWrite;
+    std::vector<int>   resultRead;    // 每个进程一条结果管道：进程退出时协调进程能读到 EOF
+    std::vector<int>   resultWrite;
+};
+
+// FNV 哈希低位分布不均，先乘法打散再取高位
+static int ownerOf(std::uint64_t key, int workers) {
+    std::uint64_t h = key * 0x9E3779B97F4A7C15ULL;
+    return static_cast<int>((h >> 32) % static_cast<std::uint64_t>(workers));
+}
+
+static std::string shardPath(const std::string& dir, int worker, int level) {
+    return dir + "/shard-" + std::to_string(worker) + "-" + std::to_string(level) + ".bin";
+}
+
+static bool saveFrontier(const std::string& path, const Frontier& f, std::size_t recordSize) {
+    std::string tmp = path + ".tmp";
+    std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+    std::uint64_t count = f.data.size() / recordSize;
+    out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    out.write(reinterpret_cast<const char*>(f.data.data()),
+              static_cast<std::streamsize>(f.data.size()));
+    out.close();
+    if (!out) return false;
+    return std::rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+static bool loadFrontier(const std::string& path, Frontier& f, std::size_t recordSize) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    std::uint64_t count = 0;
+    in.read(reinterpret_cast<char*>(&count), sizeof(count));
+    std::vector<std::uint8_t> record(recordSize);
+    for (std::uint64_t i = 0; i < count; ++i) {
+        in.read(reinterpret_cast<char*>(record.data()), static_cast<std::streamsize>(recordSize));
+        if (!in) return false;
+        f.add(record.data(), recordSize);
+    }
+    return true;
+}
+
+static void encodeRecord(const std::vector<Board>& floors, std::uint64_t key, std::uint8_t* out) {
+    std::memcpy(out, &key, sizeof(key));
+    out += sizeof(key);
+    for (const auto& b : floors) {
+        b.packCells(out);
+        out += Board::PackedSize;
+    }
+}
+
+static void decodeRecord(const std::uint8_t* in, std::vector<Board>& floors) {
+    in += sizeof(std::uint64_t);
+    for (auto& b : floors) {
+        b.unpackCells(in);
+        in += Board::PackedSize;
+    }
+}
+
+// ===== 工作进程 =====
+
+static int workerMain(int id, ShardContext& ctx, int startLevel) {
+    const int         n          = ctx.workers;
+    const std::size_t recordSize = ctx.recordSize;
+
+    Frontier sets[2];
+    // 读不到也照常参加这一层（别的进程在等它的结束标记），在第一条结果里报告失败
+    bool loaded = loadFrontier(shardPath(ctx.dir, id, startLevel), sets[startLevel & 1], recordSize);
+
+    std::mutex              mutex;
+    std::condition_variable cv;
+    int                     endCount[2] = {0, 0};
+
+    // 读线程：一直排空自己的数据管道，发送方就不会互相堵死
+    std::thread reader([&] {
+        std::vector<std::uint8_t> buf(MAX_MESSAGE);
+        while (true) {
+            MsgHeader h;
+            if (!readFully(ctx.dataRead[id], &h, sizeof(h))) return;
+            if (h.type == MSG_QUIT) return;
+            int slot = (h.level + 1) & 1;
+            if (h.type == MSG_END) {
+                std::lock_guard<std::mutex> lock(mutex);
+                endCount[slot]++;
+                cv.notify_all();
+                continue;
+            }
+            std::size_t bytes = h.count * recordSize;
+            if (!readFully(ctx.dataRead[id], buf.data(), bytes)) return;
+            std::lock_guard<std::mutex> lock(mutex);
+            for (std::uint32_t i = 0; i < h.count; ++i) {
+                sets[slot].add(buf.data() + i * recordSize, recordSize);
+            }
+        }
+    });
+
+    SolveGoal goal = goalForMode(ctx.mode, ctx.root);
+
+    // 每个目标进程一个发送缓冲，攒满一条原子消息再写
+    const std::uint32_t batch = static_cast<std::uint32_t>(
+        (MAX_MESSAGE - sizeof(MsgHeader)) / recordSize);
+    std::vector<std::vector<std::uint8_t>> out(n);
+    std::vector<std::uint32_t>             outCount(n, 0);
+    for (auto& o : out) o.resize(sizeof(MsgHeader) + batch * recordSize);
+
+    auto flush = [&](int dst, std::uint32_t level) {
+        if (outCount[dst] == 0) return;
+        MsgHeader h{MSG_DATA, level, outCount[dst], static_cast<std::uint32_t>(id)};
+        std::memcpy(out[dst].data(), &h, sizeof(h));
+        writeFully(ctx.dataWrite[dst], out[dst].data(), sizeof(h) + outCount[dst] * recordSize);
+        outCount[dst] = 0;
+    };
+
+    std::vector<Board> floors = ctx.root;
+    std::vector<Board> child;
+    std::vector<Jump>  jumps;
+
+    while (true) {
+        MsgHeader cmd;
+        if (!readFully(ctx.controlRead[id], &cmd, sizeof(cmd))) break;
+        if (cmd.type == MSG_STOP) break;
+
+        std::uint32_t level = cmd.level;
+        Frontier& current = sets[level & 1];
+        std::int64_t expanded = static_cast<std::int64_t>(current.data.size() / recordSize);
+        std::int64_t wins = 0;
+
+        for (std::size_t off = 0; off < current.data.size(); off += recordSize) {
+            decodeRecord(current.data.data() + off, floors);
+            collectFloorJumps(floors, jumps);
+
+            if (jumps.empty()) {
+                bool hasMove = false;
+                for (const auto& b : floors) {
+                    if (b.hasMove()) hasMove = true;
+                }
+                if (!hasMove && goal.isWin(floors)) ++wins;
+                continue;
+            }
+
+            for (const auto& j : jumps) {
+                child = floors;
+                MoveResult mv;
+                applyFloorMove(child, j.floor, j.r1, j.c1, j.r2, j.c2, mv);
+                if (goal.isDead && goal.isDead(child, mv)) continue;
+
+                std::uint64_t key = floorsCanonicalHash(child);
+                int dst = ownerOf(key, n);
+                encodeRecord(child, key,
+                             out[dst].data() + sizeof(MsgHeader) + outCount[dst] * recordSize);
+                if (++outCount[dst] == batch) flush(dst, level);
+            }
+        }
+
+        for (int dst = 0; dst < n; ++dst) flush(dst, level);
+        MsgHeader end{MSG_END, level, 0, static_cast<std::uint32_t>(id)};
+        for (int dst = 0; dst < n; ++dst) writeFully(ctx.dataWrite[dst], &end, sizeof(end));
+
+        current.clear();
+
+        // 等所有进程（含自己）都发完本层
+        int nextSlot = (level + 1) & 1;
+        std::int64_t nextCount;
+        bool         saved;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [&] { return endCount[nextSlot] == n; });
+            endCount[nextSlot] = 0;
+            nextCount = static_cast<std::int64_t>(sets[nextSlot].data.size() / recordSize);
+            saved = loaded && saveFrontier(shardPath(ctx.dir, id, level + 1), sets[nextSlot], recordSize);
+            loaded = true;
+        }
+
+        DoneMsg done;
+        done.header   = MsgHeader{MSG_DONE, level, 0, static_cast<std::uint32_t>(id)};
+        done.expanded = expanded;
+        done.next     = nextCount;
+        done.wins     = wins;
+        done.saved    = saved ? 1 : 0;
+        writeFully(ctx.resultWrite[id], &done, sizeof(done));
+    }
+
+    MsgHeader quit{MSG_QUIT, 0, 0, static_cast<std::uint32_t>(id)};
+    writeFully(ctx.dataWrite[id], &quit, sizeof(quit));
+    reader.join();
+    return 0;
+}
+
+// ===== 检查点 =====
+
+static const char SHARD_MAGIC[8] = {'P','E','G','S','H','R','D','1'};
+
+static bool saveRoot(const ShardContext& ctx) {
+    std::ofstream out(ctx.dir + "/root.bin", std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+    std::uint32_t head[3] = {
+        static_cast<std::uint32_t>(ctx.mode),
+        static_cast<std::uint32_t>(ctx.root.size()),
+        static_cast<std::uint32_t>(ctx.workers)
+    };
+    out.write(SHARD_MAGIC, sizeof(SHARD_MAGIC));
+    out.write(reinterpret_cast<const char*>(head), sizeof(head));
+    std::vector<std::uint8_t> cells(Board::PackedSize);
+    for (const auto& b : ctx.root) {
+        b.packCells(cells.data());
+        out.write(reinterpret_cast<const char*>(cells.data()), Board::PackedSize);
+    }
+    return static_cast<bool>(out);
+}
+
+static bool loadRoot(ShardContext& ctx) {
+    std::ifstream in(ctx.dir + "/root.bin", std::ios::binary);
+    if (!in) return false;
+    char magic[8];
+    std::uint32_t head[3];
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(head), sizeof(head));
+    if (!in || std::memcmp(magic, SHARD_MAGIC, sizeof(magic)) != 0) return false;
+
+    ctx.mode    = static_cast<GameMode>(head[0]);
+    ctx.workers = static_cast<int>(head[2]);
+    ctx.root.assign(head[1], Board(ctx.mode));
+    std::vector<std::uint8_t> cells(Board::PackedSize);
+    for (auto& b : ctx.root) {
+        in.read(reinterpret_cast<char*>(cells.data()), Board::PackedSize);
+        b.unpackCells(cells.data());
+    }
+    return static_cast<bool>(in);
+}
+
+// state.txt：已完成到第几层、累计胜局数、每层局面数
+static bool saveState(const std::string& dir, int level, long long wins,
+                      const std::vector<long long>& counts)
+{
+    std::string tmp = dir + "/state.txt.tmp";
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        if (!out) return false;
+        out << "level " << level << "\n";
+        out << "wins " << wins << "\n";
+        out << "counts";
+        for (long long c : counts) out << " " << c;
+        out << "\n";
+        out.close();
+        if (!out) return false;
+    }
+    return std::rename(tmp.c_str(), (dir + "/state.txt").c_str()) == 0;
+}
+
+static bool loadState(const std::string& dir, int& level, long long& wins,
+                      std::vector<long long>& counts)
+{
+    std::ifstream in(dir + "/state.txt");
+    if (!in) return false;
+    std::string word, line;
+    in >> word >> level >> word >> wins >> word;
+    std::getline(in, line);
+    std::istringstream ss(line);
+    long long c;
+    counts.clear();
+    while (ss >> c) counts.push_back(c);
+    return static_cast<bool>(in);
+}
+
+// ===== 协调进程 =====
+
+ShardReport runShardedSolve(const std::vector<Board>& floors, GameMode mode,
+                            const ShardConfig& cfg)
+{
+    ShardReport report;
+    auto t0 = std::chrono::steady_clock::now();
+
+    ShardContext ctx;
+    ctx.dir = cfg.checkpointDir;
+    ::mkdir(ctx.dir.c_str(), 0755);   // 已存在也无妨
+
+    int level = 0;
+    if (cfg.resume) {
+        if (!loadRoot(ctx) || !loadState(ctx.dir, level, report.wins, report.levelCounts)) {
+            report.error = "no checkpoint in " + ctx.dir;
+            return report;
+        }
+    } else {
+        ctx.workers = cfg.workers > 0 ? cfg.workers : 1;
+        ctx.mode    = mode;
+        ctx.root    = floors;
+        if (!saveRoot(ctx)) {
+            report.error = "cannot write " + ctx.dir + "/root.bin";
+            return report;
+        }
+        // 第 0 层：初始局面交给它所属的进程
+        std::uint64_t key = floorsCanonicalHash(floors);
+        int owner = ownerOf(key, ctx.workers);
+        ctx.recordSize = sizeof(std::uint64_t) + floors.size() * Board::PackedSize;
+        for (int i = 0; i < ctx.workers; ++i) {
+            Frontier f;
+            if (i == owner) {
+                std::vector<std::uint8_t> rec(ctx.recordSize);
+                encodeRecord(floors, key, rec.data());
+                f.add(rec.data(), ctx.recordSize);
+            }
+            if (!saveFrontier(shardPath(ctx.dir, i, 0), f, ctx.recordSize)) {
+                report.error = "cannot write " + shardPath(ctx.dir, i, 0);
+                return report;
+            }
+        }
+        if (!saveState(ctx.dir, 0, 0, report.levelCounts)) {
+            report.error = "cannot write " + ctx.dir + "/state.txt";
+            return report;
+        }
+    }
+    ctx.recordSize = sizeof(std::uint64_t) + ctx.root.size() * Board::PackedSize;
+    report.startLevel = level;
+
+    const int n = ctx.workers;
+    if (sizeof(MsgHeader) + ctx.recordSize > MAX_MESSAGE) {
+        report.error = "record too large for an atomic pipe write";
+        return report;
+    }
+
+    // 管道：每个进程一条数据管道、一条控制管道、一条结果管道
+    ctx.dataRead.resize(n);
+    ctx.dataWrite.resize(n);
+    ctx.controlRead.resize(n);
+    ctx.controlWrite.resize(n);
+    ctx.resultRead.resize(n);
+    ctx.resultWrite.resize(n);
+    for (int i = 0; i < n; ++i) {
+        int d[2] = {-1, -1}, c[2] = {-1, -1}, r[2] = {-1, -1};
+        if (pipe(d) != 0 || pipe(c) != 0 || pipe(r) != 0) {
+            // 失败时 pipe 不改数组：这一轮开成的和前几轮的都关掉再返回
+            for (int fd : {d[0], d[1], c[0], c[1], r[0], r[1]}) {
+                if (fd >= 0) ::close(fd);
+            }
+            for (int j = 0; j < i; ++j) {
+                ::close(ctx.dataRead[j]);
+                ::close(ctx.dataWrite[j]);
+                ::close(ctx.controlRead[j]);
+                ::close(ctx.controlWrite[j]);
+                ::close(ctx.resultRead[j]);
+                ::close(ctx.resultWrite[j]);
+            }
+            report.error = "pipe failed";
+            return report;
+        }
+        ctx.dataRead[i]     = d[0];
+        ctx.dataWrite[i]    = d[1];
+        ctx.controlRead[i]  = c[0];
+        ctx.controlWrite[i] = c[1];
+        ctx.resultRead[i]   = r[0];
+        ctx.resultWrite[i]  = r[1];
+    }
+
+    // 有进程退出后，往它的管道写会得到 EPIPE，而不是把整个进程（含子进程）杀掉
+    void (*oldPipeHandler)(int) = std::signal(SIGPIPE, SIG_IGN);
+
+    std::fflush(nullptr);
+    std::vector<pid_t> pids;
+    for (int i = 0; i < n; ++i) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            report.error = "fork failed";
+            break;
+        }
+        if (pid == 0) {
+            // 工作进程：只留下自己要用的管道端
+            for (int j = 0; j < n; ++j) {
+                if (j != i) {
+                    ::close(ctx.dataRead[j]);
+                    ::close(ctx.controlRead[j]);
+                    ::close(ctx.resultWrite[j]);
+                }
+                ::close(ctx.controlWrite[j]);
+                ::close(ctx.resultRead[j]);
+            }
+            _exit(workerMain(i, ctx, level));
+        }
+        pids.push_back(pid);
+    }
+
+    // 协调进程不收发数据
+    for (int i = 0; i < n; ++i) {
+        ::close(ctx.dataRead[i]);
+        ::close(ctx.dataWrite[i]);
+        ::close(ctx.controlRead[i]);
+        ::close(ctx.resultWrite[i]);
+    }
+
+    bool lost = false;
+    if (static_cast<int>(pids.size()) == n) {
+        while (true) {
+            MsgHeader go{MSG_GO, static_cast<std::uint32_t>(level), 0, 0};
+            for (int i = 0; i < n; ++i) {
+                if (!writeFully(ctx.controlWrite[i], &go, sizeof(go))) lost = true;
+            }
+
+            // 同时等所有结果管道：哪个进程中途退出，它的管道立即 EOF，
+            // 不会因为按顺序读而卡在一个永远等不到别人的进程上
+            long long expanded = 0, next = 0, wins = 0;
+            bool      saved = true;
+            std::vector<pollfd> waiting;
+            for (int i = 0; i < n && !lost; ++i) waiting.push_back(pollfd{ctx.resultRead[i], POLLIN, 0});
+            while (!waiting.empty() && !lost) {
+                if (::poll(waiting.data(), waiting.size(), -1) < 0) {
+                    if (errno == EINTR) continue;
+                    lost = true;
+                    break;
+                }
+                for (std::size_t i = 0; i < waiting.size();) {
+                    if (waiting[i].revents == 0) {
+                        ++i;
+                        continue;
+                    }
+                    DoneMsg done;
+                    if (!readFully(waiting[i].fd, &done, sizeof(done))) {
+                        lost = true;
+                        break;
+                    }
+                    expanded += done.expanded;
+                    next     += done.next;
+                    wins     += done.wins;
+                    saved     = saved && done.saved != 0;
+                    waiting.erase(waiting.begin() + static_cast<std::ptrdiff_t>(i));
+                }
+            }
+            if (lost) {
+                report.error = "worker exited unexpectedly";
+                break;
+            }
+            // 新一层的检查点没写全就不能动上一层的分片，否则中断后无处恢复
+            if (!saved) {
+                report.error = "cannot read or write shard checkpoints in " + ctx.dir;
+                break;
+            }
+            report.levelCounts.push_back(expanded);
+            report.wins += wins;
+            if (!saveState(ctx.dir, level + 1, report.wins, report.levelCounts)) {
+                report.levelCounts.pop_back();
+                report.wins -= wins;
+                report.error = "cannot write " + ctx.dir + "/state.txt";
+                break;
+            }
+            ++level;
+            for (int i = 0; i < n; ++i) {
+                std::remove(shardPath(ctx.dir, i, level - 1).c_str());
+            }
+            if (next == 0) {
+                report.ok = true;
+                break;
+            }
+        }
+    }
+
+    // 少了一个进程，其余的会一直等它的本层结束标记，只能直接结束
+    MsgHeader stop{MSG_STOP, 0, 0, 0};
+    for (int i = 0; i < n; ++i) {
+        if (!lost) writeFully(ctx.controlWrite[i], &stop, sizeof(stop));
+        ::close(ctx.controlWrite[i]);
+    }
+    if (lost) {
+        for (pid_t pid : pids) ::kill(pid, SIGKILL);
+    }
+    for (pid_t pid : pids) waitpid(pid, nullptr, 0);
+    for (int i = 0; i < n; ++i) ::close(ctx.resultRead[i]);
+    std::signal(SIGPIPE, oldPipeHandler);
+
+    report.solvable = report.wins > 0;
+    report.seconds  = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return report;
+}
+
+#endif
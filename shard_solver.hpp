@@ -0,0 +1,27 @@
+#pragma once
+// 多进程分片求解（仅 Linux / POSIX）：
+// 协调进程 fork 出 N 个工作进程，每个进程按对称归一哈希拥有一片局面空间。
+// 按层（每跳少一颗棋子）同步推进：各自展开本片局面，后继局面成批经管道
+// 转发给其所属进程去重；每层结束把下一层的边界写盘，中断后可续跑。
+#include "board.hpp"
+#include <string>
+#include <vector>
+
+struct ShardConfig {
+    int         workers       = 4;
+    std::string checkpointDir = "shard_ckpt";   // 不存在时自动创建
+    bool        resume        = false;          // 从检查点继续（忽略传入的局面）
+};
+
+struct ShardReport {
+    bool                   ok       = false;    // 运行是否成功
+    std::string            error;
+    bool                   solvable = false;    // 存在可达的胜利终局
+    long long              wins     = 0;        // 可达的胜利终局数（对称归一后）
+    std::vector<long long> levelCounts;         // 每层不同局面数（对称归一后）
+    int                    startLevel = 0;      // 续跑时从第几层开始
+    double                 seconds  = 0.0;
+};
+
+ShardReport runShardedSolve(const std::vector<Board>& floors, GameMode mode,
+                            const ShardConfig& cfg);
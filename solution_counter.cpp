@@ -0,0 +1,323 @@
+// 解法计数
+#include "solution_counter.hpp"
+#include "position_codec.hpp"
+#include "solver.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+// ===== 128 位计数 =====
+
+SolutionCount& SolutionCount::operator+=(const SolutionCount& o) {
+    std::uint64_t newLo = lo + o.lo;
+    std::uint64_t carry = newLo < lo ? 1 : 0;
+    std::uint64_t newHi = hi + o.hi;
+    bool overflow = newHi < hi;
+    std::uint64_t withCarry = newHi + carry;
+    overflow = overflow || withCarry < newHi;
+
+    if (overflow || saturated() || o.saturated()) {
+        lo = hi = ~0ULL;
+    } else {
+        lo = newLo;
+        hi = withCarry;
+    }
+    return *this;
+}
+
+std::string SolutionCount::toString() const {
+    // 4 个 32 位段（高位在前），反复除以 10 取余数
+    std::uint32_t limbs[4] = {
+        static_cast<std::uint32_t>(hi >> 32), static_cast<std::uint32_t>(hi),
+        static_cast<std::uint32_t>(lo >> 32), static_cast<std::uint32_t>(lo)
+    };
+    std::string digits;
+    for (;;) {
+        bool zero = true;
+        std::uint64_t rem = 0;
+        for (auto& limb : limbs) {
+            std::uint64_t cur = (rem << 32) | limb;
+            limb = static_cast<std::uint32_t>(cur / 10);
+            rem  = cur % 10;
+            if (limb != 0) zero = false;
+        }
+        digits.push_back(static_cast<char>('0' + rem));
+        if (zero) break;
+    }
+    std::reverse(digits.begin(), digits.end());
+    return digits;
+}
+
+// ===== 共享记忆表：64 片，每片一把锁 + 开放寻址 =====
+//
+// 键是规范局面的 128 位指纹：键不超过 2 个字（单层、单层带国王、两层）时就是键本身，
+// 完全精确；更多层时是两个独立的哈希，冲突概率可以忽略。(0, 0) 表示空槽，
+// 真实局面不会出现（所有层同时没有棋子）。
+
+struct MemoEntry {
+    std::uint64_t a = 0;
+    std::uint64_t b = 0;
+    SolutionCount count;
+};
+
+static std::uint64_t mix64(std::uint64_t x) {
+    x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27; x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+class CountMemo {
+public:
+    static constexpr int Shards = 64;
+
+    CountMemo() {
+        for (auto& s : shards_) s.slots.resize(1024);
+    }
+
+    bool find(std::uint64_t a, std::uint64_t b, SolutionCount& out) {
+        std::uint64_t h = hashOf(a, b);
+        Shard& s = shards_[h >> 58];
+        std::lock_guard<std::mutex> lock(s.mutex);
+        std::size_t mask = s.slots.size() - 1;
+        for (std::size_t i = h & mask;; i = (i + 1) & mask) {
+            const MemoEntry& e = s.slots[i];
+            if (e.a == a && e.b == b) {
+                out = e.count;
+                return true;
+            }
+            if (e.a == 0 && e.b == 0) return false;
+        }
+    }
+
+    void insert(std::uint64_t a, std::uint64_t b, const SolutionCount& count) {
+        std::uint64_t h = hashOf(a, b);
+        Shard& s = shards_[h >> 58];
+        std::lock_guard<std::mutex> lock(s.mutex);
+        if ((s.used + 1) * 10 >= s.slots.size() * 7) grow(s);
+        if (place(s.slots, h, a, b, count)) s.used++;
+    }
+
+    long long size() {
+        long long n = 0;
+        for (auto& s : shards_) {
+            std::lock_guard<std::mutex> lock(s.mutex);
+            n += static_cast<long long>(s.used);
+        }
+        return n;
+    }
+
+private:
+    struct Shard {
+        std::mutex             mutex;
+        std::vector<MemoEntry> slots;
+        std::size_t            used = 0;
+    };
+
+    static std::uint64_t hashOf(std::uint64_t a, std::uint64_t b) {
+        return mix64(a ^ mix64(b + 0x9e3779b97f4a7c15ULL));
+    }
+
+    // 已存在时覆盖（两个线程可能同时算完同一个局面，结果相同），返回是否新增
+    static bool place(std::vector<MemoEntry>& slots, std::uint64_t h,
+                      std::uint64_t a, std::uint64_t b, const SolutionCount& count) {
+        std::size_t mask = slots.size() - 1;
+        for (std::size_t i = h & mask;; i = (i + 1) & mask) {
+            MemoEntry& e = slots[i];
+            if (e.a == a && e.b == b) {
+                e.count = count;
+                return false;
+            }
+            if (e.a == 0 && e.b == 0) {
+                e.a = a;
+                e.b = b;
+                e.count = count;
+                return true;
+            }
+        }
+    }
+
+    static void grow(Shard& s) {
+        std::vector<MemoEntry> bigger(s.slots.size() * 2);
+        for (const auto& e : s.slots) {
+            if (e.a == 0 && e.b == 0) continue;
+            place(bigger, hashOf(e.a, e.b), e.a, e.b, e.count);
+        }
+        s.slots.swap(bigger);
+    }
+
+    Shard shards_[Shards];
+};
+
+// ===== 深度优先计数 =====
+
+class CountSearch {
+public:
+    CountSearch(const PositionCodec& codec, const SolveGoal& goal, CountMemo& memo, int maxDepth)
+        : codec_(codec), goal_(goal), memo_(memo), frames_(maxDepth + 1) {}
+
+    SolutionCount count(const std::vector<Board>& floors, int depth) {
+        Frame& fr = frames_[depth];
+        collectFloorJumps(floors, fr.jumps);
+
+        SolutionCount total;
+        if (fr.jumps.empty()) {
+            // 只剩沼泽上的棋子能动：游戏不会结束，视为失败
+            for (const auto& b : floors) {
+                if (b.hasMove()) return total;
+            }
+            if (goal_.isWin(floors)) total.lo = 1;
+            return total;
+        }
+
+        std::uint64_t a, b;
+        fingerprint(floors, a, b);
+        if (memo_.find(a, b, total)) return total;
+
+        for (std::size_t i = 0; i < fr.jumps.size(); ++i) {
+            const Jump& j = fr.jumps[i];
+            fr.child = floors;
+            MoveResult mv;
+            applyFloorMove(fr.child, j.floor, j.r1, j.c1, j.r2, j.c2, mv);
+            if (goal_.isDead && goal_.isDead(fr.child, mv)) continue;
+            total += count(fr.child, depth + 1);
+        }
+        memo_.insert(a, b, total);
+        return total;
+    }
+
+private:
+    // 每层递归复用自己的走法表和子局面，稳定后不再分配内存
+    struct Frame {
+        std::vector<Jump>  jumps;
+        std::vector<Board> child;
+    };
+
+    void fingerprint(const std::vector<Board>& floors, std::uint64_t& a, std::uint64_t& b) const {
+        PositionKey key = codec_.encode(floors);
+        int words = codec_.words();
+        if (words <= 2) {
+            a = key.w[0];
+            b = words == 2 ? key.w[1] : 0;
+            return;
+        }
+        a = 0x243f6a8885a308d3ULL;
+        b = 0x13198a2e03707344ULL;
+        for (int i = 0; i < words; ++i) {
+            a = mix64(a ^ key.w[i]);
+            b = mix64(b + key.w[i] * 0x9e3779b97f4a7c15ULL);
+        }
+        b |= 1;
+    }
+
+    const PositionCodec& codec_;
+    const SolveGoal&     goal_;
+    CountMemo&           memo_;
+    std::vector<Frame>   frames_;
+};
+
+// ===== 入口 =====
+
+// 根附近按层展开（对称去重），直到局面数够分给各线程
+static std::vector<std::vector<Board>> splitFrontier(const std::vector<Board>& root,
+                                                     const PositionCodec& codec,
+                                                     const SolveGoal& goal,
+                                                     std::size_t want)
+{
+    std::vector<std::vector<Board>> frontier{root};
+    std::vector<Jump> jumps;
+    for (int depth = 0; depth < 8 && frontier.size() < want; ++depth) {
+        std::vector<std::pair<PositionKey, std::vector<Board>>> next;
+        for (const auto& pos : frontier) {
+            collectFloorJumps(pos, jumps);
+            for (const auto& j : jumps) {
+                std::vector<Board> child = pos;
+                MoveResult mv;
+                applyFloorMove(child, j.floor, j.r1, j.c1, j.r2, j.c2, mv);
+                if (goal.isDead && goal.isDead(child, mv)) continue;
+                next.emplace_back(codec.encode(child), std::move(child));
+            }
+        }
+        if (next.empty()) break;
+
+        std::sort(next.begin(), next.end(),
+                  [](const auto& x, const auto& y) { return x.first < y.first; });
+        next.erase(std::unique(next.begin(), next.end(),
+                               [](const auto& x, const auto& y) { return x.first == y.first; }),
+                   next.end());
+        frontier.clear();
+        for (auto& n : next) frontier.push_back(std::move(n.second));
+    }
+    return frontier;
+}
+
+CountReport countSolutions(const std::vector<Board>& floors, GameMode mode,
+                           const CountConfig& cfg)
+{
+    auto start = std::chrono::steady_clock::now();
+    CountReport report;
+
+    int threads = cfg.threads;
+    if (threads <= 0) {
+        threads = static_cast<int>(std::thread::hardware_concurrency());
+        if (threads <= 0) threads = 1;
+    }
+
+    SolveGoal     goal = goalForMode(mode, floors);
+    PositionCodec codec(floors);
+    if (!codec.fits()) {
+        report.error = "too many floors for the position key: " + std::to_string(floors.size()) +
+                       " (at most " + std::to_string(codec.maxFloors()) + ")";
+        return report;
+    }
+    CountMemo     memo;
+    int           maxDepth = floorsPegs(floors) + 1;
+
+    // 并行阶段：各线程从共享队列领取根附近的子局面，结果都进记忆表
+    if (threads > 1) {
+        std::vector<std::vector<Board>> frontier =
+            splitFrontier(floors, codec, goal,
+                          static_cast<std::size_t>(threads) * std::max(1, cfg.splitWidth));
+        std::atomic<std::size_t> nextIndex{0};
+        std::vector<std::thread> pool;
+        for (int t = 0; t < threads; ++t) {
+            pool.emplace_back([&] {
+                CountSearch search(codec, goal, memo, maxDepth);
+                for (;;) {
+                    std::size_t i = nextIndex.fetch_add(1, std::memory_order_relaxed);
+                    if (i >= frontier.size()) break;
+                    search.count(frontier[i], 0);
+                }
+            });
+        }
+        for (auto& th : pool) th.join();
+    }
+
+    // 汇总：根附近的局面都已在记忆表里，这一步很快
+    CountSearch search(codec, goal, memo, maxDepth);
+    std::vector<Jump> jumps;
+    collectFloorJumps(floors, jumps);
+    if (jumps.empty()) {
+        report.total = search.count(floors, 0);
+    }
+    for (const auto& j : jumps) {
+        FirstMoveCount fm;
+        fm.move = j;
+        std::vector<Board> child = floors;
+        MoveResult mv;
+        applyFloorMove(child, j.floor, j.r1, j.c1, j.r2, j.c2, mv);
+        if (!(goal.isDead && goal.isDead(child, mv))) {
+            fm.count = search.count(child, 0);
+        }
+        report.total += fm.count;
+        report.perMove.push_back(fm);
+    }
+
+    report.ok        = true;
+    report.positions = memo.size();
+    report.seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    return report;
+}
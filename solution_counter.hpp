@@ -0,0 +1,43 @@
+#pragma once
+// 解法计数：从一个局面出发，有多少条不同的获胜走法序列（按 collectFloorJumps 的一步算一步）
+//
+// 子局面的解法数只取决于局面本身，所以按规范局面记忆（对称局面解法数相同），
+// 整张“局面图”上每个局面只算一次。根附近先展开若干层，再分给多个线程，记忆表共享。
+#include "board.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 128 位无符号计数；超出时饱和在最大值
+struct SolutionCount {
+    std::uint64_t lo = 0;
+    std::uint64_t hi = 0;
+
+    SolutionCount& operator+=(const SolutionCount& o);
+    bool        isZero()    const { return lo == 0 && hi == 0; }
+    bool        saturated() const { return lo == ~0ULL && hi == ~0ULL; }
+    std::string toString()  const;  // 十进制
+};
+
+struct CountConfig {
+    int threads    = 0;     // 0 = 按 CPU 核数
+    int splitWidth = 64;    // 每个线程至少分到这么多个根附近的子局面才停止展开
+};
+
+struct FirstMoveCount {
+    Jump          move;
+    SolutionCount count;
+};
+
+struct CountReport {
+    bool                        ok = false;
+    std::string                 error;
+    SolutionCount               total;
+    std::vector<FirstMoveCount> perMove;        // 根局面每个合法第一步各自的解法数
+    long long                   positions = 0;  // 记住的不同局面数（对称归一后）
+    double                      seconds   = 0.0;
+};
+
+// 胜利条件与 Solver 相同（goalForMode）；只剩沼泽上的棋子能动的终局算失败
+CountReport countSolutions(const std::vector<Board>& floors, GameMode mode,
+                           const CountConfig& cfg = CountConfig());
@@ -0,0 +1,163 @@
+// 持久化求解缓存
+#include "solve_cache.hpp"
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+// 文件头，占满一个 64 字节缓存行
+struct CacheHeader {
+    char                       magic[8];     // "PEGCACHE"
+    std::atomic<std::uint32_t> state;        // 0 未初始化 / 1 初始化中 / 2 可用 / 3 接手重写中
+    std::uint32_t              version;
+    std::uint64_t              bucketCount;
+    std::atomic<std::uint32_t> generation;   // 每打开一次加一
+    char                       reserved[36];
+};
+static_assert(sizeof(CacheHeader) == 64, "缓存文件头必须是 64 字节");
+
+static const char          CACHE_MAGIC[8] = {'P','E','G','C','A','C','H','E'};
+static const std::uint32_t CACHE_VERSION  = 1;
+
+// 写文件头只是几次赋值；等这么久还没写完，说明负责的进程在中途退出了
+static const int CACHE_INIT_WAIT_MS = 2000;
+
+static bool waitForHeader(const CacheHeader* header) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(CACHE_INIT_WAIT_MS);
+    while (header->state.load() != 2) {
+        if (std::chrono::steady_clock::now() > deadline) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+// data 字段的位布局
+//   0-1   结论：1 无解 / 2 有解（0 表示空槽）
+//   2-9   最少剩余棋子数 + 1（0 表示未知）
+//   10-15 工作量（节点数的 log2）
+//   16-47 代数
+static std::uint64_t packData(const CacheEntry& e, int effortLog, std::uint32_t generation) {
+    std::uint64_t pegs = (e.bestPegs < 0) ? 0 : static_cast<std::uint64_t>(e.bestPegs + 1);
+    if (pegs > 255) pegs = 255;
+    return (e.solvable ? 2ULL : 1ULL)
+         | (pegs << 2)
+         | (static_cast<std::uint64_t>(effortLog & 63) << 10)
+         | (static_cast<std::uint64_t>(generation) << 16);
+}
+
+static CacheEntry unpackData(std::uint64_t data) {
+    CacheEntry e;
+    e.solvable = ((data & 3) == 2);
+    e.bestPegs = static_cast<int>((data >> 2) & 255) - 1;
+    return e;
+}
+
+// 淘汰优先级：代数旧、工作量小的先走
+static std::uint64_t keepScore(std::uint64_t data) {
+    return ((data >> 16) << 6) | ((data >> 10) & 63);
+}
+
+bool SolveCache::open(const std::string& path, std::size_t capacity) {
+    close();
+    std::size_t buckets = (capacity + SlotsPerBucket - 1) / SlotsPerBucket;
+    if (buckets == 0) buckets = 1;
+    std::size_t size = sizeof(CacheHeader) + buckets * SlotsPerBucket * sizeof(Slot);
+
+    if (!file_.openReadWrite(path, size)) return false;
+
+    auto* header = static_cast<CacheHeader*>(file_.data());
+
+    // 第一个打开的进程负责写文件头，其他进程等它写完。
+    // 等超时就由一个等待者接手重写（状态换成 3，之前接手的也死了照样能再接手）；
+    // 接手失败再等一轮还不行，就不用缓存
+    std::uint32_t expected = 0;
+    bool writeHeader = header->state.compare_exchange_strong(expected, 1);
+    if (!writeHeader && !waitForHeader(header)) {
+        expected = header->state.load();
+        writeHeader = expected != 2 && header->state.compare_exchange_strong(expected, 3);
+        if (!writeHeader && !waitForHeader(header)) {
+            file_.close();
+            return false;
+        }
+    }
+    if (writeHeader) {
+        std::memcpy(header->magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+        header->version     = CACHE_VERSION;
+        header->bucketCount = buckets;
+        header->generation.store(0);
+        header->state.store(2);
+    }
+
+    if (std::memcmp(header->magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 ||
+        header->version != CACHE_VERSION ||
+        sizeof(CacheHeader) + header->bucketCount * SlotsPerBucket * sizeof(Slot) > file_.size())
+    {
+        file_.close();
+        return false;
+    }
+
+    bucketCount_ = static_cast<std::size_t>(header->bucketCount);
+    generation_  = header->generation.fetch_add(1) + 1;
+    slots_ = reinterpret_cast<Slot*>(static_cast<char*>(file_.data()) + sizeof(CacheHeader));
+    hits_   = 0;
+    misses_ = 0;
+    return true;
+}
+
+void SolveCache::close() {
+    if (slots_) file_.flush();
+    file_.close();
+    slots_       = nullptr;
+    bucketCount_ = 0;
+}
+
+std::uint64_t SolveCache::keyFor(GameMode mode, const std::vector<Board>& floors) {
+    std::uint64_t key = floorsCanonicalHash(floors);
+    key ^= (static_cast<std::uint64_t>(mode) + 1) * 0xC2B2AE3D27D4EB4FULL;
+    return key;
+}
+
+bool SolveCache::lookup(std::uint64_t key, CacheEntry& out) {
+    if (!slots_) return false;
+    Slot* bucket = slots_ + (key % bucketCount_) * SlotsPerBucket;
+    for (int i = 0; i < SlotsPerBucket; ++i) {
+        std::uint64_t data  = bucket[i].data.load(std::memory_order_acquire);
+        std::uint64_t check = bucket[i].check.load(std::memory_order_acquire);
+        if (data != 0 && (check ^ data) == key) {
+            out = unpackData(data);
+            ++hits_;
+            return true;
+        }
+    }
+    ++misses_;
+    return false;
+}
+
+void SolveCache::store(std::uint64_t key, const CacheEntry& entry, long long effort) {
+    if (!slots_) return;
+
+    int effortLog = 0;
+    while (effortLog < 63 && (1LL << (effortLog + 1)) <= effort) ++effortLog;
+    std::uint64_t data = packData(entry, effortLog, generation_);
+
+    Slot* bucket = slots_ + (key % bucketCount_) * SlotsPerBucket;
+
+    // 同一局面直接覆盖；否则用空槽；都没有就淘汰最不值得留的
+    int victim = 0;
+    std::uint64_t victimScore = ~0ULL;
+    for (int i = 0; i < SlotsPerBucket; ++i) {
+        std::uint64_t d = bucket[i].data.load(std::memory_order_relaxed);
+        std::uint64_t c = bucket[i].check.load(std::memory_order_relaxed);
+        if (d == 0 || (c ^ d) == key) {
+            victim = i;
+            break;
+        }
+        std::uint64_t score = keepScore(d);
+        if (score < victimScore) {
+            victimScore = score;
+            victim = i;
+        }
+    }
+
+    bucket[victim].data.store(data, std::memory_order_release);
+    bucket[victim].check.store(key ^ data, std::memory_order_release);
+}
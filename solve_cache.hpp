@@ -0,0 +1,54 @@
+#pragma once
+// 持久化求解缓存：内存映射文件，多进程可同时读写，大小固定，满了按代数/工作量淘汰
+//
+// 文件布局：64 字节文件头 + bucketCount 个 64 字节桶，每桶 4 个槽位。
+// 每个槽位存 (key ^ data, data) 两个 64 位字，读时校验 key，
+// 被并发写撕裂的槽位校验不过，当作未命中，因此不需要锁。
+#include "board.hpp"
+#include "mapped_file.hpp"
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 缓存的结论
+struct CacheEntry {
+    bool solvable = false;
+    int  bestPegs = -1;     // 能走到的最少棋子数，未知为 -1
+};
+
+class SolveCache {
+public:
+    static constexpr int SlotsPerBucket = 4;
+
+    SolveCache() = default;
+
+    // 打开（不存在则创建）缓存文件；capacity 为最多缓存的局面数
+    bool open(const std::string& path, std::size_t capacity = 1u << 18);
+    void close();
+    bool isOpen() const { return slots_ != nullptr; }
+
+    bool lookup(std::uint64_t key, CacheEntry& out);
+    // effort：得出结论花费的节点数，淘汰时优先留下算得久的
+    void store(std::uint64_t key, const CacheEntry& entry, long long effort);
+
+    // 缓存键：对称归一的多层局面 + 游戏模式
+    static std::uint64_t keyFor(GameMode mode, const std::vector<Board>& floors);
+
+    long long hits()   const { return hits_; }
+    long long misses() const { return misses_; }
+
+private:
+    struct Slot {
+        std::atomic<std::uint64_t> check;   // key ^ data
+        std::atomic<std::uint64_t> data;
+    };
+
+    MappedFile    file_;
+    Slot*         slots_       = nullptr;
+    std::size_t   bucketCount_ = 0;
+    std::uint32_t generation_  = 0;   // 本次打开的代数，越大越新
+
+    long long hits_   = 0;
+    long long misses_ = 0;
+};
@@ -0,0 +1,279 @@
+// 精确求解：按 SolveGoal 判断胜负并剪枝
+#include "solver.hpp"
+
+// ===== 各模式的胜利目标 =====
+
+// 三色不变量：按 (r+c)%3 和 (r-c)%3 把格子各分三类，
+// 每一跳恰好让每类棋子数的奇偶同时翻转。冰滑会破坏这一点，所以有冰格时不用
+struct ColorParity {
+    int a = 0;   // 三位：(r+c)%3 各类的奇偶
+    int b = 0;   // 三位：(r-c)%3 各类的奇偶
+};
+
+static ColorParity cellParity(int r, int c) {
+    ColorParity p;
+    p.a = 1 << ((r + c) % 3);
+    p.b = 1 << (((r - c) % 3 + 3) % 3);
+    return p;
+}
+
+static ColorParity floorsParity(const std::vector<Board>& floors) {
+    ColorParity p;
+    for (const auto& b : floors) {
+        for (int r = 0; r < Board::Rows; ++r) {
+            for (int c = 0; c < Board::Cols; ++c) {
+                if (b.at(r, c) != CellState::Peg) continue;
+                ColorParity cp = cellParity(r, c);
+                p.a ^= cp.a;
+                p.b ^= cp.b;
+            }
+        }
+    }
+    return p;
+}
+
+static bool hasCellType(const std::vector<Board>& floors, CellType type) {
+    for (const auto& b : floors) {
+        for (int r = 0; r < Board::Rows; ++r) {
+            for (int c = 0; c < Board::Cols; ++c) {
+                if (b.typeAt(r, c) == type) return true;
+            }
+        }
+    }
+    return false;
+}
+
+SolveGoal goalForMode(GameMode mode, const std::vector<Board>& floors) {
+    SolveGoal goal;
+    goal.mode      = mode;
+    goal.cacheable = true;
+
+    switch (mode) {
+    case GameMode::Classic:
+        goal.isWin = [](const std::vector<Board>& f) {
+            return floorsPegs(f) == 1;
+        };
+        break;
+
+    case GameMode::Lattice: {
+        goal.isWin = [](const std::vector<Board>& f) {
+            if (floorsPegs(f) != 1) return false;
+            for (const auto& b : f) {
+                if (isGoalWin(b)) return true;
+            }
+            return false;
+        };
+
+        if (hasCellType(floors, CellType::Ice)) break;
+
+        // 所有 Goal 格（去重坐标）的奇偶目标
+        std::vector<ColorParity> targets;
+        for (const auto& b : floors) {
+            for (int r = 0; r < Board::Rows; ++r) {
+                for (int c = 0; c < Board::Cols; ++c) {
+                    if (b.typeAt(r, c) == CellType::Goal) {
+                        targets.push_back(cellParity(r, c));
+                    }
+                }
+            }
+        }
+        goal.isDead = [targets](const std::vector<Board>& f, const MoveResult&) {
+            // 还要再跳 pegs-1 次才剩一颗；每跳一次三位奇偶整体翻转
+            int pegs = floorsPegs(f);
+            ColorParity p = floorsParity(f);
+            if ((pegs - 1) & 1) {
+                p.a ^= 7;
+                p.b ^= 7;
+            }
+            for (const auto& t : targets) {
+                if (p.a == t.a && p.b == t.b) return false;
+            }
+            return true;
+        };
+        break;
+    }
+
+    case GameMode::Chess:
+        goal.isWin = [](const std::vector<Board>& f) {
+            for (const auto& b : f) {
+                if (isKingAlive(b)) return true;
+            }
+            return false;
+        };
+        // 各层的国王都被吃光才算失败；多层时吃掉一层的国王，别的层还能赢
+        goal.isDead = [](const std::vector<Board>& f, const MoveResult& mv) {
+            if (!mv.kingCaptured) return false;
+            for (const auto& b : f) {
+                if (isKingAlive(b)) return false;
+            }
+            return true;
+        };
+        break;
+    }
+    return goal;
+}
+
+// ===== 搜索 =====
+
+static std::size_t g_memoryBudget = 64u << 20;
+
+void setSolverMemoryBudget(std::size_t bytes) {
+    g_memoryBudget = bytes;
+}
+
+std::size_t solverMemoryBudget() {
+    return g_memoryBudget;
+}
+
+Solver::Solver(const SolveGoal& goal, long long nodeLimit, std::size_t memoryBytes)
+    : goal_(goal), nodeLimit_(nodeLimit),
+      table_(new TranspositionTable(memoryBytes ? memoryBytes : g_memoryBudget))
+{
+}
+
+// 子树节点数达到这个值才写入持久缓存，避免小结论挤掉大结论
+static const long long CACHE_MIN_EFFORT = 256;
+
+SolveResult Solver::solve(const std::vector<Board>& floors) {
+    nodes_      = 0;
+    aborted_    = false;
+    filterUsed_ = false;
+    table_->newSearch();
+    line_.clear();
+    stats_.restartClock();
+
+    SolveResult res;
+
+    std::uint64_t key;
+    CacheEntry entry;
+    if (cacheLookup(floors, key, entry) && !entry.solvable) {
+        res.bestPegs = entry.bestPegs;
+        res.cacheHit = true;
+        return res;
+    }
+
+    std::vector<Board> work = floors;
+    int bestPegs = floorsPegs(floors);
+    res.solved   = search(work, floorsHash(work), bestPegs);
+    res.aborted  = (aborted_ || filterUsed_) && !res.solved;
+    res.bestPegs = bestPegs;
+    res.nodes    = nodes_;
+    if (res.solved) res.line = line_;
+    stats_.flush();
+    return res;
+}
+
+bool Solver::cacheLookup(const std::vector<Board>& floors, std::uint64_t& key, CacheEntry& entry) {
+    if (!cache_ || !goal_.cacheable) return false;
+    key = SolveCache::keyFor(goal_.mode, floors);
+    return cache_->lookup(key, entry);
+}
+
+// bestPegs：返回时为本子树能走到的最少棋子数
+bool Solver::search(std::vector<Board>& floors, std::uint64_t hash, int& bestPegs) {
+    if (++nodes_ > nodeLimit_) {
+        aborted_ = true;
+        return false;
+    }
+    long long startNodes = nodes_;
+    int depth = static_cast<int>(line_.size());
+    stats_.node(depth);
+
+    std::vector<Jump> jumps;
+    collectFloorJumps(floors, jumps);
+    stats_.children(depth, static_cast<int>(jumps.size()));
+
+    if (jumps.empty()) {
+        bestPegs = floorsPegs(floors);
+        // 只剩沼泽上的棋子能动：游戏不会结束，视为失败
+        for (const auto& b : floors) {
+            if (b.hasMove()) return false;
+        }
+        return goal_.isWin(floors);
+    }
+
+    int  knownPegs;
+    bool fromFilter;
+    if (table_->probe(hash, knownPegs, fromFilter)) {
+        if (fromFilter) filterUsed_ = true;
+        if (knownPegs >= 0) bestPegs = knownPegs;
+        stats_.tableHit();
+        stats_.prune(fromFilter ? PruneRule::FilterDead : PruneRule::TableDead);
+        return false;
+    }
+    stats_.tableMiss();
+
+    // 先展开所有子局面，查缓存：已知无解的跳过，已知有解的先走
+    std::vector<std::vector<Board>> children;
+    std::vector<Jump>               childMoves;
+    std::vector<std::uint64_t>      childHashes;
+    int firstUnknown = 0;
+    for (const auto& j : jumps) {
+        std::vector<Board> next = floors;
+        MoveResult mv;
+        applyFloorMove(next, j.floor, j.r1, j.c1, j.r2, j.c2, mv, links_);
+        if (goal_.isDead && goal_.isDead(next, mv)) {
+            stats_.prune(PruneRule::GoalDead);
+            continue;
+        }
+
+        std::uint64_t childHash = floorsHash(next);
+        table_->prefetch(childHash);
+
+        std::uint64_t key;
+        CacheEntry entry;
+        if (cacheLookup(next, key, entry)) {
+            if (!entry.solvable) {
+                if (entry.bestPegs >= 0 && entry.bestPegs < bestPegs) bestPegs = entry.bestPegs;
+                stats_.prune(PruneRule::CacheDead);
+                continue;
+            }
+            children.insert(children.begin() + firstUnknown, std::move(next));
+            childMoves.insert(childMoves.begin() + firstUnknown, j);
+            childHashes.insert(childHashes.begin() + firstUnknown, childHash);
+            ++firstUnknown;
+            continue;
+        }
+        children.push_back(std::move(next));
+        childMoves.push_back(j);
+        childHashes.push_back(childHash);
+    }
+
+    bool filterBefore = filterUsed_;
+    filterUsed_ = false;
+
+    for (int i = 0; i < static_cast<int>(children.size()); ++i) {
+        int childBest = floorsPegs(children[i]);
+        line_.push_back(childMoves[i]);
+        bool won = search(children[i], childHashes[i], childBest);
+        if (childBest < bestPegs) bestPegs = childBest;
+        if (won) {
+            if (cache_ && goal_.cacheable) {
+                CacheEntry e;
+                e.solvable = true;
+                e.bestPegs = bestPegs;
+                cache_->store(SolveCache::keyFor(goal_.mode, floors), e, nodes_ - startNodes + 1);
+            }
+            filterUsed_ = filterBefore || filterUsed_;
+            return true;
+        }
+        line_.pop_back();
+        if (aborted_) {
+            filterUsed_ = filterBefore || filterUsed_;
+            return false;
+        }
+    }
+
+    // 子树里用过布隆过滤器的结论没有被证实：置换表里标成未证实，也不写进持久缓存。
+    // 置换表跨 solve 保留（开局库整批复用一个 Solver），当成已证明会把误判变成永久的“无解”
+    stats_.tableStore(table_->storeDead(hash, bestPegs, nodes_ - startNodes + 1, !filterUsed_));
+    if (cache_ && goal_.cacheable && !filterUsed_ &&
+        nodes_ - startNodes + 1 >= CACHE_MIN_EFFORT) {
+        CacheEntry e;
+        e.solvable = false;
+        e.bestPegs = bestPegs;
+        cache_->store(SolveCache::keyFor(goal_.mode, floors), e, nodes_ - startNodes + 1);
+    }
+    filterUsed_ = filterBefore || filterUsed_;
+    return false;
+}
@@ -0,0 +1,71 @@
+#pragma once
+// 精确求解：深度优先 + 失败局面记忆，胜利条件由 SolveGoal 决定
+#include "board.hpp"
+#include "solve_cache.hpp"
+#include "solver_stats.hpp"
+#include "transposition.hpp"
+#include <functional>
+#include <memory>
+#include <vector>
+
+// 胜利目标：终局判定 + 提前剪枝
+struct SolveGoal {
+    // 无子可走时是否获胜
+    std::function<bool(const std::vector<Board>&)> isWin;
+    // 刚走完一步后是否已不可能获胜；为空表示不剪枝
+    std::function<bool(const std::vector<Board>&, const MoveResult&)> isDead;
+
+    // 只有 goalForMode 生成的目标才能写进持久缓存（缓存键里带着模式）
+    GameMode mode      = GameMode::Classic;
+    bool     cacheable = false;
+};
+
+// 按游戏模式生成目标：
+//   Classic  只剩一颗棋子
+//   Lattice  只剩一颗且在 Goal 上（无冰格时用“三色不变量”剪枝）
+//   Chess    任一层的国王活到无子可走（最后一个国王被吃立即剪枝）
+SolveGoal goalForMode(GameMode mode, const std::vector<Board>& floors);
+
+struct SolveResult {
+    bool              solved  = false;
+    bool              aborted = false;  // 超出节点上限，或“无解”依赖了布隆过滤器，结论未证实
+    std::vector<Jump> line;             // 获胜走法
+    int               bestPegs = -1;    // 搜索到的最少剩余棋子数
+    long long         nodes   = 0;
+    bool              cacheHit = false; // 根局面直接命中缓存
+};
+
+// 置换表默认内存预算（字节），启动时可改；之后新建的 Solver 生效
+void        setSolverMemoryBudget(std::size_t bytes);
+std::size_t solverMemoryBudget();
+
+class Solver {
+public:
+    // memoryBytes 为 0 时用 solverMemoryBudget()
+    explicit Solver(const SolveGoal& goal, long long nodeLimit = 20000000,
+                    std::size_t memoryBytes = 0);
+
+    // 挂上持久缓存：命中无解直接返回，命中有解优先走那一步
+    void setCache(SolveCache* cache) { cache_ = cache; }
+    // 自定义传送链接（对局用的表）；为空时按默认的下一层同坐标
+    void setTeleportLinks(const TeleportLinks* links) { links_ = links; }
+
+    SolveResult solve(const std::vector<Board>& floors);
+
+private:
+    bool search(std::vector<Board>& floors, std::uint64_t hash, int& bestPegs);
+    bool cacheLookup(const std::vector<Board>& floors, std::uint64_t& key, CacheEntry& entry);
+
+    SolveGoal   goal_;
+    long long   nodeLimit_;
+    long long   nodes_      = 0;
+    bool        aborted_    = false;
+    bool        filterUsed_ = false;   // 本次搜索有分支被布隆过滤器剪掉
+    SolveCache* cache_      = nullptr;
+    const TeleportLinks* links_ = nullptr;
+    SolverProbe stats_{"dfs"};         // 深度 = line_ 的长度
+
+    // 已证明无法获胜的局面；跨多次 solve 保留（同一目标下死局永远是死局）
+    std::unique_ptr<TranspositionTable> table_;
+    std::vector<Jump>                   line_;
+};
@@ -0,0 +1,267 @@
+// 求解器计数与 Prometheus 导出
+#include "solver_stats.hpp"
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <vector>
+
+// 一个槽位同一时刻只借给一个 SolverProbe；还回来以后计数保留，下一个同名探针接着累加
+struct SolverStatSlot {
+    std::string solver;
+    int         thread = 0;     // 同名槽位里的编号
+    bool        busy   = false;
+
+    std::atomic<std::uint64_t> nodes{0};
+    std::atomic<std::uint64_t> ttHits{0};
+    std::atomic<std::uint64_t> ttMisses{0};
+    std::atomic<std::uint64_t> ttStores{0};
+    std::atomic<std::uint64_t> ttEvictions{0};
+    std::atomic<std::uint64_t> prunes[PruneRuleCount]    = {};
+    std::atomic<std::uint64_t> depthNodes[StatDepths]    = {};
+    std::atomic<std::uint64_t> depthChildren[StatDepths] = {};
+    std::atomic<std::uint64_t> depthNanos[StatDepths]    = {};
+};
+
+static std::mutex                                   g_slotMutex;
+static std::vector<std::unique_ptr<SolverStatSlot>> g_slots;
+static std::atomic<bool>                            g_exporting{false};
+
+static SolverStatSlot* acquireSlot(const char* solver) {
+    std::lock_guard<std::mutex> lock(g_slotMutex);
+    int sameName = 0;
+    for (auto& s : g_slots) {
+        if (s->solver != solver) continue;
+        if (!s->busy) {
+            s->busy = true;
+            return s.get();
+        }
+        ++sameName;
+    }
+    g_slots.emplace_back(new SolverStatSlot());
+    SolverStatSlot* s = g_slots.back().get();
+    s->solver = solver;
+    s->thread = sameName;
+    s->busy   = true;
+    return s;
+}
+
+static void releaseSlot(SolverStatSlot* slot) {
+    std::lock_guard<std::mutex> lock(g_slotMutex);
+    slot->busy = false;
+}
+
+// 只有持有槽位的线程会写，所以不需要 fetch_add
+static void publish(std::atomic<std::uint64_t>& dst, std::uint64_t delta) {
+    if (delta) dst.store(dst.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+// ===== 探针 =====
+
+SolverProbe::SolverProbe(const char* solver)
+    : lastSample_(std::chrono::steady_clock::now())
+{
+    if (g_exporting.load(std::memory_order_acquire)) slot_ = acquireSlot(solver);
+}
+
+SolverProbe::~SolverProbe() {
+    if (!slot_) return;
+    flush();
+    releaseSlot(slot_);
+}
+
+void SolverProbe::restartClock() {
+    lastSample_ = std::chrono::steady_clock::now();
+}
+
+void SolverProbe::sample(int depth) {
+    if (!slot_) return;
+    auto now = std::chrono::steady_clock::now();
+    local_.depthNanos[depth] += static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(now - lastSample_).count());
+    lastSample_ = now;
+}
+
+void SolverProbe::flush() {
+    untilFlush_ = FlushNodes;
+    if (slot_) {
+        publish(slot_->nodes,       local_.nodes);
+        publish(slot_->ttHits,      local_.ttHits);
+        publish(slot_->ttMisses,    local_.ttMisses);
+        publish(slot_->ttStores,    local_.ttStores);
+        publish(slot_->ttEvictions, local_.ttEvictions);
+        for (int i = 0; i < PruneRuleCount; ++i) publish(slot_->prunes[i], local_.prunes[i]);
+        for (int d = 0; d < StatDepths; ++d) {
+            if (!local_.depthNodes[d] && !local_.depthChildren[d] && !local_.depthNanos[d]) continue;
+            publish(slot_->depthNodes[d],    local_.depthNodes[d]);
+            publish(slot_->depthChildren[d], local_.depthChildren[d]);
+            publish(slot_->depthNanos[d],    local_.depthNanos[d]);
+        }
+    }
+    local_ = SolverCounters();
+}
+
+// ===== 导出 =====
+
+static const char* const PRUNE_NAMES[PruneRuleCount] = {
+    "goal_dead", "cache_dead", "table_dead", "filter_dead", "lower_bound",
+    "bound_order", "chain_continue", "commute", "duplicate"
+};
+
+static std::uint64_t readCounter(const std::atomic<std::uint64_t>& a) {
+    return a.load(std::memory_order_relaxed);
+}
+
+static void writeHeader(std::ofstream& out, const char* name, const char* type, const char* help) {
+    out << "# HELP " << name << " " << help << "\n";
+    out << "# TYPE " << name << " " << type << "\n";
+}
+
+SolverStatsExporter::~SolverStatsExporter() {
+    stop();
+}
+
+bool SolverStatsExporter::start(const std::string& path, int intervalSeconds) {
+    stop();
+    path_            = path;
+    intervalSeconds_ = intervalSeconds > 0 ? intervalSeconds : 1;
+    lastNodes_.clear();
+    lastWrite_ = std::chrono::steady_clock::now();
+    if (!writeNow()) return false;
+
+    g_exporting.store(true, std::memory_order_release);
+    running_ = true;
+    worker_  = std::thread(&SolverStatsExporter::exportLoop, this);
+    return true;
+}
+
+void SolverStatsExporter::stop() {
+    if (!worker_.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    wake_.notify_all();
+    worker_.join();
+    g_exporting.store(false, std::memory_order_release);
+    writeNow();
+}
+
+void SolverStatsExporter::exportLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running_) {
+        wake_.wait_for(lock, std::chrono::seconds(intervalSeconds_));
+        if (!running_) break;
+        lock.unlock();
+        writeNow();
+        lock.lock();
+    }
+}
+
+bool SolverStatsExporter::writeNow() {
+    // 同名槽位先合计：节点速率和按深度的数据按求解器给，其余按线程给
+    struct Totals {
+        std::uint64_t nodes = 0, hits = 0, misses = 0;
+        std::uint64_t depthNodes[StatDepths] = {};
+        std::uint64_t depthChildren[StatDepths] = {};
+        std::uint64_t depthNanos[StatDepths] = {};
+    };
+
+    auto now = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(now - lastWrite_).count();
+
+    std::string tmp = path_ + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        if (!out) return false;
+
+        std::lock_guard<std::mutex> lock(g_slotMutex);
+        std::map<std::string, Totals> totals;
+        for (const auto& s : g_slots) {
+            Totals& t = totals[s->solver];
+            t.nodes  += readCounter(s->nodes);
+            t.hits   += readCounter(s->ttHits);
+            t.misses += readCounter(s->ttMisses);
+            for (int d = 0; d < StatDepths; ++d) {
+                t.depthNodes[d]    += readCounter(s->depthNodes[d]);
+                t.depthChildren[d] += readCounter(s->depthChildren[d]);
+                t.depthNanos[d]    += readCounter(s->depthNanos[d]);
+            }
+        }
+
+        auto perThread = [&](const char* name, const char* help,
+                             const std::atomic<std::uint64_t> SolverStatSlot::*field) {
+            writeHeader(out, name, "counter", help);
+            for (const auto& s : g_slots) {
+                out << name << "{solver=\"" << s->solver << "\",thread=\"" << s->thread << "\"} "
+                    << readCounter((*s).*field) << "\n";
+            }
+        };
+        perThread("peg_solver_nodes_total", "Search nodes expanded.", &SolverStatSlot::nodes);
+        perThread("peg_solver_table_hits_total", "Transposition probes that cut the search.",
+                  &SolverStatSlot::ttHits);
+        perThread("peg_solver_table_misses_total", "Transposition probes that did not cut.",
+                  &SolverStatSlot::ttMisses);
+        perThread("peg_solver_table_stores_total", "Transposition table writes.",
+                  &SolverStatSlot::ttStores);
+        perThread("peg_solver_table_evictions_total", "Table writes that displaced another position.",
+                  &SolverStatSlot::ttEvictions);
+
+        writeHeader(out, "peg_solver_prunes_total", "counter", "Branches cut, by prune rule.");
+        for (const auto& s : g_slots) {
+            for (int i = 0; i < PruneRuleCount; ++i) {
+                std::uint64_t v = readCounter(s->prunes[i]);
+                if (!v) continue;
+                out << "peg_solver_prunes_total{solver=\"" << s->solver << "\",thread=\"" << s->thread
+                    << "\",rule=\"" << PRUNE_NAMES[i] << "\"} " << v << "\n";
+            }
+        }
+
+        writeHeader(out, "peg_solver_nodes_per_second", "gauge", "Nodes per second since the previous export.");
+        for (const auto& kv : totals) {
+            std::uint64_t before = lastNodes_.count(kv.first) ? lastNodes_[kv.first] : 0;
+            double rate = elapsed > 0 ? static_cast<double>(kv.second.nodes - before) / elapsed : 0.0;
+            out << "peg_solver_nodes_per_second{solver=\"" << kv.first << "\"} " << rate << "\n";
+        }
+        writeHeader(out, "peg_solver_table_hit_ratio", "gauge", "Table hits / probes since start.");
+        for (const auto& kv : totals) {
+            std::uint64_t probes = kv.second.hits + kv.second.misses;
+            out << "peg_solver_table_hit_ratio{solver=\"" << kv.first << "\"} "
+                << (probes ? static_cast<double>(kv.second.hits) / static_cast<double>(probes) : 0.0) << "\n";
+        }
+
+        writeHeader(out, "peg_solver_depth_nodes_total", "counter", "Nodes expanded at each depth (last bucket is 63+).");
+        for (const auto& kv : totals) {
+            for (int d = 0; d < StatDepths; ++d) {
+                if (!kv.second.depthNodes[d]) continue;
+                out << "peg_solver_depth_nodes_total{solver=\"" << kv.first << "\",depth=\"" << d << "\"} "
+                    << kv.second.depthNodes[d] << "\n";
+            }
+        }
+        writeHeader(out, "peg_solver_depth_branching", "gauge", "Children generated per node at each depth.");
+        for (const auto& kv : totals) {
+            for (int d = 0; d < StatDepths; ++d) {
+                if (!kv.second.depthNodes[d]) continue;
+                out << "peg_solver_depth_branching{solver=\"" << kv.first << "\",depth=\"" << d << "\"} "
+                    << static_cast<double>(kv.second.depthChildren[d]) / static_cast<double>(kv.second.depthNodes[d])
+                    << "\n";
+            }
+        }
+        writeHeader(out, "peg_solver_depth_seconds_total", "counter", "Sampled search time at each depth.");
+        for (const auto& kv : totals) {
+            for (int d = 0; d < StatDepths; ++d) {
+                if (!kv.second.depthNanos[d]) continue;
+                out << "peg_solver_depth_seconds_total{solver=\"" << kv.first << "\",depth=\"" << d << "\"} "
+                    << static_cast<double>(kv.second.depthNanos[d]) * 1e-9 << "\n";
+            }
+        }
+
+        for (const auto& kv : totals) lastNodes_[kv.first] = kv.second.nodes;
+        if (!out) return false;
+    }
+    lastWrite_ = now;
+#ifdef _WIN32
+    std::remove(path_.c_str());     // Windows 上 rename 不覆盖已有文件
+#endif
+    return std::rename(tmp.c_str(), path_.c_str()) == 0;
+}
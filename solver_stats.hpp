@@ -0,0 +1,111 @@
+#pragma once
+// 求解器计数：展开节点数、置换表命中 / 未命中 / 挤出、各剪枝规则的触发次数、按深度的分支数和耗时
+//
+// 每个搜索线程持有自己的 SolverProbe，热路径上只加普通整数，不碰原子量也不加锁。
+// 每展开 4096 个节点把增量并进一个独占的槽位（同一时刻只有一个写者，原子量只做 relaxed 读写），
+// 导出线程定期把全部槽位写成 Prometheus 文本格式，stop 时（退出时）再写一次。
+// 按深度的耗时是采样得来的：每 256 个节点读一次时钟，这段时间记在当时所在的深度上。
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+enum class PruneRule : std::uint8_t {
+    GoalDead,       // 目标判定已不可能获胜（三色奇偶、国王被吃）
+    CacheDead,      // 持久缓存里记着无解
+    TableDead,      // 置换表：已证明的死局 / 剩余步数不够
+    FilterDead,     // 布隆过滤器：被挤出置换表的死局（未证实）
+    LowerBound,     // 步数下界超过剩余步数
+    BoundOrder,     // 子局面按下界排序，后面的全都不够
+    ChainContinue,  // 从上一步的落点起跳（属于上一步的连跳）
+    Commute,        // 与上一步互不相碰，只按一种顺序搜
+    Duplicate,      // 不同走法走到同一局面
+    Count
+};
+
+constexpr int PruneRuleCount = static_cast<int>(PruneRule::Count);
+constexpr int StatDepths     = 64;      // 更深的都记在最后一格
+
+struct SolverCounters {
+    std::uint64_t nodes       = 0;
+    std::uint64_t ttHits      = 0;      // 命中并据此剪掉
+    std::uint64_t ttMisses    = 0;
+    std::uint64_t ttStores    = 0;
+    std::uint64_t ttEvictions = 0;      // 写入时挤掉了别的局面
+    std::uint64_t prunes[PruneRuleCount]    = {};
+    std::uint64_t depthNodes[StatDepths]    = {};
+    std::uint64_t depthChildren[StatDepths] = {};   // 生成的子局面数，除以节点数即分支因子
+    std::uint64_t depthNanos[StatDepths]    = {};   // 采样耗时
+};
+
+struct SolverStatSlot;
+
+class SolverProbe {
+public:
+    static constexpr std::uint64_t SampleNodes = 256;    // 2 的幂
+    static constexpr int           FlushNodes  = 4096;
+
+    // solver 是导出时的标签；导出没开时不占槽位，照样计数但不发布
+    explicit SolverProbe(const char* solver);
+    ~SolverProbe();
+
+    SolverProbe(const SolverProbe&) = delete;
+    SolverProbe& operator=(const SolverProbe&) = delete;
+
+    void node(int depth) {
+        int d = depth < StatDepths ? depth : StatDepths - 1;
+        ++local_.nodes;
+        ++local_.depthNodes[d];
+        if ((local_.nodes & (SampleNodes - 1)) == 0) sample(d);
+        if (--untilFlush_ == 0) flush();
+    }
+    void children(int depth, int n) {
+        local_.depthChildren[depth < StatDepths ? depth : StatDepths - 1] += static_cast<std::uint64_t>(n);
+    }
+    void prune(PruneRule rule, std::uint64_t n = 1) { local_.prunes[static_cast<int>(rule)] += n; }
+    void tableHit()                { ++local_.ttHits; }
+    void tableMiss()               { ++local_.ttMisses; }
+    void tableStore(bool evicted)  { ++local_.ttStores; local_.ttEvictions += evicted ? 1 : 0; }
+
+    void restartClock();            // 空闲之后重新开始一次搜索时调用，空闲时间不算进任何深度
+    void flush();                   // 把本地增量并进槽位
+
+private:
+    void sample(int depth);
+
+    SolverCounters  local_;
+    SolverStatSlot* slot_       = nullptr;
+    int             untilFlush_ = FlushNodes;
+    std::chrono::steady_clock::time_point lastSample_;
+};
+
+// 定期把计数写成 Prometheus 文本（写临时文件再改名，抓取方不会读到半个文件）
+class SolverStatsExporter {
+public:
+    SolverStatsExporter() = default;
+    ~SolverStatsExporter();
+
+    SolverStatsExporter(const SolverStatsExporter&) = delete;
+    SolverStatsExporter& operator=(const SolverStatsExporter&) = delete;
+
+    bool start(const std::string& path, int intervalSeconds);
+    void stop();                    // 再写最后一次
+
+    bool writeNow();
+
+private:
+    void exportLoop();
+
+    std::string             path_;
+    int                     intervalSeconds_ = 5;
+    bool                    running_         = false;
+    std::map<std::string, std::uint64_t>  lastNodes_;   // 上次导出时各求解器的节点数，算速率用
+    std::chrono::steady_clock::time_point lastWrite_;
+    std::mutex              mutex_;
+    std::condition_variable wake_;
+    std::thread             worker_;
+};
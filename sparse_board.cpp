@@ -0,0 +1,466 @@
+// 无边界稀疏棋盘
+#include "sparse_board.hpp"
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <unordered_map>
+
+static const int SPARSE_DR[4] = {-1, 1, 0, 0};
+static const int SPARSE_DC[4] = {0, 0, -1, 1};
+
+// ===== 开放寻址哈希表 =====
+
+void CellMap::rehash(std::size_t capacity) {
+    std::vector<std::uint64_t> oldKeys;
+    std::vector<std::uint32_t> oldValues;
+    oldKeys.swap(keys_);
+    oldValues.swap(values_);
+
+    keys_.assign(capacity, EmptyKey);
+    values_.assign(capacity, 0);
+    shift_ = 64;
+    for (std::size_t c = capacity; c > 1; c >>= 1) --shift_;
+    size_ = 0;
+
+    std::size_t mask = capacity - 1;
+    for (std::size_t i = 0; i < oldKeys.size(); ++i) {
+        if (oldKeys[i] == EmptyKey) continue;
+        std::size_t s = home(oldKeys[i]);
+        while (keys_[s] != EmptyKey) s = (s + 1) & mask;
+        keys_[s]   = oldKeys[i];
+        values_[s] = oldValues[i];
+        ++size_;
+    }
+}
+
+const std::uint32_t* CellMap::find(std::uint64_t key) const {
+    if (key == EmptyKey) return nullptr;
+    std::size_t mask = keys_.size() - 1;
+    for (std::size_t s = home(key); keys_[s] != EmptyKey; s = (s + 1) & mask) {
+        if (keys_[s] == key) return &values_[s];
+    }
+    return nullptr;
+}
+
+std::uint32_t* CellMap::find(std::uint64_t key) {
+    return const_cast<std::uint32_t*>(static_cast<const CellMap*>(this)->find(key));
+}
+
+bool CellMap::insert(std::uint64_t key, std::uint32_t value) {
+    if ((size_ + 1) * 2 > keys_.size()) rehash(keys_.size() * 2);
+    std::size_t mask = keys_.size() - 1;
+    std::size_t s = home(key);
+    for (; keys_[s] != EmptyKey; s = (s + 1) & mask) {
+        if (keys_[s] == key) {
+            values_[s] = value;
+            return false;
+        }
+    }
+    keys_[s]   = key;
+    values_[s] = value;
+    ++size_;
+    return true;
+}
+
+bool CellMap::erase(std::uint64_t key) {
+    if (key == EmptyKey) return false;
+    std::size_t mask = keys_.size() - 1;
+    std::size_t i = home(key);
+    while (keys_[i] != key) {
+        if (keys_[i] == EmptyKey) return false;
+        i = (i + 1) & mask;
+    }
+
+    // 后面同一串里的条目，只要家不在 (i, j] 之间就能挪到空出来的 i
+    for (std::size_t j = (i + 1) & mask; keys_[j] != EmptyKey; j = (j + 1) & mask) {
+        std::size_t h = home(keys_[j]);
+        if (((j - h) & mask) >= ((j - i) & mask)) {
+            keys_[i]   = keys_[j];
+            values_[i] = values_[j];
+            i = j;
+        }
+    }
+    keys_[i] = EmptyKey;
+    --size_;
+
+    if (keys_.size() > MinCapacity && size_ * 8 < keys_.size()) rehash(keys_.size() / 2);
+    return true;
+}
+
+void CellMap::clear() {
+    keys_.clear();
+    values_.clear();
+    rehash(MinCapacity);
+}
+
+// ===== 访问 =====
+
+// Zobrist：每个坐标键一个伪随机数（SplitMix64 的末段混合）
+static std::uint64_t zobrist(std::uint64_t k) {
+    k += 0x9E3779B97F4A7C15ULL;
+    k = (k ^ (k >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    k = (k ^ (k >> 27)) * 0x94D049BB133111EBULL;
+    return k ^ (k >> 31);
+}
+
+CellState SparseBoard::at(int r, int c) const {
+    if (!inRange(r, c) || isBarrier(r, c)) return CellState::Invalid;
+    return hasPeg(r, c) ? CellState::Peg : CellState::Empty;
+}
+
+bool SparseBoard::hasPeg(int r, int c) const {
+    return inRange(r, c) && pegs_.contains(key(r, c));
+}
+
+bool SparseBoard::open(int r, int c) const {
+    return inRange(r, c) && !pegs_.contains(key(r, c)) && !barriers_.contains(key(r, c));
+}
+
+void SparseBoard::setPeg(int r, int c, bool peg) {
+    if (!inRange(r, c)) return;
+    if (peg) {
+        if (hasPeg(r, c) || isBarrier(r, c)) return;
+        addPeg(r, c);
+    } else {
+        if (!hasPeg(r, c)) return;
+        removePeg(r, c);
+    }
+    refreshAround(r, c);
+}
+
+void SparseBoard::setBarrier(int r, int c, bool barrier) {
+    if (!inRange(r, c)) return;
+    if (barrier) {
+        if (hasPeg(r, c)) removePeg(r, c);
+        barriers_.insert(key(r, c), 0);
+    } else {
+        barriers_.erase(key(r, c));
+    }
+    refreshAround(r, c);
+}
+
+void SparseBoard::fillRect(int r0, int c0, int r1, int c1) {
+    for (int r = r0; r <= r1; ++r) {
+        for (int c = c0; c <= c1; ++c) setPeg(r, c, true);
+    }
+}
+
+bool SparseBoard::bounds(int& minR, int& minC, int& maxR, int& maxC) const {
+    if (pegs_.size() == 0) return false;
+    minR = minC = MaxCoord;
+    maxR = maxC = -MaxCoord;
+    forEachPeg([&](int r, int c) {
+        minR = std::min(minR, r);
+        minC = std::min(minC, c);
+        maxR = std::max(maxR, r);
+        maxC = std::max(maxC, c);
+    });
+    return true;
+}
+
+std::size_t SparseBoard::memoryBytes() const {
+    return sizeof(*this) + pegs_.bytes() + barriers_.bytes() +
+           movable_.capacity() * sizeof(std::uint64_t);
+}
+
+// ===== 可动棋子表 =====
+
+void SparseBoard::addPeg(int r, int c) {
+    pegs_.insert(key(r, c), NotMovable);
+    hash_ ^= zobrist(key(r, c));
+}
+
+void SparseBoard::removePeg(int r, int c) {
+    std::uint64_t k = key(r, c);
+    std::uint32_t* v = pegs_.find(k);
+    if (!v) return;
+    std::uint32_t idx = *v;
+    if (idx != NotMovable) {
+        movable_[idx] = movable_.back();
+        movable_.pop_back();
+        if (idx < movable_.size()) *pegs_.find(movable_[idx]) = idx;
+    }
+    pegs_.erase(k);
+    hash_ ^= zobrist(k);
+}
+
+bool SparseBoard::pegCanMove(int r, int c) const {
+    for (int d = 0; d < 4; ++d) {
+        if (hasPeg(r + SPARSE_DR[d], c + SPARSE_DC[d]) &&
+            open(r + 2 * SPARSE_DR[d], c + 2 * SPARSE_DC[d])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void SparseBoard::refresh(int r, int c) {
+    if (!inRange(r, c)) return;
+    std::uint32_t* v = pegs_.find(key(r, c));
+    if (!v) return;
+
+    bool can = pegCanMove(r, c);
+    if (can && *v == NotMovable) {
+        *v = static_cast<std::uint32_t>(movable_.size());
+        movable_.push_back(key(r, c));
+    } else if (!can && *v != NotMovable) {
+        std::uint32_t idx = *v;
+        *v = NotMovable;
+        movable_[idx] = movable_.back();
+        movable_.pop_back();
+        if (idx < movable_.size()) *pegs_.find(movable_[idx]) = idx;
+    }
+}
+
+// 棋子能不能动只看四个方向上一格（被跳）和两格（落点），所以一格变了只影响这 9 颗
+void SparseBoard::refreshAround(int r, int c) {
+    refresh(r, c);
+    for (int d = 0; d < 4; ++d) {
+        refresh(r - SPARSE_DR[d], c - SPARSE_DC[d]);
+        refresh(r - 2 * SPARSE_DR[d], c - 2 * SPARSE_DC[d]);
+    }
+}
+
+// ===== 走子 =====
+
+bool SparseBoard::canJump(int r1, int c1, int r2, int c2) const {
+    if (!inRange(r1, c1) || !inRange(r2, c2)) return false;
+    int dr = r2 - r1, dc = c2 - c1;
+    bool straight = (dc == 0 && (dr == 2 || dr == -2)) || (dr == 0 && (dc == 2 || dc == -2));
+    if (!straight) return false;
+    return hasPeg(r1, c1) && hasPeg(r1 + dr / 2, c1 + dc / 2) && open(r2, c2);
+}
+
+void SparseBoard::applyJump(int r1, int c1, int r2, int c2) {
+    int rm = (r1 + r2) / 2, cm = (c1 + c2) / 2;
+    removePeg(r1, c1);
+    removePeg(rm, cm);
+    addPeg(r2, c2);
+    refreshAround(r1, c1);
+    refreshAround(rm, cm);
+    refreshAround(r2, c2);
+}
+
+void SparseBoard::undoJump(int r1, int c1, int r2, int c2) {
+    int rm = (r1 + r2) / 2, cm = (c1 + c2) / 2;
+    removePeg(r2, c2);
+    addPeg(rm, cm);
+    addPeg(r1, c1);
+    refreshAround(r1, c1);
+    refreshAround(rm, cm);
+    refreshAround(r2, c2);
+}
+
+void SparseBoard::collectJumps(std::vector<Jump>& out) const {
+    out.clear();
+    for (std::uint64_t k : movable_) {
+        int r = rowOf(k), c = colOf(k);
+        for (int d = 0; d < 4; ++d) {
+            int r2 = r + 2 * SPARSE_DR[d], c2 = c + 2 * SPARSE_DC[d];
+            if (!hasPeg(r + SPARSE_DR[d], c + SPARSE_DC[d]) || !open(r2, c2)) continue;
+            Jump j;
+            j.r1 = r;
+            j.c1 = c;
+            j.r2 = r2;
+            j.c2 = c2;
+            out.push_back(j);
+        }
+    }
+}
+
+// ===== 推进搜索 =====
+
+static const double PAGODA_PHI = 0.6180339887498949;   // φ² + φ = 1
+static const double PAGODA_EPS = 1e-9;
+static const int    PAGODA_FAR = 1600;                  // 再远的格子权重在 double 里已经是 0
+
+class AdvanceSearch {
+public:
+    static constexpr int Unlimited = 1 << 29;     // 不限跳数的深度优先
+
+    AdvanceSearch(int targetR, int targetC, long long nodeLimit)
+        : targetR_(targetR), targetC_(targetC), nodeLimit_(nodeLimit), power_(PAGODA_FAR)
+    {
+        power_[0] = 1.0;
+        for (int i = 1; i < PAGODA_FAR; ++i) power_[i] = power_[i - 1] * PAGODA_PHI;
+    }
+
+    long long distance(int r, int c) const {
+        return std::llabs(static_cast<long long>(r) - targetR_) +
+               std::llabs(static_cast<long long>(c) - targetC_);
+    }
+    double weight(int r, int c) const {
+        long long d = distance(r, c);
+        return d < PAGODA_FAR ? power_[d] : 0.0;
+    }
+
+    // 按到目标的距离数棋子（太远的都记在最后一格）
+    void count(int r, int c, int delta) {
+        long long d = distance(r, c);
+        atDistance_[d < PAGODA_FAR ? d : PAGODA_FAR - 1] += delta;
+    }
+    void countJump(const Jump& j, int sign) {
+        count(j.r1, j.c1, -sign);
+        count((j.r1 + j.r2) / 2, (j.c1 + j.c2) / 2, -sign);
+        count(j.r2, j.c2, sign);
+    }
+
+    // 最多再跳 budget 次能否让棋子落到目标上。
+    // 朝目标直跳时 φ^(d+2) + φ^(d+1) = φ^d，总和不变；其余方向都会变小。
+    // 局部性：前后相依的两跳共用一格，而一跳只跨两格，所以离目标最近的格子每往回一跳最多远 2；
+    // 还剩 budget 跳时，这一跳最近的格子离目标超过 2 * (budget - 1) 就不可能影响最后一跳，
+    // 不走它的那条兄弟分支一样会搜到。
+    // 由此剩下的跳只碰得到离目标 2 * budget 以内的格子，更远的棋子不会动，宝塔和只算这一圈就够
+    bool search(SparseBoard& b, double pagoda, int depth, int budget) {
+        if (nodes_ >= sliceEnd_) {
+            aborted_ = true;
+            return false;
+        }
+        ++nodes_;
+        if (budget == 0) {
+            budgetCut_ = true;
+            return false;
+        }
+
+        std::uint64_t key = b.hash();
+        auto known = dead_.find(key);
+        if (known != dead_.end() && known->second >= budget) return false;
+
+        double reachable = pagoda;
+        if (2LL * budget < PAGODA_FAR - 1) {
+            reachable = 0.0;
+            for (int d = 0; d <= 2 * budget; ++d) reachable += atDistance_[d] * power_[d];
+        }
+        if (reachable < 1.0 - PAGODA_EPS) {
+            budgetCut_ = true;
+            return false;
+        }
+
+        if (static_cast<int>(frames_.size()) <= depth) frames_.emplace_back();
+        std::vector<Scored>& moves = frames_[depth];
+        b.collectJumps(jumps_);
+        moves.clear();
+        for (const Jump& j : jumps_) {
+            double delta = weight(j.r2, j.c2) - weight(j.r1, j.c1) -
+                           weight((j.r1 + j.r2) / 2, (j.c1 + j.c2) / 2);
+            if (j.r2 == targetR_ && j.c2 == targetC_) {
+                line_.push_back(j);
+                return true;
+            }
+            if (pagoda + delta < 1.0 - PAGODA_EPS) continue;   // 跳完就不够了
+            long long nearest = std::min(distance(j.r2, j.c2),
+                                std::min(distance(j.r1, j.c1), distance((j.r1 + j.r2) / 2, (j.c1 + j.c2) / 2)));
+            if (nearest > 2LL * (budget - 1)) {
+                budgetCut_ = true;
+                continue;
+            }
+            moves.push_back({j, delta, weight(j.r2, j.c2)});
+        }
+        // 宝塔和丢得少的先走（朝目标的直跳不丢），同样的落点离目标近的先走
+        std::stable_sort(moves.begin(), moves.end(), [](const Scored& a, const Scored& b) {
+            if (a.delta != b.delta) return a.delta > b.delta;
+            return a.land > b.land;
+        });
+
+        for (const Scored& m : moves) {
+            b.applyJump(m.j.r1, m.j.c1, m.j.r2, m.j.c2);
+            countJump(m.j, 1);
+            line_.push_back(m.j);
+            if (search(b, pagoda + m.delta, depth + 1, budget - 1)) return true;
+            line_.pop_back();
+            countJump(m.j, -1);
+            b.undoJump(m.j.r1, m.j.c1, m.j.r2, m.j.c2);
+            if (aborted_) return false;
+        }
+        int& proven = dead_[key];
+        proven = std::max(proven, budget);
+        return false;
+    }
+
+    // 两种搜法轮流跑，每轮的节点份额翻 4 倍：
+    //   不限跳数的深度优先，按宝塔和排序一路往前冲，走法长而“顺”的时候很快；
+    //   迭代加深（跳数上限从 1 往上加），走法短的时候很快，满盘宝塔中性的走法会把前者带进很长的死胡同。
+    // 两张死局表都跨轮保留，重跑很便宜，总节点数不超过较快那种的常数倍。
+    // 深度优先跑完，或者某一轮加深从没碰到上限就失败了，都说明到不了
+    bool run(SparseBoard& b, double pagoda, int maxJumps) {
+        int nextBudget = 1;
+        for (long long share = 1024;; share *= 4) {
+            if (!startSlice(share)) return false;
+            if (search(b, pagoda, 0, Unlimited)) return true;
+            if (!aborted_) return false;
+
+            if (!startSlice(share)) return false;
+            for (; nextBudget <= maxJumps; ++nextBudget) {
+                budgetCut_ = false;
+                if (search(b, pagoda, 0, nextBudget)) return true;
+                if (aborted_) break;
+                if (!budgetCut_) return false;
+            }
+            if (nextBudget > maxJumps) return false;
+        }
+    }
+
+    const std::vector<Jump>& line() const { return line_; }
+    long long nodes()   const { return nodes_; }
+    bool      aborted() const { return aborted_; }
+
+private:
+    // 下一段份额；总上限已用完时返回 false（aborted_ 保持为 true）
+    bool startSlice(long long share) {
+        if (nodeLimit_ > 0 && nodes_ >= nodeLimit_) {
+            aborted_ = true;
+            return false;
+        }
+        sliceEnd_ = nodes_ + share;
+        if (nodeLimit_ > 0 && sliceEnd_ > nodeLimit_) sliceEnd_ = nodeLimit_;
+        aborted_ = false;
+        return true;
+    }
+
+    struct Scored {
+        Jump   j;
+        double delta;
+        double land;    // 落点权重
+    };
+
+    int                               targetR_;
+    int                               targetC_;
+    long long                         nodeLimit_;
+    std::vector<double>               power_;
+    std::vector<int>                  atDistance_ = std::vector<int>(PAGODA_FAR, 0);
+    std::deque<std::vector<Scored>>   frames_;      // 每层递归复用；deque 加层时不挪动已有的层
+    std::vector<Jump>                 jumps_;
+    std::unordered_map<std::uint64_t, int> dead_;  // 棋子哈希 → 已证明不够的跳数
+    std::vector<Jump>                 line_;
+    long long                         nodes_     = 0;
+    long long                         sliceEnd_  = 0;
+    bool                              aborted_   = false;
+    bool                              budgetCut_ = false;  // 本轮有分支因跳数上限停下
+};
+
+AdvanceResult solveAdvance(const SparseBoard& start, int targetR, int targetC, long long nodeLimit) {
+    AdvanceResult res;
+    if (start.at(targetR, targetC) == CellState::Peg) {
+        res.reached = true;
+        res.pagoda  = 1.0;
+        return res;
+    }
+    if (start.at(targetR, targetC) == CellState::Invalid) return res;
+
+    AdvanceSearch search(targetR, targetC, nodeLimit);
+    start.forEachPeg([&](int r, int c) {
+        res.pagoda += search.weight(r, c);
+        search.count(r, c, 1);
+    });
+    if (res.pagoda < 1.0 - PAGODA_EPS) {
+        res.pagodaCut = true;
+        return res;
+    }
+
+    SparseBoard work = start;
+    res.reached = search.run(work, res.pagoda, static_cast<int>(start.countPegs()) - 1);
+    res.aborted = search.aborted() && !res.reached;
+    res.nodes   = search.nodes();
+    if (res.reached) res.line = search.line();
+    return res;
+}
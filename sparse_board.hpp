@@ -0,0 +1,131 @@
+#pragma once
+// 无边界稀疏棋盘：康威士兵（Conway's Soldiers）一类“棋子最远能推进多远”的问题
+//
+// 固定的 7×7 数组装不下成千上万颗棋子，这里只记有东西的格子：
+// 棋子和障碍各是一张开放寻址哈希表，键是打包的 (行, 列)，内存只跟占用的格子数成正比。
+// 规则与 Board 相同的部分：四方向跳跃，被跳的必须是棋子，落点必须空着且不是障碍（障碍也就不能被跳过）。
+// 另外维护“可动棋子”表：走一步只改动三个格子，只重算它们前后两格内的棋子，
+// 所以生成走法只扫前线上能动的棋子，跟总棋子数无关。
+// 坐标是任意整数，绝对值小于 2^30；行向下增大，与 Board 一致。走法同样用 Jump（floor 恒为 0）。
+#include "board.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 开放寻址哈希表：64 位键 → 32 位值。线性探测，删除时把后面的条目往回挪（不留墓碑）；
+// 容量是 2 的幂，装载率在 1/8 到 1/2 之间，删得多了会缩小
+class CellMap {
+public:
+    static constexpr std::uint64_t EmptyKey = ~0ULL;    // 打包坐标永远不会是它
+
+    CellMap() { rehash(MinCapacity); }
+
+    const std::uint32_t* find(std::uint64_t key) const;
+    std::uint32_t*       find(std::uint64_t key);
+    bool contains(std::uint64_t key) const { return find(key) != nullptr; }
+    bool insert(std::uint64_t key, std::uint32_t value);    // 已有时覆盖值，返回是否新增
+    bool erase(std::uint64_t key);
+    void clear();
+
+    std::size_t size()  const { return size_; }
+    std::size_t bytes() const { return keys_.size() * (sizeof(std::uint64_t) + sizeof(std::uint32_t)); }
+
+    // 按槽位顺序遍历，f(key, value)
+    template <typename F>
+    void forEach(F&& f) const {
+        for (std::size_t i = 0; i < keys_.size(); ++i) {
+            if (keys_[i] != EmptyKey) f(keys_[i], values_[i]);
+        }
+    }
+
+private:
+    static constexpr std::size_t MinCapacity = 16;
+
+    std::size_t home(std::uint64_t key) const {
+        return static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ULL) >> shift_);
+    }
+    void rehash(std::size_t capacity);
+
+    std::vector<std::uint64_t> keys_;
+    std::vector<std::uint32_t> values_;
+    std::size_t                size_  = 0;
+    int                        shift_ = 64;
+};
+
+class SparseBoard {
+public:
+    static constexpr int MaxCoord = 1 << 30;    // |行|、|列| 都要小于它
+
+    static bool inRange(int r, int c) {
+        return r > -MaxCoord && r < MaxCoord && c > -MaxCoord && c < MaxCoord;
+    }
+    static std::uint64_t key(int r, int c) {
+        return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(r + MaxCoord)) << 32) |
+               static_cast<std::uint32_t>(c + MaxCoord);
+    }
+    static int rowOf(std::uint64_t k) { return static_cast<int>(k >> 32) - MaxCoord; }
+    static int colOf(std::uint64_t k) { return static_cast<int>(k & 0xFFFFFFFFu) - MaxCoord; }
+
+    // 访问：没放东西的格子都是空格；障碍格返回 Invalid
+    CellState at(int r, int c) const;
+    bool isBarrier(int r, int c) const { return barriers_.contains(key(r, c)); }
+    void setPeg(int r, int c, bool peg);
+    void setBarrier(int r, int c, bool barrier);    // 放障碍会拿走那里的棋子
+    void fillRect(int r0, int c0, int r1, int c1);  // [r0, r1] × [c0, c1] 全放棋子（跳过障碍）
+
+    bool canJump(int r1, int c1, int r2, int c2) const;
+    void applyJump(int r1, int c1, int r2, int c2); // 调用前先 canJump
+    void undoJump(int r1, int c1, int r2, int c2);  // applyJump 的逆操作
+
+    std::size_t countPegs()    const { return pegs_.size(); }
+    std::size_t countMovable() const { return movable_.size(); }
+    bool        hasMove()      const { return !movable_.empty(); }
+
+    // 只扫可动棋子；顺序取决于走子历史，同一局面不同来路顺序可能不同
+    void collectJumps(std::vector<Jump>& out) const;
+
+    // 棋子集合的 Zobrist 哈希，走子时增量更新（障碍不计入）
+    std::uint64_t hash() const { return hash_; }
+    // 棋子的外接矩形；没有棋子时返回 false
+    bool bounds(int& minR, int& minC, int& maxR, int& maxC) const;
+    std::size_t memoryBytes() const;
+
+    template <typename F>
+    void forEachPeg(F&& f) const {
+        pegs_.forEach([&f](std::uint64_t k, std::uint32_t) { f(rowOf(k), colOf(k)); });
+    }
+
+private:
+    static constexpr std::uint32_t NotMovable = ~0u;
+
+    bool hasPeg(int r, int c) const;
+    bool open(int r, int c) const;  // 能落子：在范围内、空着、不是障碍
+    bool pegCanMove(int r, int c) const;
+
+    void addPeg(int r, int c);
+    void removePeg(int r, int c);
+    void refresh(int r, int c);         // 重算一颗棋子是否可动
+    void refreshAround(int r, int c);   // 这一格变了：重算它自己和四个方向上一、两格外的棋子
+
+    // 棋子表的值是它在 movable_ 里的下标，不可动时为 NotMovable
+    CellMap                    pegs_;
+    CellMap                    barriers_;
+    std::vector<std::uint64_t> movable_;
+    std::uint64_t              hash_ = 0;
+};
+
+// ===== 推进搜索 =====
+
+struct AdvanceResult {
+    bool              reached = false;
+    bool              aborted = false;      // 超出节点上限，“到不了”未证实
+    bool              pagodaCut = false;    // 根局面的宝塔和就不够，一步不用搜
+    std::vector<Jump> line;
+    double            pagoda  = 0.0;        // 开局的宝塔和（目标格权重为 1）
+    long long         nodes   = 0;
+};
+
+// 让某颗棋子跳到 (targetR, targetC)。不限跳数的深度优先和按跳数迭代加深轮流跑，失败局面按棋子哈希记忆；
+// 用康威的宝塔函数剪枝：格子权重 φ^距离（φ = (√5 - 1) / 2，曼哈顿距离），
+// 任何一跳都不会让总和变大，总和不到 1 就不可能再有棋子到达目标。nodeLimit 为 0 表示不限
+AdvanceResult solveAdvance(const SparseBoard& start, int targetR, int targetC, long long nodeLimit = 0);
@@ -0,0 +1,84 @@
+// 对局遥测
+#include "telemetry.hpp"
+
+static const char TELEMETRY_MAGIC[8] = {'P','E','G','T','L','M','0','2'};
+static const int  DRAIN_INTERVAL_MS  = 50;
+
+TelemetryLog::~TelemetryLog() {
+    stop();
+}
+
+bool TelemetryLog::start(const std::string& path) {
+    stop();
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) return false;
+    if (std::fwrite(TELEMETRY_MAGIC, 1, sizeof(TELEMETRY_MAGIC), file_) != sizeof(TELEMETRY_MAGIC)) {
+        std::fclose(file_);
+        file_ = nullptr;
+        return false;
+    }
+
+    head_.store(0, std::memory_order_relaxed);
+    tail_.store(0, std::memory_order_relaxed);
+    written_.store(0, std::memory_order_relaxed);
+    dropped_.store(0, std::memory_order_relaxed);
+    start_ = std::chrono::steady_clock::now();
+    running_.store(true, std::memory_order_release);
+    worker_ = std::thread(&TelemetryLog::drainLoop, this);
+    return true;
+}
+
+void TelemetryLog::stop() {
+    if (worker_.joinable()) {
+        running_.store(false, std::memory_order_release);
+        worker_.join();
+    }
+    if (file_) {
+        drain();
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+}
+
+bool TelemetryLog::record(const TelemetryEvent& e) {
+    std::size_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) >= Capacity) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    ring_[head & (Capacity - 1)] = e;
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+std::uint32_t TelemetryLog::nowMs() const {
+    auto d = std::chrono::steady_clock::now() - start_;
+    return static_cast<std::uint32_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(d).count());
+}
+
+// ===== 写盘线程 =====
+
+// 把 [tail, head) 一次或两次（绕回时）写出去，然后才推进 tail 把槽位还给生产者
+std::size_t TelemetryLog::drain() {
+    std::size_t tail = tail_.load(std::memory_order_relaxed);
+    std::size_t head = head_.load(std::memory_order_acquire);
+    std::size_t n = head - tail;
+    if (n == 0) return 0;
+
+    std::size_t begin = tail & (Capacity - 1);
+    std::size_t first = (begin + n <= Capacity) ? n : Capacity - begin;
+    std::fwrite(&ring_[begin], sizeof(TelemetryEvent), first, file_);
+    if (first < n) std::fwrite(&ring_[0], sizeof(TelemetryEvent), n - first, file_);
+
+    tail_.store(head, std::memory_order_release);
+    written_.fetch_add(static_cast<long long>(n), std::memory_order_relaxed);
+    return n;
+}
+
+void TelemetryLog::drainLoop() {
+    while (running_.load(std::memory_order_acquire)) {
+        if (drain() > 0) std::fflush(file_);
+        std::this_thread::sleep_for(std::chrono::milliseconds(DRAIN_INTERVAL_MS));
+    }
+}
@@ -0,0 +1,85 @@
+#pragma once
+// 对局遥测：每次操作记一条定长事件
+//
+// handlePlaying 只往无锁环形缓冲里写一条 18 字节记录，满了就丢弃并计数，绝不阻塞渲染线程；
+// 后台线程把缓冲里的事件批量写进二进制日志。单生产者（游戏线程）/ 单消费者（写盘线程）。
+//
+// 日志文件：8 字节 "PEGTLM02" 后面紧跟若干条 TelemetryEvent（小端，原样写入）。
+// 02 比 01 多了落点楼层 toFloor，pegs 从 8 位加宽到 16 位（64 层时棋子数会超过 255）。
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+enum class TelemetryKind : std::uint8_t {
+    Select   = 1,   // 选中棋子
+    Move     = 2,   // 走子
+    Undo     = 3,
+    Restart  = 4,
+    Floor    = 5,   // Q/E 换层
+    Hint     = 6,
+    Quit     = 7,   // Esc
+    GameOver = 8    // flags & 1 表示胜利
+};
+
+enum : std::uint8_t {
+    TELEMETRY_ICE      = 1,
+    TELEMETRY_TELEPORT = 2,   // 传送到了 toFloor 层
+    TELEMETRY_KING     = 4,   // 吃掉了国王
+    TELEMETRY_WIN      = 1    // GameOver 专用
+};
+
+#pragma pack(push, 1)
+struct TelemetryEvent {
+    std::uint32_t timeMs;     // 日志开始后的毫秒数
+    std::uint32_t thinkMs;    // 距本局上一次操作的毫秒数
+    std::uint16_t session;    // 无窗口托管时的会话号，窗口版为 0
+    std::uint8_t  kind;
+    std::uint8_t  flags;
+    std::uint8_t  floor;      // 操作所在楼层（换层事件为新楼层）
+    std::uint8_t  from;       // 行 * 7 + 列，0xFF 表示无
+    std::uint8_t  toFloor;    // 最终落点所在楼层（传送之后）；不是走子时与 floor 相同
+    std::uint8_t  to;         // 最终落点（冰滑、传送之后）
+    std::uint16_t pegs;       // 操作后的总棋子数
+};
+#pragma pack(pop)
+static_assert(sizeof(TelemetryEvent) == 18, "遥测事件必须是 18 字节");
+
+class TelemetryLog {
+public:
+    static constexpr std::size_t Capacity = 4096;   // 2 的幂
+
+    TelemetryLog() = default;
+    ~TelemetryLog();
+
+    TelemetryLog(const TelemetryLog&) = delete;
+    TelemetryLog& operator=(const TelemetryLog&) = delete;
+
+    bool start(const std::string& path);
+    void stop();                // 写完缓冲里剩下的事件再关文件
+
+    // 游戏线程调用：不加锁、不分配、不做 IO；缓冲满时丢弃并返回 false
+    bool record(const TelemetryEvent& e);
+
+    std::uint32_t nowMs() const;
+
+    long long written() const { return written_.load(std::memory_order_relaxed); }
+    long long dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    void drainLoop();
+    std::size_t drain();
+
+    TelemetryEvent           ring_[Capacity];
+    alignas(64) std::atomic<std::size_t> head_{0};   // 生产者写
+    alignas(64) std::atomic<std::size_t> tail_{0};   // 消费者写
+    std::atomic<long long>   written_{0};
+    std::atomic<long long>   dropped_{0};
+    std::atomic<bool>        running_{false};
+
+    std::FILE*  file_ = nullptr;
+    std::thread worker_;
+    std::chrono::steady_clock::time_point start_;
+};
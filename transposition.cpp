@@ -0,0 +1,149 @@
+// 固定内存的置换表 + 死局布隆过滤器
+#include "transposition.hpp"
+#include <new>
+
+static const std::size_t   MIN_TABLE_BYTES = 1u << 20;
+static const std::uint64_t UNPROVEN_BIT    = 1ULL << 14;     // 结论依赖布隆过滤器命中
+
+TranspositionTable::TranspositionTable(std::size_t bytes) {
+    if (bytes < MIN_TABLE_BYTES) bytes = MIN_TABLE_BYTES;
+
+    // 内存不够时逐次减半，宁可表小一点也不要崩
+    while (true) {
+        std::size_t bloomBytes = bytes / 8;
+        std::size_t tableBytes = bytes - bloomBytes;
+        std::size_t buckets = tableBytes / sizeof(Bucket);
+        std::size_t blocks  = bloomBytes / sizeof(BloomBlock);
+        if (buckets == 0) buckets = 1;
+        if (blocks == 0)  blocks  = 1;
+
+        buckets_.reset(new (std::nothrow) Bucket[buckets]);
+        bloom_.reset(new (std::nothrow) BloomBlock[blocks]);
+        if (buckets_ && bloom_) {
+            bucketCount_ = buckets;
+            bloomCount_  = blocks;
+            break;
+        }
+        buckets_.reset();
+        bloom_.reset();
+        if (bytes <= MIN_TABLE_BYTES) {
+            bucketCount_ = 0;
+            bloomCount_  = 0;
+            return;   // 彻底分配不到：退化为不记忆的搜索
+        }
+        bytes /= 2;
+    }
+    clear();
+}
+
+void TranspositionTable::clear() {
+    for (std::size_t i = 0; i < bucketCount_; ++i) {
+        for (auto& e : buckets_[i].e) e = Entry{0, 0};
+    }
+    for (std::size_t i = 0; i < bloomCount_; ++i) {
+        for (auto& w : bloom_[i].bits) w = 0;
+    }
+    age_ = 1;
+}
+
+std::size_t TranspositionTable::bytes() const {
+    return bucketCount_ * sizeof(Bucket) + bloomCount_ * sizeof(BloomBlock);
+}
+
+TranspositionTable::Bucket* TranspositionTable::bucketFor(std::uint64_t key) const {
+    return &buckets_[key % bucketCount_];
+}
+
+void TranspositionTable::prefetch(std::uint64_t key) const {
+    if (bucketCount_ == 0) return;
+    PEG_PREFETCH(bucketFor(key));
+}
+
+// ===== 分块布隆过滤器：4 个比特落在同一条 64 字节缓存行里 =====
+
+void TranspositionTable::bloomInsert(std::uint64_t key) {
+    BloomBlock& blk = bloom_[(key >> 32) % bloomCount_];
+    std::uint64_t h = key * 0x9E3779B97F4A7C15ULL;
+    for (int k = 0; k < 4; ++k) {
+        int bit = static_cast<int>((h >> (k * 9)) & 511);
+        blk.bits[bit >> 6] |= (1ULL << (bit & 63));
+    }
+}
+
+bool TranspositionTable::bloomContains(std::uint64_t key) const {
+    const BloomBlock& blk = bloom_[(key >> 32) % bloomCount_];
+    std::uint64_t h = key * 0x9E3779B97F4A7C15ULL;
+    for (int k = 0; k < 4; ++k) {
+        int bit = static_cast<int>((h >> (k * 9)) & 511);
+        if (!(blk.bits[bit >> 6] & (1ULL << (bit & 63)))) return false;
+    }
+    return true;
+}
+
+// ===== 查询 / 写入 =====
+
+bool TranspositionTable::probe(std::uint64_t key, int& bestPegs, bool& fromFilter) {
+    fromFilter = false;
+    if (bucketCount_ == 0) return false;
+
+    Bucket* b = bucketFor(key);
+    for (auto& e : b->e) {
+        if (e.data != 0 && e.key == key) {
+            bestPegs   = static_cast<int>(e.data & 255) - 1;
+            fromFilter = (e.data & UNPROVEN_BIT) != 0;
+            // 刷新代数，常用的条目不被淘汰
+            e.data = (e.data & 0xFFFF) | (static_cast<std::uint64_t>(age_ & 0xFFFF) << 16);
+            ++hits_;
+            return true;
+        }
+    }
+    if (bloomContains(key)) {
+        bestPegs   = -1;
+        fromFilter = true;
+        ++filterHits_;
+        return true;
+    }
+    ++misses_;
+    return false;
+}
+
+bool TranspositionTable::storeDead(std::uint64_t key, int bestPegs, long long effort, bool proven) {
+    if (bucketCount_ == 0) return false;
+
+    int effortLog = 0;
+    while (effortLog < 63 && (1LL << (effortLog + 1)) <= effort) ++effortLog;
+    std::uint64_t pegs = (bestPegs < 0) ? 0 : static_cast<std::uint64_t>(bestPegs + 1);
+    if (pegs > 255) pegs = 255;
+    std::uint64_t data = pegs
+                       | (static_cast<std::uint64_t>(effortLog) << 8)
+                       | (proven ? 0 : UNPROVEN_BIT)
+                       | (static_cast<std::uint64_t>(age_ & 0xFFFF) << 16);
+
+    Bucket* b = bucketFor(key);
+    Entry* victim = nullptr;
+    std::uint64_t victimScore = ~0ULL;
+    for (auto& e : b->e) {
+        if (e.data == 0 || e.key == key) {
+            victim = &e;
+            victimScore = 0;
+            break;
+        }
+        // 代数旧的先淘汰，同代里工作量小的先淘汰
+        std::uint64_t age   = (e.data >> 16) & 0xFFFF;
+        std::uint64_t score = (age << 6) | ((e.data >> 8) & 63);
+        if (score < victimScore) {
+            victimScore = score;
+            victim = &e;
+        }
+    }
+
+    bool evicted = victim->data != 0 && victim->key != key;
+    if (evicted) {
+        bloomInsert(victim->key);
+        ++evictions_;
+    }
+    victim->key  = key;
+    victim->data = data;
+    ++stores_;
+    return evicted;
+}
@@ -0,0 +1,71 @@
+#pragma once
+// 固定内存的置换表：记录已证明无法获胜的局面
+//
+// 每个桶 64 字节（一条缓存行）放 4 个条目，按“代数旧 / 工作量小”淘汰。
+// 被挤出去的死局面写入分块布隆过滤器，只占几个比特，局面再多也不会超出内存预算。
+// 布隆过滤器有极小的误判率，命中时求解器会把“无解”结论标记为未证实；
+// 子树里用过过滤器得出的死局照样写进表（同一轮里照样剪枝），但带“未证实”标记，命中时与过滤器命中同样对待。
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#if defined(_MSC_VER)
+#include <xmmintrin.h>
+#define PEG_PREFETCH(p) _mm_prefetch(reinterpret_cast<const char*>(p), _MM_HINT_T0)
+#else
+#define PEG_PREFETCH(p) __builtin_prefetch(p)
+#endif
+
+class TranspositionTable {
+public:
+    static constexpr int EntriesPerBucket = 4;
+
+    // bytes：总内存预算，其中约 1/8 给布隆过滤器；分配失败时自动减半
+    explicit TranspositionTable(std::size_t bytes);
+
+    // 查死局：命中置换表时 bestPegs 为记录值；只命中过滤器、或命中未证实的条目时 fromFilter = true
+    // （只命中过滤器时 bestPegs = -1）
+    bool probe(std::uint64_t key, int& bestPegs, bool& fromFilter);
+    // proven = false：结论依赖过滤器命中。返回 true 表示挤掉了另一个局面（它进了布隆过滤器）
+    bool storeDead(std::uint64_t key, int bestPegs, long long effort, bool proven = true);
+    void prefetch(std::uint64_t key) const;
+
+    void newSearch() { age_++; }    // 新一轮搜索，旧条目优先被淘汰
+    void clear();
+
+    std::size_t bytes() const;
+
+    long long hits()       const { return hits_; }
+    long long misses()     const { return misses_; }
+    long long stores()     const { return stores_; }
+    long long evictions()  const { return evictions_; }
+    long long filterHits() const { return filterHits_; }
+
+private:
+    struct Entry {
+        std::uint64_t key;
+        std::uint64_t data;   // 0-7 最少棋子数+1 / 8-13 工作量 log2 / 14 未证实 / 16-31 代数；0 为空
+    };
+    struct alignas(64) Bucket {
+        Entry e[EntriesPerBucket];
+    };
+    struct alignas(64) BloomBlock {
+        std::uint64_t bits[8];
+    };
+
+    Bucket*     bucketFor(std::uint64_t key) const;
+    void        bloomInsert(std::uint64_t key);
+    bool        bloomContains(std::uint64_t key) const;
+
+    std::unique_ptr<Bucket[]>     buckets_;
+    std::size_t                   bucketCount_ = 0;
+    std::unique_ptr<BloomBlock[]> bloom_;
+    std::size_t                   bloomCount_  = 0;
+    std::uint32_t                 age_         = 1;
+
+    long long hits_       = 0;
+    long long misses_     = 0;
+    long long stores_     = 0;
+    long long evictions_  = 0;
+    long long filterHits_ = 0;
+};
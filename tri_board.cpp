@@ -0,0 +1,353 @@
+// 三角形棋盘
+#include "tri_board.hpp"
+#include <algorithm>
+#include <unordered_set>
+
+// 左、右、上、下、左上、右下
+static const int TRI_DR[TriBoard::Dirs] = {0, 0, -1, 1, -1, 1};
+static const int TRI_DC[TriBoard::Dirs] = {-1, 1, 0, 0, -1, 1};
+
+static int popcount64(std::uint64_t x) {
+    int n = 0;
+    while (x) {
+        x &= x - 1;
+        ++n;
+    }
+    return n;
+}
+
+static std::uint64_t bit(int i) {
+    return 1ULL << i;
+}
+
+// ===== 预计算表 =====
+
+struct TriBoard::Tables {
+    struct Triple {
+        std::uint8_t from, over, to, dir;
+    };
+
+    int          cells = 0;
+    std::int8_t  neighbor[MaxCells][Dirs];  // 相邻格，出界为 -1
+    std::uint8_t row[MaxCells];
+    std::uint8_t col[MaxCells];
+    Triple       jumps[MaxCells * Dirs];    // 所有 (起点, 被跳, 落点)，按起点、方向排序
+    int          jumpCount = 0;
+};
+
+const TriBoard::Tables& TriBoard::tablesFor(int side) {
+    static const Tables* all = [] {
+        static Tables t[MaxSide + 1];
+        for (int s = 1; s <= MaxSide; ++s) {
+            Tables& tb = t[s];
+            tb.cells = s * (s + 1) / 2;
+            auto inside = [s](int r, int c) { return r >= 0 && r < s && c >= 0 && c <= r; };
+            for (int r = 0; r < s; ++r) {
+                for (int c = 0; c <= r; ++c) {
+                    int i = index(r, c);
+                    tb.row[i] = static_cast<std::uint8_t>(r);
+                    tb.col[i] = static_cast<std::uint8_t>(c);
+                    for (int d = 0; d < Dirs; ++d) {
+                        int r1 = r + TRI_DR[d], c1 = c + TRI_DC[d];
+                        int r2 = r1 + TRI_DR[d], c2 = c1 + TRI_DC[d];
+                        tb.neighbor[i][d] = static_cast<std::int8_t>(inside(r1, c1) ? index(r1, c1) : -1);
+                        if (inside(r2, c2)) {
+                            tb.jumps[tb.jumpCount++] = {
+                                static_cast<std::uint8_t>(i),
+                                static_cast<std::uint8_t>(index(r1, c1)),
+                                static_cast<std::uint8_t>(index(r2, c2)),
+                                static_cast<std::uint8_t>(d)
+                            };
+                        }
+                    }
+                }
+            }
+        }
+        return t;
+    }();
+    return all[side];
+}
+
+// ===== 构造 =====
+
+TriBoard::TriBoard(int side, GameMode mode, int hole)
+    : side_(std::max(1, std::min(side, MaxSide))), mode_(mode)
+{
+    tables_ = &tablesFor(side_);
+    int n = cells();
+    valid_ = bit(n) - 1;
+    if (hole < 0 || hole >= n) hole = 0;
+    pegs_ = valid_ & ~bit(hole);
+
+    if (mode_ == GameMode::Lattice) {
+        // 目标格：开局的空位
+        goal_ = bit(hole);
+    } else if (mode_ == GameMode::Chess) {
+        // 国王放在三角形中部；正好是空位时取第一个棋子
+        int r = 2 * (side_ - 1) / 3;
+        int k = index(r, r / 2);
+        if (!((pegs_ >> k) & 1)) {
+            std::uint64_t rest = pegs_;
+            k = popCell(rest);
+        }
+        king_ = bit(k);
+    }
+}
+
+int TriBoard::rowOf(int i) {
+    int r = 0;
+    while (index(r + 1, 0) <= i) ++r;
+    return r;
+}
+
+// ===== 访问 =====
+
+CellState TriBoard::at(int r, int c) const {
+    if (!inBounds(r, c)) return CellState::Invalid;
+    return ((pegs_ >> index(r, c)) & 1) ? CellState::Peg : CellState::Empty;
+}
+
+CellType TriBoard::typeAt(int r, int c) const {
+    if (!inBounds(r, c)) return CellType::Normal;
+    int i = index(r, c);
+    if ((king_    >> i) & 1) return CellType::King;
+    if ((barrier_ >> i) & 1) return CellType::Barrier;
+    if ((swamp_   >> i) & 1) return CellType::Swamp;
+    if ((ice_     >> i) & 1) return CellType::Ice;
+    if ((goal_    >> i) & 1) return CellType::Goal;
+    return CellType::Normal;
+}
+
+void TriBoard::set(int r, int c, CellState state) {
+    if (!inBounds(r, c) || state == CellState::Invalid) return;
+    if (state == CellState::Peg) pegs_ |= bit(index(r, c));
+    else                         pegs_ &= ~bit(index(r, c));
+}
+
+void TriBoard::setType(int r, int c, CellType t) {
+    if (!inBounds(r, c)) return;
+    std::uint64_t b = bit(index(r, c));
+    ice_ &= ~b; swamp_ &= ~b; barrier_ &= ~b; goal_ &= ~b; king_ &= ~b;
+    switch (t) {
+    case CellType::Ice:     ice_     |= b; break;
+    case CellType::Swamp:   swamp_   |= b; break;
+    case CellType::Barrier: barrier_ |= b; break;
+    case CellType::Goal:    goal_    |= b; break;
+    case CellType::King:    king_    |= b; break;
+    default: break;
+    }
+}
+
+int TriBoard::king() const {
+    if (!king_) return -1;
+    std::uint64_t k = king_;
+    return popCell(k);
+}
+
+// ===== 走子规则 =====
+
+// 起点、被跳有棋子，落点为空；被跳格和落点都不能是障碍
+bool TriBoard::jumpOk(int from, int over, int to) const {
+    return ((pegs_ >> from) & (pegs_ >> over) & ~(pegs_ >> to) & 1) &&
+           !(((barrier_ >> over) | (barrier_ >> to)) & 1);
+}
+
+int TriBoard::directionOf(int r1, int c1, int r2, int c2) const {
+    for (int d = 0; d < Dirs; ++d) {
+        if (r2 - r1 == 2 * TRI_DR[d] && c2 - c1 == 2 * TRI_DC[d]) return d;
+    }
+    return -1;
+}
+
+bool TriBoard::canJump(int r1, int c1, int r2, int c2) const {
+    if (!inBounds(r1, c1) || !inBounds(r2, c2)) return false;
+    int d = directionOf(r1, c1, r2, c2);
+    if (d < 0) return false;
+    int from = index(r1, c1);
+    return jumpOk(from, tables_->neighbor[from][d], index(r2, c2));
+}
+
+void TriBoard::applyJump(int r1, int c1, int r2, int c2) {
+    if (!canJump(r1, c1, r2, c2)) return;
+    int from = index(r1, c1);
+    int over = tables_->neighbor[from][directionOf(r1, c1, r2, c2)];
+    int to   = index(r2, c2);
+
+    bool kingMoving   = (king_ >> from) & 1;
+    bool kingCaptured = (king_ >> over) & 1;
+
+    pegs_ &= ~(bit(from) | bit(over));
+    pegs_ |= bit(to);
+
+    // 和 Board 一样：国王离开的格子变回普通格，落点变成国王格（盖掉冰格等）
+    if (kingMoving) {
+        setType(r1, c1, CellType::Normal);
+        setType(r2, c2, CellType::King);
+    }
+    if (kingCaptured) {
+        king_ &= ~bit(over);
+    }
+}
+
+bool TriBoard::applyMove(int r1, int c1, int r2, int c2, int& finalR, int& finalC) {
+    finalR = r2;
+    finalC = c2;
+    if (!canJump(r1, c1, r2, c2)) return false;
+    int d = directionOf(r1, c1, r2, c2);
+    applyJump(r1, c1, r2, c2);
+
+    // 冰格：前方一格在盘内、为空、不是障碍时再滑一格
+    int to = index(r2, c2);
+    if (!((ice_ >> to) & 1)) return false;
+    int slide = tables_->neighbor[to][d];
+    if (slide < 0 || ((pegs_ | barrier_) >> slide) & 1) return false;
+
+    pegs_ &= ~bit(to);
+    pegs_ |= bit(slide);
+    finalR = tables_->row[slide];
+    finalC = tables_->col[slide];
+    return true;
+}
+
+bool TriBoard::canMove(int r, int c) const {
+    return targetMask(r, c) != 0;
+}
+
+std::uint64_t TriBoard::targetMask(int r, int c) const {
+    std::uint64_t mask = 0;
+    if (!inBounds(r, c)) return mask;
+    int from = index(r, c);
+    for (int d = 0; d < Dirs; ++d) {
+        int over = tables_->neighbor[from][d];
+        if (over < 0) continue;
+        int to = tables_->neighbor[over][d];
+        if (to >= 0 && jumpOk(from, over, to)) mask |= bit(to);
+    }
+    return mask;
+}
+
+int TriBoard::countPegs() const {
+    return popcount64(pegs_);
+}
+
+bool TriBoard::hasMove() const {
+    for (int k = 0; k < tables_->jumpCount; ++k) {
+        const Tables::Triple& t = tables_->jumps[k];
+        if (jumpOk(t.from, t.over, t.to)) return true;
+    }
+    return false;
+}
+
+template <typename Out>
+void TriBoard::appendJumps(Out& out) const {
+    for (int k = 0; k < tables_->jumpCount; ++k) {
+        const Tables::Triple& t = tables_->jumps[k];
+        if ((swamp_ >> t.from) & 1) continue;
+        if (!jumpOk(t.from, t.over, t.to)) continue;
+        out.push_back(Jump{0, tables_->row[t.from], tables_->col[t.from],
+                              tables_->row[t.to],   tables_->col[t.to]});
+    }
+}
+
+void TriBoard::collectJumps(JumpList& out) const {
+    out.clear();
+    appendJumps(out);
+}
+
+void TriBoard::collectJumps(std::vector<Jump>& out) const {
+    out.clear();
+    appendJumps(out);
+}
+
+// ===== 胜负判定 =====
+
+bool isGoalWin(const TriBoard& board) {
+    if (board.countPegs() != 1) return false;
+    std::uint64_t p = board.pegs();
+    int i = popCell(p);
+    return board.typeAt(TriBoard::rowOf(i), TriBoard::colOf(i)) == CellType::Goal;
+}
+
+bool isKingAlive(const TriBoard& board) {
+    int k = board.king();
+    return k >= 0 && board.at(TriBoard::rowOf(k), TriBoard::colOf(k)) == CellState::Peg;
+}
+
+// ===== 求解 =====
+
+class TriSearch {
+public:
+    TriSearch(int maxDepth, long long nodeLimit) : frames_(maxDepth + 1), nodeLimit_(nodeLimit) {}
+
+    bool search(const TriBoard& b, int depth) {
+        if (nodeLimit_ > 0 && nodes_ >= nodeLimit_) {
+            aborted_ = true;
+            return false;
+        }
+        ++nodes_;
+
+        std::vector<Jump>& jumps = frames_[depth];
+        b.collectJumps(jumps);
+        if (jumps.empty()) {
+            int pegs = b.countPegs();
+            if (bestPegs_ < 0 || pegs < bestPegs_) bestPegs_ = pegs;
+            // 只剩沼泽上的棋子能动：游戏不会结束，视为失败
+            if (b.hasMove()) return false;
+            return isWin(b);
+        }
+
+        // 键：棋子掩码（最多 55 位）+ 国王格（高 6 位），其余格子类型走子时不变
+        std::uint64_t key = b.pegs() | (static_cast<std::uint64_t>(b.king() + 1) << 58);
+        if (dead_.count(key)) return false;
+
+        for (const Jump& j : jumps) {
+            TriBoard next = b;
+            int fr, fc;
+            next.applyMove(j.r1, j.c1, j.r2, j.c2, fr, fc);
+            if (b.mode() == GameMode::Chess && !isKingAlive(next)) continue;   // 国王被吃
+            line_.push_back(j);
+            if (search(next, depth + 1)) return true;
+            line_.pop_back();
+            if (aborted_) return false;
+        }
+        dead_.insert(key);
+        return false;
+    }
+
+    const std::vector<Jump>& line() const { return line_; }
+    long long nodes()    const { return nodes_; }
+    int       bestPegs() const { return bestPegs_; }
+    bool      aborted()  const { return aborted_; }
+
+private:
+    static bool isWin(const TriBoard& b) {
+        switch (b.mode()) {
+        case GameMode::Classic: return b.isSolved();
+        case GameMode::Lattice: return isGoalWin(b);
+        case GameMode::Chess:   return isKingAlive(b);
+        }
+        return false;
+    }
+
+    std::vector<std::vector<Jump>>    frames_;    // 每层递归复用自己的走法表
+    std::unordered_set<std::uint64_t> dead_;
+    std::vector<Jump>                 line_;
+    long long                         nodes_     = 0;
+    long long                         nodeLimit_ = 0;
+    int                               bestPegs_  = -1;
+    bool                              aborted_   = false;
+};
+
+SolveResult solveTriangle(const TriBoard& start, long long nodeLimit) {
+    TriSearch search(start.countPegs(), nodeLimit);
+    SolveResult res;
+    res.solved   = search.search(start, 0);
+    res.aborted  = search.aborted();
+    res.nodes    = search.nodes();
+    res.bestPegs = search.bestPegs();
+    if (res.solved) {
+        res.line     = search.line();
+        res.bestPegs = start.countPegs() - static_cast<int>(res.line.size());
+    }
+    return res;
+}
@@ -0,0 +1,87 @@
+#pragma once
+// 三角形棋盘：六方向跳跃（经典 15 孔三角跳棋）
+//
+// 坐标：第 r 行有 r + 1 格（0 <= c <= r），格子编号 r * (r + 1) / 2 + c。
+// 六个方向：左右 (0, ±1)、上下 (±1, 0)、斜向 (±1, ±1)（同号）。
+// 边长不超过 10（55 格），整盘棋子和每种格子类型各用一个 64 位掩码表示；
+// 每种边长的 (起点, 被跳, 落点) 三元组和各方向邻格只在第一次用到时算一次，之后查表。
+// 接口与 Board 的规则部分一致，走法同样用 Jump（floor 恒为 0）。
+#include "board.hpp"
+#include "solver.hpp"
+#include <cstdint>
+#include <vector>
+
+class TriBoard {
+public:
+    static constexpr int MaxSide  = 10;
+    static constexpr int MaxCells = MaxSide * (MaxSide + 1) / 2;
+    static constexpr int Dirs     = 6;
+
+    // hole：开局空着的格子编号（目标模式下它就是 Goal 格）；国王模式把国王放在中部
+    explicit TriBoard(int side = 5, GameMode mode = GameMode::Classic, int hole = 0);
+
+    int      side()  const { return side_; }
+    int      cells() const { return side_ * (side_ + 1) / 2; }
+    GameMode mode()  const { return mode_; }
+
+    static int index(int r, int c) { return r * (r + 1) / 2 + c; }
+    static int rowOf(int i);
+    static int colOf(int i) { return i - index(rowOf(i), 0); }
+
+    // 访问
+    CellState at(int r, int c) const;
+    CellType  typeAt(int r, int c) const;
+    void set(int r, int c, CellState state);
+    void setType(int r, int c, CellType t);     // 只认 Normal / Ice / Swamp / Barrier / Goal / King
+
+    bool inBounds(int r, int c) const { return r >= 0 && r < side_ && c >= 0 && c <= r; }
+
+    bool canJump(int r1, int c1, int r2, int c2) const;
+    void applyJump(int r1, int c1, int r2, int c2);
+    // 跳跃 + 冰格滑行；发生滑行时返回 true
+    bool applyMove(int r1, int c1, int r2, int c2, int& finalR, int& finalC);
+
+    bool          canMove(int r, int c) const;
+    std::uint64_t targetMask(int r, int c) const;   // 合法落点位掩码（按格子编号）
+
+    int  countPegs() const;
+    bool hasMove() const;
+    bool isSolved() const { return countPegs() == 1; }
+
+    // 可选的跳跃（沼泽上的棋子不能被选中），顺序固定
+    void collectJumps(JumpList& out) const;
+    void collectJumps(std::vector<Jump>& out) const;
+
+    // 紧凑表示：棋子掩码 + 国王格（没有国王为 -1）。格子类型除国王外走子时不变
+    std::uint64_t pegs() const { return pegs_; }
+    int           king() const;
+
+private:
+    struct Tables;
+    static const Tables& tablesFor(int side);
+
+    bool jumpOk(int from, int over, int to) const;
+    int  directionOf(int r1, int c1, int r2, int c2) const;
+
+    template <typename Out>
+    void appendJumps(Out& out) const;
+
+    const Tables* tables_;
+    int           side_;
+    GameMode      mode_;
+    std::uint64_t valid_   = 0;
+    std::uint64_t pegs_    = 0;
+    std::uint64_t ice_     = 0;
+    std::uint64_t swamp_   = 0;
+    std::uint64_t barrier_ = 0;
+    std::uint64_t goal_    = 0;
+    std::uint64_t king_    = 0;
+};
+
+// 与 Board 版本相同的胜负判定
+bool isGoalWin(const TriBoard& board);
+bool isKingAlive(const TriBoard& board);
+
+// 精确求解：深度优先 + 失败局面记忆（键是棋子掩码 + 国王格）。
+// 胜利条件与 goalForMode 相同；nodeLimit 为 0 表示不限
+SolveResult solveTriangle(const TriBoard& start, long long nodeLimit = 0);
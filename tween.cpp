@@ -0,0 +1,66 @@
+// 补间动画调度
+#include "tween.hpp"
+#include <algorithm>
+
+void TweenScheduler::beginGroup(int floor) {
+    if (count_ == static_cast<int>(groups_.size())) {
+        // 满了：转成从 0 开始再追加一格
+        std::rotate(groups_.begin(), groups_.begin() + head_, groups_.end());
+        head_ = 0;
+        groups_.emplace_back();
+    }
+    Group& g = group(count_++);
+    g.floor  = floor;
+    g.time   = 0.f;
+    g.length = 0.f;
+    g.tweens.clear();
+}
+
+void TweenScheduler::add(const Tween& tween) {
+    if (count_ == 0) beginGroup(0);
+    Group& g = group(count_ - 1);
+    g.tweens.push_back(tween);
+    g.length = std::max(g.length, tween.delay + tween.duration);
+}
+
+void TweenScheduler::update(float dt) {
+    // 一帧可能跨过好几组（卡顿或无窗口时一次推进到底），剩余时间顺延给下一组
+    while (dt > 0.f && count_ > 0) {
+        float speed = std::min(maxSpeed, static_cast<float>(count_));
+        Group& g = group(0);
+        float left = (g.length - g.time) / speed;
+        if (dt < left) {
+            g.time += dt * speed;
+            return;
+        }
+        dt -= left;
+        head_ = (head_ + 1) % static_cast<int>(groups_.size());
+        --count_;
+    }
+}
+
+bool TweenScheduler::hides(int floor, int r, int c) const {
+    for (int k = 0; k < count_; ++k) {
+        const Group& g = group(k);
+        if (g.floor != floor) continue;
+        for (const auto& tw : g.tweens) {
+            if (tw.kind == TweenKind::Teleport) continue;
+            if (tw.toRow == r && tw.toCol == c && g.time < tw.delay + tw.duration) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void TweenScheduler::activeFrames(int floor, std::vector<TweenFrame>& out) const {
+    out.clear();
+    if (count_ == 0) return;
+    const Group& g = group(0);
+    if (g.floor != floor) return;
+    for (const auto& tw : g.tweens) {
+        if (g.time < tw.delay || g.time >= tw.delay + tw.duration) continue;
+        float t = (tw.duration > 0.f) ? (g.time - tw.delay) / tw.duration : 1.f;
+        out.push_back(TweenFrame{&tw, t});
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+// 补间动画调度：走子立即改棋盘，画面按队列追上
+//
+// 每步走子是一组补间（跳跃 → 冰滑；传送特效与跳跃同时开始），各组按顺序播放。
+// 积压的组越多播得越快，连续快速操作时画面不会越落越远。与渲染无关，坐标用格子行列。
+#include <vector>
+
+enum class TweenKind {
+    Jump,       // 抛物线跳跃
+    Slide,      // 冰面直线滑行
+    Teleport    // 传送点收缩淡出
+};
+
+struct Tween {
+    TweenKind kind     = TweenKind::Jump;
+    int       fromRow  = -1;
+    int       fromCol  = -1;
+    int       toRow    = -1;
+    int       toCol    = -1;
+    float     delay    = 0.f;   // 组开始后多久开始（秒）
+    float     duration = 0.f;
+};
+
+// 正在播放的一个补间及其进度
+struct TweenFrame {
+    const Tween* tween;
+    float        t;             // 0..1
+};
+
+class TweenScheduler {
+public:
+    // 开始一步走子的补间组；floor 为走完后棋子所在楼层
+    void beginGroup(int floor);
+    void add(const Tween& tween);
+
+    void update(float dt);
+    void clear() { head_ = count_ = 0; }
+
+    bool busy()    const { return count_ > 0; }
+    int  pending() const { return count_; }
+
+    // 该格的静态棋子是否还“在路上”（由补间来画，静态绘制要跳过）
+    bool hides(int floor, int r, int c) const;
+    // 当前组里正在播放、且在该楼层上的补间
+    void activeFrames(int floor, std::vector<TweenFrame>& out) const;
+
+    float maxSpeed = 4.f;       // 积压时的最高播放倍速
+
+private:
+    struct Group {
+        int                floor  = 0;
+        float              time   = 0.f;
+        float              length = 0.f;
+        std::vector<Tween> tweens;
+    };
+    Group&       group(int k)       { return groups_[(head_ + k) % groups_.size()]; }
+    const Group& group(int k) const { return groups_[(head_ + k) % groups_.size()]; }
+
+    // 环形队列：播完的组留着 tweens 的容量，之后的走子和重开直接复用，不再分配
+    std::vector<Group> groups_;
+    int                head_  = 0;
+    int                count_ = 0;
+};
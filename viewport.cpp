@@ -0,0 +1,46 @@
+// 视口
+#include "viewport.hpp"
+#include <algorithm>
+#include <cmath>
+
+void Viewport::toCell(float sx, float sy, float cellSize, int& row, int& col) const {
+    float wx = sx / zoom + panX;
+    float wy = sy / zoom + panY;
+    col = static_cast<int>(std::floor(wx / cellSize));
+    row = static_cast<int>(std::floor(wy / cellSize));
+}
+
+void Viewport::visibleCells(int rows, int cols, float cellSize, float width, float height,
+                            int& r0, int& r1, int& c0, int& c1) const
+{
+    float span = cellSize * zoom;
+    c0 = static_cast<int>(std::floor(panX / cellSize));
+    r0 = static_cast<int>(std::floor(panY / cellSize));
+    c1 = c0 + static_cast<int>(std::ceil(width / span)) + 1;
+    r1 = r0 + static_cast<int>(std::ceil(height / span)) + 1;
+
+    c0 = std::max(0, std::min(c0, cols));
+    r0 = std::max(0, std::min(r0, rows));
+    c1 = std::max(c0, std::min(c1, cols));
+    r1 = std::max(r0, std::min(r1, rows));
+}
+
+void Viewport::zoomAt(float factor, float sx, float sy) {
+    float next = std::max(minZoom, std::min(maxZoom, zoom * factor));
+    // 缩放前后 (sx, sy) 下的世界坐标不变
+    float wx = sx / zoom + panX;
+    float wy = sy / zoom + panY;
+    zoom = next;
+    panX = wx - sx / zoom;
+    panY = wy - sy / zoom;
+}
+
+void Viewport::pan(float dx, float dy) {
+    panX += dx / zoom;
+    panY += dy / zoom;
+}
+
+void Viewport::reset() {
+    zoom = 1.f;
+    panX = panY = 0.f;
+}
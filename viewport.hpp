@@ -0,0 +1,30 @@
+#pragma once
+// 视口：缩放 + 平移，以及“哪些格子在屏幕内”的裁剪计算。与渲染无关
+//
+// 世界坐标：格子 (r, c) 的左上角在 (c * cellSize, r * cellSize)。
+// 屏幕坐标 = (世界坐标 - pan) * zoom。
+
+struct Viewport {
+    float zoom = 1.f;
+    float panX = 0.f;   // 屏幕左上角对应的世界坐标
+    float panY = 0.f;
+
+    float minZoom = 0.05f;
+    float maxZoom = 8.f;
+
+    float toScreenX(float worldX) const { return (worldX - panX) * zoom; }
+    float toScreenY(float worldY) const { return (worldY - panY) * zoom; }
+
+    // 屏幕像素 → 格子行列（可能在棋盘外）
+    void toCell(float sx, float sy, float cellSize, int& row, int& col) const;
+
+    // 屏幕 width × height 内可见的格子范围 [r0, r1) × [c0, c1)，已夹到 rows × cols 内
+    void visibleCells(int rows, int cols, float cellSize, float width, float height,
+                      int& r0, int& r1, int& c0, int& c1) const;
+
+    // 以屏幕点 (sx, sy) 为中心缩放，该点下的世界坐标保持不动
+    void zoomAt(float factor, float sx, float sy);
+    // 按屏幕像素平移
+    void pan(float dx, float dy);
+    void reset();
+};